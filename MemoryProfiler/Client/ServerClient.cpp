@@ -7,6 +7,7 @@ Client::Client(QObject *parent) : QObject(parent)
     connect(socket, &QTcpSocket::connected, this, &Client::onConnected);
     connect(socket, &QTcpSocket::disconnected, this, &Client::onDisconnected);
     connect(socket, &QTcpSocket::errorOccurred, this, &Client::onError);
+    connect(socket, &QTcpSocket::readyRead, this, &Client::onReadyRead);
 
     qDebug() << "Client: Cliente inicializado correctamente";
 }
@@ -98,4 +99,31 @@ void Client::onError(QAbstractSocket::SocketError error)
     QString errorStr = socket->errorString();
     qDebug() << "Client: ✗ Error de socket:" << errorStr;
     emit errorOccurred(errorStr);
-}
\ No newline at end of file
+}
+
+void Client::onReadyRead()
+{
+    pending.append(socket->readAll());
+
+    // Puede haber varios paquetes juntos o uno cortado al final
+    const int headerSize = int(sizeof(quint16) + sizeof(quint32));
+    while (pending.size() >= headerSize)
+    {
+        QDataStream stream(pending);
+        stream.setByteOrder(QDataStream::BigEndian);
+        quint16 keywordLen;
+        quint32 dataLen;
+        stream >> keywordLen >> dataLen;
+
+        const qint64 total = qint64(headerSize) + keywordLen + dataLen;
+        if (pending.size() < total)
+            return;
+
+        const QString keyword = QString::fromUtf8(pending.mid(headerSize, keywordLen));
+        const QByteArray data = pending.mid(headerSize + keywordLen, int(dataLen));
+        pending.remove(0, int(total));
+
+        qDebug() << "Client: Pedido recibido - Key:" << keyword;
+        emit commandReceived(keyword, data);
+    }
+}
@@ -45,14 +45,19 @@ signals:
     void connected();
     void disconnected();
     void errorOccurred(const QString &err);
+    // Pedido del servidor, mismo formato de paquete que send() sin el
+    // QDataStream interno: [keyword_len][data_len][keyword][data]
+    void commandReceived(const QString &keyword, const QByteArray &data);
 
 private slots:
     void onConnected();
     void onDisconnected();
     void onError(QAbstractSocket::SocketError error);
+    void onReadyRead();
 
 private:
     QTcpSocket *socket;
+    QByteArray pending; // paquetes recibidos a medias
 
     // Método interno para enviar datos serializados
     void sendSerialized(const QString &keyword, const QByteArray &data);
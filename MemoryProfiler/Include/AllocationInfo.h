@@ -1,15 +1,47 @@
 #pragma once
 #include <cstddef>
-#include <string>
-#include <chrono>
+#include <cstdint>
+#include <type_traits>
 
+// Registro compacto por asignación. Archivo/línea y tipo se guardan como IDs
+// de InternTable y se resuelven a texto solo al generar un reporte; la pila
+// de llamadas, como ID de StackTable.
+// Los bitfields no admiten inicializador en C++17: usar `AllocationInfo info{};`.
 struct AllocationInfo
 {
+	// Bits de `flags`
+	static constexpr uint16_t kSampled = 1u << 0;   // registrado por el muestreo
+	static constexpr uint16_t kAligned = 1u << 1;   // operator new con std::align_val_t
+	static constexpr unsigned kSampleShiftBit = 2;  // bits 2..7: log2 del intervalo de muestreo
+	static constexpr uint32_t kMaxSlack = 0xFFF;    // holguras mayores se guardan saturadas
+
+	static constexpr uint32_t kMaxTypeId = 0xFFFF;  // los tipos con ID mayor quedan como kUnknown
+	static constexpr unsigned kStackIdBits = 18;    // cubre StackTable::kMaxRecords
+	static constexpr uint32_t kMaxThreadId = (1u << (32 - kStackIdBits)) - 1; // los hilos posteriores comparten este ID
+	static constexpr unsigned kSiteIdBits = 22;     // cubre la capacidad de sitios de InternTable
+	static constexpr uint32_t kMaxTagId = (1u << (32 - kSiteIdBits)) - 1;     // los tags posteriores comparten este ID
+
 	void* address = nullptr;
-	size_t size = 0;
-	std::string file = "unknown";
-	int line = 0;
-	std::string typeName = "unknown";
-	std::chrono::time_point<std::chrono::high_resolution_clock> timestamp =
-		std::chrono::high_resolution_clock::now();
+	uint64_t size : 44;      // 16 TB alcanzan de sobra para un bloque
+	uint64_t slack : 12;     // usable - pedido, medido al asignar (0 si no se midió)
+	uint64_t flags : 8;
+	uint32_t timestamp = 0;  // 32 bits bajos del sello de TscClock...
+	uint32_t siteId : kSiteIdBits;         // InternTable::internSite(file, line)
+	uint32_t tagId : 32 - kSiteIdBits;     // MT_SCOPE activo al asignar (MemoryTracker::internTag()); 0 = ninguno
+	uint32_t typeId : 16;    // InternTable::internString(type)
+	uint32_t epoch : 16;     // ...y los 16 altos: la época de 2^32 unidades
+	uint32_t stackId : kStackIdBits;       // StackTable::intern(); 0 = sin pila capturada
+	uint32_t threadId : 32 - kStackIdBits; // hilo que asignó (MemoryTracker::currentThreadId()); 0 = desconocido
+
+	// Sello de 48 bits (TscClock::kStampBits)
+	uint64_t stamp() const noexcept { return (static_cast<uint64_t>(epoch) << 32) | timestamp; }
+	void setStamp(uint64_t s) noexcept
+	{
+		timestamp = static_cast<uint32_t>(s);
+		epoch = static_cast<uint32_t>(s >> 32) & 0xFFFF;
+	}
 };
+
+// Dos registros por línea de caché
+static_assert(sizeof(AllocationInfo) == 32, "AllocationInfo debe ocupar 32 bytes");
+static_assert(std::is_trivially_copyable<AllocationInfo>::value, "AllocationInfo debe ser POD");
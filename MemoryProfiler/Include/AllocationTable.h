@@ -0,0 +1,209 @@
+#pragma once
+#include "AllocationInfo.h"
+#include "BlockHeader.h"
+#include "SlabAllocator.h"
+#include <unordered_map>
+#include <mutex>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+//==================================================
+// Tabla de asignaciones particionada por dirección
+//==================================================
+// Cada shard tiene su propio mutex y su propio mapa, alineados a una línea
+// de caché para que dos hilos que registran punteros de shards distintos no
+// compitan por el mismo lock ni por la misma línea (false sharing).
+// Las lecturas que necesitan una vista consistente de toda la tabla usan
+// lockAll(), que toma los locks de todos los shards en orden fijo. Los
+// reportes usan snapshot(), que no frena a toda la tabla a la vez.
+// Los nodos de cada mapa salen del SlabArena del propio shard, que no
+// necesita lock propio porque solo se usa bajo el mutex del shard.
+//
+// En modo cabecera (MT_INLINE_HEADERS) los registros viven dentro de los
+// propios bloques y cada shard solo mantiene una lista intrusiva de ellos:
+// link()/unlink() son O(1) y no reservan nada. Ambos modos conviven (el
+// interposer de malloc sigue usando el mapa) y los recorridos ven los dos.
+class AllocationTable
+{
+public:
+    static constexpr unsigned kShardBits = 6;
+    static constexpr size_t kShardCount = size_t(1) << kShardBits;
+    static constexpr size_t kCacheLineSize = 64;
+
+private:
+    using Map = std::unordered_map<void *, AllocationInfo, std::hash<void *>, std::equal_to<void *>,
+                                   SlabAllocator<std::pair<void *const, AllocationInfo>>>;
+
+    struct alignas(kCacheLineSize) Shard
+    {
+        std::mutex mtx;
+        SlabArena arena{false};
+        Map map{0, std::hash<void *>(), std::equal_to<void *>(), Map::allocator_type(&arena)};
+        BlockHeader *blocks = nullptr;
+        size_t blockCount = 0;
+    };
+
+public:
+    // Vista exclusiva de toda la tabla: mientras exista, ningún hilo puede
+    // registrar ni liberar, por lo que los contadores globales que se
+    // actualizan dentro de la sección crítica del shard también son estables.
+    class ExclusiveScope
+    {
+    public:
+        explicit ExclusiveScope(AllocationTable &table);
+        ~ExclusiveScope();
+        ExclusiveScope(const ExclusiveScope &) = delete;
+        ExclusiveScope &operator=(const ExclusiveScope &) = delete;
+
+        size_t size() const;
+
+        template <typename Fn>
+        void forEach(Fn &&fn) const
+        {
+            for (const Shard &shard : table.shards)
+            {
+                for (const auto &kv : shard.map)
+                {
+                    fn(kv.second);
+                }
+                for (BlockHeader *block = shard.blocks; block; block = block->next)
+                {
+                    fn(block->info());
+                }
+            }
+        }
+
+    private:
+        AllocationTable &table;
+    };
+
+    // Copia de los registros vivos tomada shard por shard: cada lock se
+    // suelta apenas se copian sus registros, así un hilo que asigna espera
+    // como mucho la copia de un shard y nunca el recorrido del lector. La
+    // foto es exacta por shard pero no atómica entre shards. La memoria sale
+    // directamente del SO, fuera de los operadores instrumentados.
+    class Snapshot
+    {
+    public:
+        Snapshot() = default;
+        ~Snapshot();
+        Snapshot(Snapshot &&other) noexcept;
+        Snapshot &operator=(Snapshot &&other) noexcept;
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+
+        size_t size() const noexcept { return count; }
+        // false si el SO no dio memoria para copiar todos los registros
+        bool complete() const noexcept { return !truncated; }
+
+        const AllocationInfo &operator[](size_t i) const noexcept { return records[i]; }
+        const AllocationInfo *begin() const noexcept { return records; }
+        const AllocationInfo *end() const noexcept { return records + count; }
+
+    private:
+        friend class AllocationTable;
+        bool reserve(size_t capacity) noexcept;
+
+        AllocationInfo *records = nullptr;
+        size_t count = 0;
+        size_t capacity = 0;
+        bool truncated = false;
+    };
+
+    AllocationTable() = default;
+    AllocationTable(const AllocationTable &) = delete;
+    AllocationTable &operator=(const AllocationTable &) = delete;
+
+    // Inserta el registro de info.address. Si la dirección ya tenía uno,
+    // `keepOld` decide: true conserva el existente y descarta info (devuelve
+    // false); si no, el viejo pasa por `onReplaced` antes de pisarlo. Se
+    // ejecuta `onLocked` dentro de la sección crítica del shard para que el
+    // llamador actualice sus contadores de forma atómica respecto a lockAll().
+    template <typename KeepOld, typename OnReplaced, typename OnLocked>
+    bool insert(const AllocationInfo &info, KeepOld &&keepOld, OnReplaced &&onReplaced, OnLocked &&onLocked)
+    {
+        Shard &shard = shardFor(info.address);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto result = shard.map.try_emplace(info.address, info);
+        if (!result.second)
+        {
+            AllocationInfo &existing = result.first->second;
+            if (keepOld(static_cast<const AllocationInfo &>(existing)))
+                return false;
+            onReplaced(static_cast<const AllocationInfo &>(existing));
+            existing = info;
+        }
+        onLocked(info);
+        return true;
+    }
+
+    // Elimina el registro de ptr. Devuelve false si no estaba registrado.
+    template <typename OnLocked>
+    bool erase(void *ptr, OnLocked &&onLocked)
+    {
+        return eraseIf(
+            ptr, [](const AllocationInfo &)
+            { return true; },
+            std::forward<OnLocked>(onLocked));
+    }
+
+    // Igual que erase(), pero solo si `match` acepta el registro encontrado.
+    template <typename Match, typename OnLocked>
+    bool eraseIf(void *ptr, Match &&match, OnLocked &&onLocked)
+    {
+        Shard &shard = shardFor(ptr);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.map.find(ptr);
+        if (it == shard.map.end() || !match(it->second))
+            return false;
+        onLocked(it->second);
+        shard.map.erase(it);
+        return true;
+    }
+
+    // Modo cabecera: agrega el bloque a la lista de su shard (elegido por
+    // el puntero de usuario, igual que en el mapa) y marca kLinked.
+    template <typename OnLocked>
+    void link(BlockHeader *block, OnLocked &&onLocked)
+    {
+        Shard &shard = shardFor(block->user());
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        block->prev = nullptr;
+        block->next = shard.blocks;
+        if (shard.blocks)
+            shard.blocks->prev = block;
+        shard.blocks = block;
+        ++shard.blockCount;
+        block->flags |= BlockHeader::kLinked;
+        onLocked(block->info());
+    }
+
+    template <typename OnLocked>
+    void unlink(BlockHeader *block, OnLocked &&onLocked)
+    {
+        Shard &shard = shardFor(block->user());
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        onLocked(block->info());
+        if (block->prev)
+            block->prev->next = block->next;
+        else
+            shard.blocks = block->next;
+        if (block->next)
+            block->next->prev = block->prev;
+        --shard.blockCount;
+        block->flags &= ~BlockHeader::kLinked;
+    }
+
+    ExclusiveScope lockAll() { return ExclusiveScope(*this); }
+    // `expected`: tamaño estimado, para reservar de una vez
+    Snapshot snapshot(size_t expected = 0);
+
+    static size_t shardIndex(const void *ptr) noexcept;
+
+private:
+    Shard &shardFor(const void *ptr) noexcept { return shards[shardIndex(ptr)]; }
+
+    std::array<Shard, kShardCount> shards;
+};
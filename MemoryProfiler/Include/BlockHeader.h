@@ -0,0 +1,62 @@
+#pragma once
+#include "AllocationInfo.h"
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Cabecera en línea (modo MT_INLINE_HEADERS)
+//==================================================
+// Los operadores reservan sizeof(BlockHeader) bytes extra (más el relleno
+// que pida la alineación) y la cabecera queda justo antes del puntero que
+// recibe el usuario. Guarda lo mismo que AllocationInfo, así el delete
+// actualiza las estadísticas sin buscar en ninguna tabla, y los enlaces de
+// la lista intrusiva del shard para poder enumerar los bloques vivos.
+//
+// Todos los bloques de los operadores llevan cabecera, también los que no
+// se registran (internos del tracker, no muestreados): kLinked distingue
+// los que están en una lista.
+struct BlockHeader
+{
+	static constexpr uint16_t kLinked = 1u << 15; // en la lista de su shard
+
+	BlockHeader* prev;
+	BlockHeader* next;
+	uint64_t size : 48;
+	uint64_t flags : 16;    // AllocationInfo::flags | kLinked
+	uint64_t stamp : 48;    // sello de TscClock
+	uint64_t slack : 16;    // usable - pedido, como en AllocationInfo
+	uint32_t siteId : AllocationInfo::kSiteIdBits; // como en AllocationInfo
+	uint32_t tagId : 32 - AllocationInfo::kSiteIdBits;
+	uint32_t typeId;
+	uint32_t stackId : AllocationInfo::kStackIdBits; // como en AllocationInfo
+	uint32_t threadId : 32 - AllocationInfo::kStackIdBits;
+	uint32_t baseOffset;    // del inicio del bloque de malloc al payload: los bytes extra por bloque
+
+	void* user() noexcept { return reinterpret_cast<unsigned char*>(this) + sizeof(BlockHeader); }
+	void* base() noexcept { return static_cast<unsigned char*>(user()) - baseOffset; }
+
+	static BlockHeader* of(void* user) noexcept
+	{
+		return reinterpret_cast<BlockHeader*>(static_cast<unsigned char*>(user) - sizeof(BlockHeader));
+	}
+
+	AllocationInfo info() noexcept
+	{
+		AllocationInfo out{};
+		out.address = user();
+		out.size = size;
+		out.flags = flags & ~kLinked;
+		out.setStamp(stamp);
+		out.slack = slack;
+		out.siteId = siteId;
+		out.tagId = tagId;
+		out.typeId = typeId <= AllocationInfo::kMaxTypeId ? typeId : 0;
+		out.stackId = stackId;
+		out.threadId = threadId;
+		return out;
+	}
+};
+
+// Múltiplo de 16: el payload conserva la alineación de malloc
+static_assert(sizeof(BlockHeader) == 48, "BlockHeader debe ocupar 48 bytes");
+static_assert(sizeof(BlockHeader) % 16 == 0, "BlockHeader debe preservar la alineación de malloc");
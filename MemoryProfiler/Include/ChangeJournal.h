@@ -0,0 +1,121 @@
+#pragma once
+#include "AllocationInfo.h"
+#include "AllocationTable.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Diario de cambios para comparar snapshots del heap
+//==================================================
+// Mientras haya snapshots vivos, cada alloc/free agrega un Change de 32
+// bytes al diario del shard donde ocurrió, etiquetado con la generación
+// actual. Un snapshot es solo una generación más su sello: comparar dos
+// recorre los cambios de esas generaciones, no el heap.
+//
+// Igual que SizeHistogram, cada franja se escribe solo dentro de la sección
+// crítica de su shard, así que tiene un único escritor a la vez y las
+// etiquetas no decrecen dentro de la franja. Los lectores no toman los
+// locks de los shards; lectores y trim() deben serializarse entre sí.
+// Los chunks salen directamente del SO.
+class ChangeJournal
+{
+public:
+    struct Change
+    {
+        static constexpr uint16_t kFreed = 1u << 15; // en `flags`, junto a los de AllocationInfo
+
+        uint64_t size : 48;
+        uint64_t flags : 16;
+        uint64_t stamp;         // sello del evento
+        uint64_t allocStamp : 48; // en un free: cuándo se asignó el bloque
+        uint64_t typeId : 16;
+        uint32_t siteId;
+        uint32_t generation;
+    };
+    static_assert(sizeof(Change) == 32, "Change debe ocupar 32 bytes");
+
+    ChangeJournal() = default;
+    ~ChangeJournal();
+    ChangeJournal(const ChangeJournal &) = delete;
+    ChangeJournal &operator=(const ChangeJournal &) = delete;
+
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool on) noexcept { enabled.store(on, std::memory_order_relaxed); }
+
+    // Abre una generación nueva y la devuelve: lo que se registre desde
+    // ahora lleva esa etiqueta o una mayor
+    uint32_t advance() noexcept { return generation.fetch_add(1, std::memory_order_acq_rel) + 1; }
+
+    // Requiere el lock del shard `stripe`
+    void record(size_t stripe, const AllocationInfo &info, uint64_t stamp, bool freed) noexcept
+    {
+        if (!isEnabled())
+            return;
+        Change c;
+        c.size = info.size;
+        c.flags = info.flags | (freed ? Change::kFreed : 0);
+        c.stamp = stamp;
+        c.allocStamp = info.stamp();
+        c.typeId = info.typeId;
+        c.siteId = info.siteId;
+        c.generation = generation.load(std::memory_order_relaxed);
+        append(stripes[stripe], c);
+    }
+
+    // Cambios con etiqueta en [fromGen, toGen], franja por franja
+    template <typename Fn>
+    void forEach(uint32_t fromGen, uint32_t toGen, Fn &&fn) const
+    {
+        for (const Stripe &stripe : stripes)
+        {
+            for (const Chunk *chunk = stripe.head.load(std::memory_order_acquire); chunk;
+                 chunk = chunk->next.load(std::memory_order_acquire))
+            {
+                if (chunk->firstGen > toGen)
+                    break;
+                const uint32_t count = chunk->count.load(std::memory_order_acquire);
+                if (!count || chunk->entries[count - 1].generation < fromGen)
+                    continue;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    const Change &c = chunk->entries[i];
+                    if (c.generation > toGen)
+                        break;
+                    if (c.generation >= fromGen)
+                        fn(c);
+                }
+            }
+        }
+    }
+
+    // Libera los chunks que solo tienen etiquetas menores que `gen`
+    void trim(uint32_t gen) noexcept;
+
+    // Algún chunk no se pudo reservar: faltan cambios desde entonces
+    bool overflowed() const noexcept { return lost.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t kChunkEntries = 2047;
+
+    struct Chunk
+    {
+        std::atomic<Chunk *> next{nullptr};
+        std::atomic<uint32_t> count{0};
+        uint32_t firstGen = 0;
+        Change entries[kChunkEntries];
+    };
+
+    struct alignas(AllocationTable::kCacheLineSize) Stripe
+    {
+        std::atomic<Chunk *> head{nullptr}; // lo avanza trim()
+        Chunk *tail = nullptr;              // solo el escritor
+    };
+
+    void append(Stripe &stripe, const Change &c) noexcept;
+
+    std::atomic<bool> enabled{false};
+    std::atomic<uint32_t> generation{0};
+    std::atomic<bool> lost{false};
+    Stripe stripes[AllocationTable::kShardCount];
+};
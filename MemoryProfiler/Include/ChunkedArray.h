@@ -0,0 +1,63 @@
+#pragma once
+#include "SlabAllocator.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+//==================================================
+// Arreglo por bloques de solo inserción
+//==================================================
+// push_back bajo un mutex del dueño; lectura concurrente sin locks porque
+// los bloques nunca se mueven. La memoria sale de SlabArena::shared().
+template <typename T>
+class ChunkedArray
+{
+public:
+    static constexpr uint32_t kChunkBits = 10;
+    static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+    static constexpr uint32_t kMaxChunks = 4096;
+
+    ChunkedArray() = default;
+    ChunkedArray(const ChunkedArray &) = delete;
+    ChunkedArray &operator=(const ChunkedArray &) = delete;
+
+    ~ChunkedArray()
+    {
+        for (auto &chunk : chunks)
+        {
+            SlabArena::shared().deallocate(chunk.load(std::memory_order_relaxed), kChunkSize * sizeof(T));
+        }
+    }
+
+    bool push_back(const T &value)
+    {
+        const uint32_t i = count.load(std::memory_order_relaxed);
+        const uint32_t c = i >> kChunkBits;
+        if (c >= kMaxChunks)
+            return false;
+
+        T *chunk = chunks[c].load(std::memory_order_relaxed);
+        if (!chunk)
+        {
+            chunk = static_cast<T *>(SlabArena::shared().allocate(kChunkSize * sizeof(T)));
+            if (!chunk)
+                return false;
+            std::memset(static_cast<void *>(chunk), 0, kChunkSize * sizeof(T));
+            chunks[c].store(chunk, std::memory_order_release);
+        }
+        chunk[i & (kChunkSize - 1)] = value;
+        count.store(i + 1, std::memory_order_release);
+        return true;
+    }
+
+    const T &operator[](uint32_t i) const noexcept
+    {
+        return chunks[i >> kChunkBits].load(std::memory_order_acquire)[i & (kChunkSize - 1)];
+    }
+
+    uint32_t size() const noexcept { return count.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<T *> chunks[kMaxChunks] = {};
+    std::atomic<uint32_t> count{0};
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Evento de asignación de tamaño fijo
+//==================================================
+// Es lo único que escribe el hilo que asigna en modo buffered: se copian los
+// punteros tal cual (file/type son literales con vida estática) y el
+// agregador hace el resto del trabajo más tarde. El productor llena
+// ptr/size/file/type/line, el sello y flags; hilo, tag e ID de pila los
+// completa el agregador al drenar.
+struct AllocationEvent
+{
+    enum Kind : uint8_t
+    {
+        Alloc = 0,
+        Free = 1,
+        Scope = 2 // cambio de MT_SCOPE del hilo dueño; no llega a la tabla
+    };
+
+    // Free de un delete sized/alineado: `size` (si no es 0) y kAligned se
+    // verifican contra el registro
+    static constexpr uint16_t kCheckedFree = 1u << 15;
+    // Alloc de un bloque de malloc sin medir: el agregador estima la holgura
+    static constexpr uint16_t kEstimateSlack = 1u << 14;
+
+    void *ptr;
+    size_t size;
+    const char *file;
+    const char *type;
+    uint64_t timestamp; // sello de TscClock, sirve para ordenar entre hilos
+    int32_t line;
+    Kind kind;
+    uint8_t deferrals; // veces que un Free se pospuso esperando su Alloc
+    uint16_t flags;    // Alloc: AllocationInfo::flags | kEstimateSlack. Free: kCheckedFree | kAligned esperado
+    uint32_t stackId;  // Alloc: lo interna el agregador con las direcciones crudas
+    uint16_t slack;    // Alloc: usable - pedido, si el productor ya lo tenía
+    uint16_t frames;   // Alloc: direcciones de retorno que siguen al evento en el ring
+    uint32_t threadId; // hilo dueño del buffer, lo completa el agregador
+    uint32_t tagId;    // Alloc: MT_SCOPE activo, lo repone el agregador. Scope: tag nuevo
+};
+
+//==================================================
+// Ring buffer SPSC por hilo
+//==================================================
+// Productor: el hilo dueño (operator new/delete). Consumidor: el agregador,
+// siempre bajo el mutex de drenado del tracker. Los índices crecen sin
+// límite y se enmascaran al acceder, así lleno/vacío no son ambiguos.
+//
+// Con captura de pilas, las direcciones de retorno de un Alloc ocupan las
+// ranuras siguientes a su evento y se publican con él en un solo store.
+class ThreadEventBuffer
+{
+public:
+    static constexpr uint32_t kCapacity = 2048;
+    static constexpr uint32_t kMaxFrames = 64;
+
+    // Se reserva con páginas del SO para no pasar por los operadores instrumentados.
+    static ThreadEventBuffer *create() noexcept;
+    static void destroy(ThreadEventBuffer *buffer) noexcept;
+
+    bool tryPush(const AllocationEvent &ev, void *const *frames = nullptr) noexcept
+    {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        const uint32_t used = slotsFor(ev);
+        if (t - head.load(std::memory_order_acquire) + used > kCapacity)
+            return false;
+        slots[t & (kCapacity - 1)].event = ev;
+        for (uint32_t i = 0; i < ev.frames; ++i)
+            slots[(t + 1 + i / kFramesPerSlot) & (kCapacity - 1)].frames[i % kFramesPerSlot] = frames[i];
+        tail.store(t + used, std::memory_order_release);
+        return true;
+    }
+
+    // Extrae todos los eventos publicados hasta este momento. `fn` recibe
+    // una copia modificable del evento y sus direcciones de retorno.
+    template <typename Fn>
+    size_t drain(Fn &&fn)
+    {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        const uint32_t t = tail.load(std::memory_order_acquire);
+        size_t count = 0;
+        void *frames[kMaxFrames];
+        for (uint32_t i = h; i != t; i += slotsFor(slots[i & (kCapacity - 1)].event))
+        {
+            AllocationEvent ev = slots[i & (kCapacity - 1)].event;
+            for (uint32_t f = 0; f < ev.frames; ++f)
+                frames[f] = slots[(i + 1 + f / kFramesPerSlot) & (kCapacity - 1)].frames[f % kFramesPerSlot];
+            fn(ev, static_cast<void *const *>(frames));
+            ++count;
+        }
+        head.store(t, std::memory_order_release);
+        return count;
+    }
+
+    bool empty() const noexcept
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    // El hilo dueño terminó; el agregador lo libera tras el último drenado.
+    void retire() noexcept { retired.store(true, std::memory_order_release); }
+    bool isRetired() const noexcept { return retired.load(std::memory_order_acquire); }
+
+    ThreadEventBuffer *next = nullptr; // lista intrusiva del tracker
+
+    // Los fija el hilo dueño al crear el buffer, antes de publicarlo; después
+    // solo los toca el agregador, que repite los eventos Scope sobre `tag`.
+    uint32_t threadId = 0;
+    uint32_t tag = 0;
+
+private:
+    static constexpr uint32_t kFramesPerSlot = sizeof(AllocationEvent) / sizeof(void *);
+
+    union Slot
+    {
+        AllocationEvent event;
+        void *frames[kFramesPerSlot];
+    };
+
+    static uint32_t slotsFor(const AllocationEvent &ev) noexcept
+    {
+        return 1 + (ev.frames + kFramesPerSlot - 1) / kFramesPerSlot;
+    }
+
+    ThreadEventBuffer() = default;
+
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    std::atomic<bool> retired{false};
+    alignas(64) Slot slots[kCapacity];
+};
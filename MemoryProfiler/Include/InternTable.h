@@ -0,0 +1,104 @@
+#pragma once
+#include "AllocationInfo.h"
+#include "ChunkedArray.h"
+#include "SlabAllocator.h"
+#include <atomic>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Tabla de internado de strings y sitios de llamada
+//==================================================
+// Convierte los `const char*` de __FILE__ / tipo y los pares (archivo, línea)
+// en IDs pequeños. En el camino caliente solo se consulta una caché indexada
+// por el valor del puntero (sin locks ni comparar strings); el mutex y la
+// comparación por contenido se usan solo la primera vez que aparece un
+// puntero; la caché crece con la cantidad de sitios, así que un programa
+// con muchos no termina volviendo al mutex en cada asignación. Los IDs
+// nunca se reutilizan y resolverlos no toma locks.
+// Todo el almacenamiento sale de SlabArena::shared().
+class InternTable
+{
+public:
+    static constexpr uint32_t kUnknown = 0; // "unknown" y el sitio ("unknown", 0)
+
+    struct Site
+    {
+        uint32_t fileId;
+        int32_t line;
+    };
+
+    InternTable();
+    ~InternTable();
+    InternTable(const InternTable &) = delete;
+    InternTable &operator=(const InternTable &) = delete;
+
+    // `str` debe vivir tanto como la tabla (literales, __FILE__): la caché
+    // es por valor del puntero
+    uint32_t internString(const char *str);
+    // Por contenido y bajo el mutex, para textos armados en tiempo de ejecución
+    uint32_t internText(std::string_view text);
+    uint32_t internSite(const char *file, int line);
+
+    // Resolución sin locks; el puntero vive mientras viva la tabla.
+    const char *string(uint32_t id) const noexcept;
+    Site site(uint32_t siteId) const noexcept;
+
+    uint32_t stringCount() const noexcept { return strings.size(); }
+    uint32_t siteCount() const noexcept { return sites.size(); }
+
+private:
+    // Caché de punteros: cada slot se escribe una sola vez (bajo el mutex) y
+    // se publica con la clave al final, así un lector nunca ve un slot a medias.
+    struct PointerSlot
+    {
+        std::atomic<const char *> key{nullptr};
+        std::atomic<int32_t> line{0};
+        std::atomic<uint32_t> id{0};
+    };
+
+    // Sondeo lineal sobre una tabla que crece al doble antes de pasar la
+    // mitad de su capacidad o cuando un puntero no entra en kMaxProbes: la
+    // nueva se llena bajo el mutex y recién entonces se publica. La vieja
+    // puede seguir teniendo lectores, así que queda retirada hasta que se
+    // destruya la InternTable (entre todas, menos del doble de la última).
+    struct PointerCache
+    {
+        size_t mask;
+        size_t used;            // slots ocupados; bajo el mutex
+        PointerCache *retired;  // la tabla que reemplazó
+
+        PointerSlot *slots() noexcept { return reinterpret_cast<PointerSlot *>(this + 1); }
+        const PointerSlot *slots() const noexcept { return reinterpret_cast<const PointerSlot *>(this + 1); }
+    };
+    static constexpr size_t kInitialCacheSlots = 4096;
+    static constexpr size_t kMaxProbes = 16;
+
+    static size_t slotFor(const char *ptr, int line, size_t mask) noexcept;
+    static PointerCache *createCache(size_t slots) noexcept;
+    static void destroyCache(PointerCache *cache) noexcept;
+    static bool tryCacheStore(PointerCache *cache, const char *ptr, int line, uint32_t id) noexcept;
+    bool cacheLookup(const std::atomic<PointerCache *> &cache, const char *ptr, int line, uint32_t &id) const noexcept;
+    void cacheStore(std::atomic<PointerCache *> &cache, const char *ptr, int line, uint32_t id) noexcept;
+    uint32_t internStringLocked(std::string_view str);
+
+    template <typename K>
+    using IdMap = std::unordered_map<K, uint32_t, std::hash<K>, std::equal_to<K>,
+                                     SlabAllocator<std::pair<const K, uint32_t>>>;
+
+    std::mutex mtx;
+    IdMap<std::string_view> stringIds; // dedupe por contenido
+    IdMap<uint64_t> siteIds;           // (fileId, line) -> siteId
+    ChunkedArray<const char *> strings;
+    ChunkedArray<Site> sites;
+
+    std::atomic<PointerCache *> stringCache{nullptr};
+    std::atomic<PointerCache *> siteCache{nullptr};
+};
+
+// Con la tabla de sitios llena internSite() devuelve kUnknown
+static_assert(uint64_t(ChunkedArray<InternTable::Site>::kMaxChunks) * ChunkedArray<InternTable::Site>::kChunkSize <= (uint64_t(1) << AllocationInfo::kSiteIdBits),
+              "los IDs de sitio no entran en AllocationInfo::siteId");
@@ -0,0 +1,104 @@
+#pragma once
+#include "AllocationTable.h"
+#include <atomic>
+#include <csetjmp>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Escaneo conservador de alcanzabilidad
+//==================================================
+// Separa las fugas reales de la memoria que sigue en uso, como hace el
+// leak checker de Valgrind: detiene los demás hilos de la aplicación con
+// una señal, toma como raíces sus pilas (los registros quedan en el marco
+// de la señal), la pila del hilo actual y los segmentos escribibles de
+// cada módulo (.data/.bss), y marca todo bloque de la foto al que apunte
+// una palabra alineada, también desde dentro de otros bloques marcados.
+// Un puntero interior también cuenta.
+//
+// Lo que no se marca se divide en perdido directo (ningún bloque
+// perdido apunta a él) e indirecto (solo se llega desde otro perdido).
+//
+// El marcado corre en varios hilos creados antes de detener el mundo.
+// Mientras los demás están detenidos no se toma ningún lock del tracker ni
+// de malloc: toda la memoria de trabajo sale directamente del SO.
+//
+// Límites: solo Linux; no se recorren otras regiones anónimas (arenas
+// propias de la aplicación) ni pilas alternativas de señales; un bloque
+// asignado entre la foto y la detención no se conoce; con muestreo solo se
+// ven los bloques muestreados, y la clasificación es aproximada.
+// Registros y posición de pila del hilo que pide el escaneo, tomados al
+// entrar al tracker con LeakScanner::captureCaller(). Su pila se recorre
+// desde aquí hacia arriba: la foto y el índice que se arman después dejan
+// direcciones de bloques en marcos más profundos, y como raíces harían
+// alcanzable cualquier bloque.
+struct LeakScanCaller
+{
+    jmp_buf regs;
+};
+
+class LeakScanner
+{
+public:
+    enum State : uint8_t
+    {
+        Unreached = 0,
+        Reachable = 1,
+        IndirectlyLost = 2,
+        DefinitelyLost = 3,
+        Gone = 4 // se liberó (y desmapeó) después de la foto: no cuenta
+    };
+
+    explicit LeakScanner(const AllocationTable::Snapshot &records) noexcept;
+    ~LeakScanner();
+    LeakScanner(const LeakScanner &) = delete;
+    LeakScanner &operator=(const LeakScanner &) = delete;
+
+    // Llamar antes de tomar la foto, en un marco que siga vivo durante run()
+    static void captureCaller(LeakScanCaller &caller) noexcept;
+
+    // 0 hilos = según los núcleos. false si la plataforma no lo soporta o
+    // faltó memoria; entonces state() no sirve.
+    bool run(const LeakScanCaller &caller, unsigned workers = 0) noexcept;
+
+    // Por índice de registro en la foto
+    State state(size_t record) const noexcept { return static_cast<State>(recordStates[record]); }
+
+    bool allThreadsStopped() const noexcept { return everyoneStopped; }
+    unsigned stoppedThreads() const noexcept { return stopped; }
+    unsigned workerThreads() const noexcept { return workerCount; }
+
+private:
+    struct Block
+    {
+        uintptr_t start;
+        uintptr_t end;
+        uint32_t record;
+    };
+
+    class MarkPool;
+
+    static constexpr size_t kNotFound = ~size_t(0);
+
+    bool buildIndex() noexcept;
+    // Bloque que contiene `value` (puntero interior incluido) o kNotFound
+    size_t find(uintptr_t value) const noexcept;
+    // Llama a onHit(posición) por cada palabra alineada de [begin, end) que apunte a un bloque
+    template <typename OnHit>
+    void scanWords(uintptr_t begin, uintptr_t end, OnHit &&onHit) const noexcept;
+    void classifyLost() noexcept;
+
+    const AllocationTable::Snapshot &records;
+    size_t count = 0;
+    Block *blocks = nullptr;              // ordenados por dirección
+    std::atomic<uint8_t> *marks = nullptr; // por posición en `blocks`
+    uint8_t *recordStates = nullptr;      // por índice de registro
+    uint32_t *frontier = nullptr;         // desbordes de las pilas locales
+    uint32_t *nextFrontier = nullptr;
+    uintptr_t minAddress = 0;
+    uintptr_t maxAddress = 0;
+
+    bool everyoneStopped = false;
+    unsigned stopped = 0;
+    unsigned workerCount = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "LogLinearBuckets.h"
+#include "PagedDirectory.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Histogramas de vida por sitio de llamada
+//==================================================
+// Al liberar, la vida del bloque (free - alloc, en ns) se suma al
+// histograma de su siteId. Cada histograma se crea la primera vez que un
+// sitio libera algo (PagedDirectory) y nunca se mueve: leer no toma locks. Los conteos van en el punto
+// fijo del tracker para que las muestras pesen lo que representan.
+class LifetimeTable
+{
+public:
+    // ns: de 0 a ~18 minutos con error < 25%; lo más largo cae en el último bucket
+    using Scale = LogLinearBuckets<2, 40>;
+    static constexpr unsigned kBucketCount = Scale::kCount;
+
+    LifetimeTable() = default;
+    LifetimeTable(const LifetimeTable &) = delete;
+    LifetimeTable &operator=(const LifetimeTable &) = delete;
+
+    void record(uint32_t siteId, int64_t lifetimeNs, uint64_t countFx) noexcept;
+
+    // Copia los conteos del sitio; false si nunca liberó nada
+    bool snapshot(uint32_t siteId, uint64_t (&out)[kBucketCount]) const noexcept;
+
+private:
+    struct Histogram
+    {
+        std::atomic<uint64_t> counts[kBucketCount];
+    };
+
+    PagedDirectory<Histogram> histograms;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//==================================================
+// Escala log-lineal de buckets
+//==================================================
+// Potencias de dos con 2^SubBits subdivisiones lineales cada una (como
+// HdrHistogram): valores 0..2^(SubBits+1)-1 exactos, después con error
+// relativo menor a 1/2^SubBits. Lo que pase de 2^(MaxLog2+1) cae en el
+// último bucket.
+template <unsigned SubBits, unsigned MaxLog2>
+struct LogLinearBuckets
+{
+    static constexpr unsigned kSubBuckets = 1u << SubBits;
+    static constexpr unsigned kLinearLimit = 2 * kSubBuckets; // debajo de esto, un bucket por valor
+    static constexpr unsigned kCount = kLinearLimit + (MaxLog2 - SubBits) * kSubBuckets;
+
+    static unsigned bucketOf(uint64_t value) noexcept
+    {
+        if (value < kLinearLimit)
+            return static_cast<unsigned>(value);
+        const unsigned log2 = floorLog2(value);
+        if (log2 > MaxLog2)
+            return kCount - 1;
+        const unsigned sub = static_cast<unsigned>(value >> (log2 - SubBits)) & (kSubBuckets - 1);
+        return kLinearLimit + (log2 - SubBits - 1) * kSubBuckets + sub;
+    }
+
+    // Rango [lower, upper] de valores que caen en el bucket
+    static uint64_t lower(unsigned bucket) noexcept
+    {
+        if (bucket < kLinearLimit)
+            return bucket;
+        const unsigned k = bucket - kLinearLimit;
+        const unsigned log2 = SubBits + 1 + k / kSubBuckets;
+        return static_cast<uint64_t>(kSubBuckets + k % kSubBuckets) << (log2 - SubBits);
+    }
+
+    static uint64_t upper(unsigned bucket) noexcept
+    {
+        if (bucket < kLinearLimit)
+            return bucket;
+        const unsigned log2 = SubBits + 1 + (bucket - kLinearLimit) / kSubBuckets;
+        return lower(bucket) + (uint64_t(1) << (log2 - SubBits)) - 1;
+    }
+
+    static unsigned floorLog2(uint64_t value) noexcept
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+    }
+};
@@ -1,10 +1,25 @@
 #pragma once
 #include <cstddef>
 #include <new>
+#include "TrackedNew.h"
 
 void force_link_memory_operators();
 
 void* operator new(std::size_t size, const char* file, int line);
 void* operator new[](std::size_t size, const char* file, int line);
+// Tipos sobrealineados: sin estas, `new(__FILE__, __LINE__) T` caería en la
+// versión sin alineación
+void* operator new(std::size_t size, std::align_val_t alignment, const char* file, int line);
+void* operator new[](std::size_t size, std::align_val_t alignment, const char* file, int line);
 
-#define new new(__FILE__, __LINE__)
\ No newline at end of file
+// Placement delete correspondientes (constructor que lanza)
+void operator delete(void* ptr, const char* file, int line) noexcept;
+void operator delete[](void* ptr, const char* file, int line) noexcept;
+void operator delete(void* ptr, std::align_val_t alignment, const char* file, int line) noexcept;
+void operator delete[](void* ptr, std::align_val_t alignment, const char* file, int line) noexcept;
+
+// Con MT_DISABLED (opción de CMake) new queda como el del lenguaje y los
+// operadores son malloc/free sin más
+#if !defined(MT_DISABLED)
+#define new new(__FILE__, __LINE__)
+#endif
\ No newline at end of file
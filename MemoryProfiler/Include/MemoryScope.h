@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+//==================================================
+// Tags por ámbito (MT_SCOPE)
+//==================================================
+// Atribuye lo que se asigna dentro de un bloque a un subsistema lógico
+// (tipo de pedido, etapa de un pipeline, cliente) además de a su archivo y
+// línea. Cada hilo tiene su tag actual: un MT_SCOPE anidado lo reemplaza y
+// al salir se restaura el anterior, así los objetos forman una pila en el
+// propio stack del hilo. El registro solo lee ese tag, sin locks.
+//
+// Un bloque queda con el tag del hilo que lo asignó aunque se libere fuera
+// del ámbito o en otro hilo. Con un literal el nombre se resuelve por el
+// valor del puntero, sin locks; un nombre armado en tiempo de ejecución
+// (p. ej. por cliente) debe pasarse como std::string, nunca su c_str(), y
+// se interna por contenido bajo el mutex de InternTable.
+class MemoryScope
+{
+public:
+    explicit MemoryScope(const char *name);
+    explicit MemoryScope(std::string_view name);
+    ~MemoryScope();
+    MemoryScope(const MemoryScope &) = delete;
+    MemoryScope &operator=(const MemoryScope &) = delete;
+
+    // Tag del hilo actual; 0 = fuera de todo ámbito
+    static uint32_t current() noexcept { return tag; }
+
+private:
+    static void setTag(uint32_t tagId) noexcept;
+
+    static thread_local uint32_t tag;
+    uint32_t previous;
+};
+
+#define MT_SCOPE_CONCAT_(a, b) a##b
+#define MT_SCOPE_CONCAT(a, b) MT_SCOPE_CONCAT_(a, b)
+#if defined(MT_DISABLED)
+#define MT_SCOPE(name) static_cast<void>(0)
+#else
+// Llaves: con paréntesis, MT_SCOPE(std::string(x)) declararía una función
+#define MT_SCOPE(name) MemoryScope MT_SCOPE_CONCAT(mt_scope_, __LINE__){name}
+#endif
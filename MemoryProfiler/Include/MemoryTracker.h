@@ -1,13 +1,31 @@
 ﻿#pragma once
 #include "AllocationInfo.h"
-#include "ServerClient.h"
-#include <unordered_map>
-#include <mutex>
+#include "AllocationTable.h"
+#include "BlockHeader.h"
+#include "ChangeJournal.h"
+#include "EventBuffer.h"
+#include "InternTable.h"
+#include "LifetimeTable.h"
+#include "MemoryScope.h"
+#include "PagedDirectory.h"
+#include "SampledBlockFilter.h"
+#include "SiteStatsTable.h"
+#include "SizeHistogram.h"
+#include "SocketClient.h"
+#include "StackTable.h"
+#include "Symbolizer.h"
+#include "TscClock.h"
 #include <atomic>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+
+struct LeakScanCaller;
 
 class MemoryTracker
 {
@@ -18,6 +36,29 @@ public:
         size_t activeAllocations;
         size_t currentMemory;
         size_t peakMemory;
+        size_t trackerOverhead; // memoria propia del tracker (SlabArena), fuera de las cifras anteriores
+        size_t sampleInterval;  // 0 = conteo exacto; si no, las cifras son estimaciones
+        size_t sizeMismatches;  // delete sized con un tamaño distinto al del new
+        size_t alignMismatches; // new alineado con delete sin alinear, o al revés
+        size_t headerOverhead;  // bytes de cabecera en línea de los bloques vivos (MT_INLINE_HEADERS)
+        size_t slackBytes;      // usable - pedido de los bloques vivos: fragmentación interna (glibc)
+        size_t crossThreadFrees; // bloques liberados en un hilo distinto del que los asignó
+    };
+
+    // Lo que cobran el allocator y el SO frente a lo pedido. Solo Linux: en
+    // otras plataformas los campos del SO y de malloc quedan en 0.
+    struct Footprint
+    {
+        size_t requestedBytes; // Stats::currentMemory
+        size_t slackBytes;     // Stats::slackBytes
+        size_t heapCommitted;  // lo que malloc obtuvo del SO (arenas + bloques mmap, mallinfo2)
+        size_t heapInUse;      // entregado por malloc, con cabeceras y lo que no se registró
+        size_t rssBytes;       // /proc/self/statm
+        size_t anonBytes;      // /proc/self/smaps_rollup: Anonymous
+        size_t pssBytes;
+        size_t swapBytes;
+        size_t livePages;      // páginas con algún byte de un bloque vivo (0 si no se calculó)
+        double pageOccupancy;  // bytes vivos / (livePages * tamaño de página)
     };
 
     struct ReportEntry
@@ -28,6 +69,11 @@ public:
         int line;
         std::string typeName;
         long long timestamp_ms;
+        double weight; // asignaciones que representa (1 si no fue muestreada)
+        uint32_t stackId; // StackTable::kNoStack si no se capturó la pila
+        uint32_t threadId; // currentThreadId() del hilo que asignó
+        std::string tag;   // MT_SCOPE activo al asignar (vacío si ninguno)
+        std::string location; // frame más interno ya simbolizado (vacío si aún no)
     };
 
     struct Report
@@ -36,6 +82,39 @@ public:
         std::vector<ReportEntry> leaks;
     };
 
+    // Asignaciones vivas sin frenar a los hilos que asignan: los registros
+    // se copian shard por shard (AllocationTable::Snapshot) y cada entrada
+    // se traduce a texto recién al leerla, fuera de cualquier lock.
+    class LiveAllocations
+    {
+    public:
+        const Stats &stats() const noexcept { return snapshotStats; }
+        size_t size() const noexcept { return records.size(); }
+        bool complete() const noexcept { return records.complete(); }
+
+        const AllocationInfo &record(size_t i) const noexcept { return records[i]; }
+        ReportEntry entry(size_t i) const;
+
+        template <typename Fn>
+        void forEach(Fn &&fn) const
+        {
+            for (size_t i = 0; i < records.size(); ++i)
+                fn(entry(i));
+        }
+
+    private:
+        friend class MemoryTracker;
+        LiveAllocations(MemoryTracker &tracker, const Stats &stats, AllocationTable::Snapshot &&records)
+            : tracker(&tracker), snapshotStats(stats), records(std::move(records)) {}
+
+        MemoryTracker *tracker;
+        Stats snapshotStats;
+        AllocationTable::Snapshot records;
+    };
+
+    // Con muestreo activo los conteos y bytes son estimaciones repesadas.
+    // allocation*/totalMemory son acumulados desde el arranque; leak* son
+    // los bloques que siguen vivos ahora.
     struct FileSummary
     {
         std::string filename;
@@ -43,35 +122,348 @@ public:
         size_t totalMemory;
         size_t leakCount;
         size_t leakedMemory;
+        size_t freedCount;
+        size_t peakMemory; // máximo de bytes vivos del archivo
+    };
+
+    // Lo mismo por línea
+    struct SiteSummary
+    {
+        std::string file;
+        int line;
+        size_t allocationCount;
+        size_t totalMemory;
+        size_t liveCount;
+        size_t liveMemory;
+        size_t freedCount;
+        size_t peakMemory;
+        size_t slackBytes; // usable - pedido de los bloques vivos del sitio
+        size_t crossThreadFrees; // liberados en un hilo distinto del que asignó
     };
 
+    // Lo mismo por hilo que asignó: un bloque cuenta para su dueño aunque lo
+    // libere otro hilo
+    struct ThreadSummary
+    {
+        uint32_t threadId;     // currentThreadId()
+        uint64_t osThreadId;   // gettid() en Linux; 0 si no se conoce
+        std::string name;      // último nombre visto (pthread_setname_np)
+        size_t allocationCount;
+        size_t totalMemory;
+        size_t liveCount;
+        size_t liveMemory;
+        size_t freedCount;
+        size_t peakMemory;
+        size_t crossThreadFrees; // bloques suyos que liberó otro hilo
+        size_t remoteFrees;      // bloques de otros hilos que liberó este
+    };
+
+    // Lo mismo por tag de MT_SCOPE; tagId 0 agrupa lo asignado fuera de todo ámbito
+    struct TagSummary
+    {
+        uint32_t tagId;
+        std::string name;
+        size_t allocationCount;
+        size_t totalMemory;
+        size_t liveCount;
+        size_t liveMemory;
+        size_t freedCount;
+        size_t peakMemory;
+    };
+
+    // Bloques vivos agrupados por pila de llamadas completa
+    struct StackSummary
+    {
+        uint32_t stackId;
+        std::vector<const void *> frames; // direcciones de retorno, sin simbolizar
+        size_t allocationCount;
+        size_t totalMemory;
+    };
+
+    // Una clase del histograma de tamaños: bloques de minSize a maxSize bytes
+    struct SizeClassStats
+    {
+        size_t minSize;
+        size_t maxSize;
+        size_t totalAllocations; // acumuladas desde el arranque
+        size_t totalBytes;
+        size_t activeAllocations; // vivas ahora
+        size_t activeBytes;
+    };
+
+    // Los percentiles son el límite superior de la clase donde cae el cuantil
+    struct SizeDistribution
+    {
+        std::vector<SizeClassStats> classes; // solo clases con alguna asignación
+        size_t p50;
+        size_t p99;
+        size_t activeP50;
+        size_t activeP99;
+    };
+
+    // Vida de los bloques ya liberados de un sitio, en microsegundos. Los
+    // valores salen del histograma: interpolados dentro de cada bucket.
+    struct LifetimeSummary
+    {
+        std::string file;
+        int line;
+        size_t freedCount;
+        double medianUs;
+        double p99Us;
+        double shortLivedFraction; // liberados antes del umbral pedido
+    };
+
+    // Punto del tiempo para comparar con diff(): una generación del diario
+    // de cambios y su sello, no una copia del heap
+    struct HeapSnapshot
+    {
+        uint32_t id;    // generación; los IDs crecen con el tiempo
+        uint64_t stamp; // sello de TscClock al tomarlo
+        long long timestamp_ms;
+        Stats stats;
+    };
+
+    // Cambios entre dos snapshots de un sitio, tipo y clase de tamaño
+    struct HeapDiffEntry
+    {
+        std::string file;
+        int line;
+        std::string typeName;
+        size_t minSize;
+        size_t maxSize;
+        size_t appearedCount;    // asignadas después de `from` y vivas en `to`
+        size_t appearedBytes;
+        size_t disappearedCount; // vivas en `from` y liberadas antes de `to`
+        size_t disappearedBytes;
+    };
+
+    struct HeapDiff
+    {
+        uint32_t fromId;
+        uint32_t toId;
+        bool complete; // false si un snapshot ya se liberó o el diario perdió cambios
+        size_t appearedCount;
+        size_t appearedBytes;
+        size_t disappearedCount;
+        size_t disappearedBytes;
+        std::vector<HeapDiffEntry> entries; // mayor crecimiento neto primero
+    };
+
+    // Resultado de scanLeaks(). Conteos y bytes repesados como en Stats.
+    struct LeakScan
+    {
+        bool scanned;  // false: sin soporte en esta plataforma; todo lo vivo quedó en definitelyLost
+        bool complete; // se detuvieron todos los hilos y se copiaron todos los registros
+        unsigned stoppedThreads;
+        unsigned workerThreads;
+        double seconds;
+        size_t reachableCount;
+        size_t reachableBytes;
+        size_t definitelyLostCount;
+        size_t definitelyLostBytes;
+        size_t indirectlyLostCount;
+        size_t indirectlyLostBytes;
+        std::vector<ReportEntry> definitelyLost; // ningún puntero llega a ellos
+        std::vector<ReportEntry> indirectlyLost; // solo se llega desde otros bloques perdidos
+    };
+
+    // Aviso de un presupuesto de memoria superado
+    struct BudgetAlert
+    {
+        uint32_t budgetId;
+        std::string file; // vacío en el presupuesto global
+        int line;
+        size_t limitBytes;
+        size_t liveBytes; // al armar el aviso: puede haber seguido creciendo
+        long long timestamp_ms;
+        std::vector<SiteSummary> topSites; // los de más memoria viva
+    };
+    using BudgetCallback = std::function<void(const BudgetAlert &)>;
+
     // --- Singleton ---
     static MemoryTracker &getInstance();
     static bool isAlive() noexcept;
     static bool isInitializing() noexcept;
 
+    // --- Interruptor global ---
+    // Permite llevar el mismo binario a producción y perfilar solo algunos
+    // hosts. Apagado, los operadores y el interposer no registran nada ni
+    // construyen el tracker: cada asignación paga la lectura de este estado
+    // y un branch. El estado inicial sale de MT_ENABLED (0 = apagado; sin la
+    // variable, encendido) y se lee en la primera asignación.
+    //
+    // Apagarlo con el tracker ya vivo deja de registrar, pero los frees se
+    // siguen buscando en las tablas para no dejar registros huérfanos: para
+    // que no cueste nada, conviene decidirlo antes de arrancar.
+    static bool isEnabled() noexcept { return enabledState.load(std::memory_order_relaxed) != kSwitchOff; }
+    // Lee MT_ENABLED si todavía nadie decidió; true si está encendido
+    static bool resolveEnabled() noexcept;
+    static void setEnabled(bool enabled) noexcept;
+
     // --- API Principal ---
-    void registerAllocation(void *ptr, size_t size, const char *file, int line, const char *type);
+    // `usableSize`: malloc_usable_size() del bloque, que solo pasan los
+    // operadores y el interposer (ahí el puntero seguro salió de malloc). Con
+    // 0 el bloque queda sin holgura: la API no toca memoria que no conoce.
+    // kUsableDeferred: salió de malloc pero no se midió (modo buffered).
+    static constexpr size_t kUsableDeferred = SIZE_MAX;
+    void registerAllocation(void *ptr, size_t size, const char *file, int line, const char *type, bool aligned = false, size_t usableSize = 0);
+    // free() de C: sin nada que verificar
     void unregisterAllocation(void *ptr);
+    // operator delete: `size` es el que pasa el compilador en las variantes
+    // sized (0 si no lo pasó) y `aligned` indica la variante con align_val_t.
+    // Ambos se comparan con el registro y las diferencias se cuentan en Stats.
+    void unregisterAllocation(void *ptr, size_t size, bool aligned);
+
+    // ID compacto del hilo actual, el que llevan sus registros: se asigna en
+    // su primera operación y no se reutiliza. Desde el hilo número
+    // AllocationInfo::kMaxThreadId todos comparten ese último ID.
+    uint32_t currentThreadId();
+
+    // --- Tags por ámbito (MT_SCOPE, ver MemoryScope.h) ---
+    // ID compacto de un nombre de tag; el mismo texto da el mismo ID. Desde
+    // el tag número AllocationInfo::kMaxTagId todos comparten ese último ID.
+    // `name` con vida estática (literal); un texto temporal va como string_view
+    uint32_t internTag(const char *name);
+    uint32_t internTag(std::string_view name);
+    std::string tagName(uint32_t tagId);
+    // MemoryScope avisa cada cambio de tag del hilo para que el agregador lo
+    // repita en orden con sus eventos. Sin buffer propio no hace nada.
+    static void scopeChanged(uint32_t tagId) noexcept;
+
+    // --- Modo cabecera en línea (operadores compilados con MT_INLINE_HEADERS) ---
+    // El operador reserva la cabecera con baseOffset ya escrito y flags en 0;
+    // registerBlock() la completa y la enlaza en su shard. unregisterBlock()
+    // solo debe llamarse si la cabecera tiene BlockHeader::kLinked.
+    // `usableSize` es el del bloque de malloc entero (desde block->base()).
+    void registerBlock(BlockHeader *block, size_t size, const char *file, int line, const char *type, bool aligned, size_t usableSize = 0);
+    void unregisterBlock(BlockHeader *block, size_t size, bool aligned);
+
+    // --- Modo buffered: eventos por hilo + hilo agregador ---
+    // En este modo operator new/delete solo encolan un AllocationEvent en un
+    // ring buffer del propio hilo; el agregador los aplica a la tabla por lotes.
+    void enableBufferedMode(std::chrono::milliseconds drainPeriod = std::chrono::milliseconds(5));
+    void disableBufferedMode();
+    bool isBufferedMode() const noexcept;
+    // Aplica todos los eventos pendientes. Los reportes lo llaman solos.
+    void flushEvents();
+
+    // --- Muestreo estadístico (modo producción) ---
+    // Se registra en promedio una asignación cada `meanIntervalBytes` bytes,
+    // con distribución geométrica como el heap sampler de tcmalloc. El
+    // intervalo se redondea a potencia de dos para guardarlo en cada registro
+    // y repesar exactamente al liberar, aunque luego cambie.
+    void enableSampling(size_t meanIntervalBytes = 512 * 1024);
+    void disableSampling();
+    static bool isSampling() noexcept { return samplingShift.load(std::memory_order_relaxed) != 0; }
+    static size_t samplingInterval() noexcept;
+    // Los operadores lo llaman cuando su cuenta regresiva por hilo se agota;
+    // devuelve true si la asignación actual debe registrarse.
+    static bool sampleCountdownExpired(int64_t &countdown) noexcept;
+
+    // --- Captura de pilas ---
+    // Guarda hasta `depth` direcciones de retorno por asignación registrada
+    // (con muestreo, solo de las muestras). Las pilas repetidas se comparten
+    // en StackTable y cada registro lleva solo su ID.
+    void enableStackCapture(unsigned depth = 16);
+    void disableStackCapture();
+    unsigned stackCaptureDepth() const noexcept;
+
+    // --- Simbolización ---
+    // Un hilo en segundo plano resuelve las pilas nuevas de StackTable a
+    // función y archivo:línea. Los reportes solo consultan la caché: lo que
+    // todavía no se resolvió sale como módulo+offset o dirección.
+    void enableSymbolization(std::chrono::milliseconds period = std::chrono::milliseconds(200));
+    void disableSymbolization();
+    std::string describeFrame(const void *pc);
+    // Mapa de módulos del proceso para simbolizar offline con Symbolizer::loadModuleMap()
+    std::string getModuleMap();
+
+    // --- Snapshots del heap ---
+    // Mientras quede algún snapshot sin liberar, cada alloc/free se anota en
+    // un ChangeJournal: diff() cuesta O(cambios entre ambos), no O(heap).
+    // Liberar los snapshots viejos devuelve la memoria del diario.
+    HeapSnapshot takeSnapshot();
+    void releaseSnapshot(uint32_t id);
+    HeapDiff diff(const HeapSnapshot &from, const HeapSnapshot &to);
+
+    // --- Fugas por alcanzabilidad ---
+    // Detiene la aplicación mientras busca punteros a cada bloque vivo en
+    // pilas, registros, .data/.bss y otros bloques alcanzados (LeakScanner).
+    // Lo que solo se alcanza a través de memoria no registrada (muestreo, o
+    // malloc sin LD_PRELOAD) puede aparecer como perdido.
+    LeakScan scanLeaks(unsigned workerThreads = 0); // 0 = según los núcleos
+    // reportLeaks() escanea y lista solo lo perdido en lugar de todo lo vivo
+    void setLeakScanOnReport(bool enabled);
+
+    // --- Presupuestos de memoria ---
+    // Umbrales de bytes vivos pedidos (no RSS): globales, contra
+    // Stats::currentMemory, o de un sitio file:line. Al registrar solo se
+    // compara contra el umbral; al cruzarlo un hilo aparte arma el aviso
+    // (sitios con más memoria viva), lo envía como BUDGET_ALERT, marca
+    // budgetAlertFd() y llama al callback. Los callbacks corren en ese hilo
+    // y lo que asignen no se registra. Cada presupuesto avisa una vez y se
+    // rearma cuando el uso baja del 90% del límite.
+    uint32_t setMemoryBudget(size_t limitBytes, BudgetCallback callback = nullptr);
+    // Un presupuesto por sitio: uno nuevo reemplaza al anterior
+    uint32_t setSiteBudget(const char *file, int line, size_t limitBytes, BudgetCallback callback = nullptr);
+    void removeBudget(uint32_t id);
+    // eventfd que se vuelve legible con cada aviso (leerlo lo vacía); -1 fuera de Linux
+    int budgetAlertFd();
 
     // --- Reportes y Estadísticas ---
     Stats getCurrentStats();
+    // Lee /proc y mallinfo2: para consultas periódicas, no por operación.
+    // La ocupación de páginas recorre una foto de la tabla (O(n log n)).
+    Footprint getFootprint(bool withPageOccupancy = false);
     Report collectReport();
+    LiveAllocations liveAllocations();
     void reportLeaks();
+    // Mismo texto a otro destino (el interposer no escribe en el stdout del programa)
+    void reportLeaks(std::ostream &out);
+    // Mantenidos al asignar y liberar: cuestan O(sitios), no O(bloques vivos).
+    // Ordenados por memoria viva (descendente).
     std::vector<FileSummary> getFileSummaries();
+    std::vector<FileSummary> getTopFiles(size_t count);
+    std::vector<SiteSummary> getSiteSummaries();
+    std::vector<SiteSummary> getTopSites(size_t count);
+    std::vector<ThreadSummary> getThreadSummaries();
+    std::vector<TagSummary> getTagSummaries();
+    std::vector<StackSummary> getStackSummaries();
+    SizeDistribution getSizeDistribution();
+    // Ordenado por cantidad de bloques de vida corta: los primeros son los
+    // mejores candidatos para un pool o para vivir en la pila
+    std::vector<LifetimeSummary> getLifetimeSummaries(std::chrono::microseconds shortLived = std::chrono::microseconds(10));
 
-    // --- API para Integración con Socket Client ---
-    void enableRemoteReporting(const QString &host = "localhost", quint16 port = 8080);
+    // --- Reporte remoto a la GUI ---
+    // Un hilo propio del tracker envía los mensajes periódicos por un
+    // SocketClient y atiende los pedidos de la GUI: no hace falta un event
+    // loop de Qt en el proceso perfilado.
+    struct ReportPeriods
+    {
+        std::chrono::milliseconds metrics{1000};  // GENERAL_METRICS
+        std::chrono::milliseconds timeline{1000}; // TIMELINE_POINT
+        std::chrono::milliseconds details{1000};  // SIZE_HISTOGRAM, THREAD_ALLOCATIONS, TAG_ALLOCATIONS
+    };
+    void enableRemoteReporting(const char *host = "localhost", uint16_t port = 8080);
     void disableRemoteReporting();
     bool isRemoteConnected() const;
+    void setReportPeriods(const ReportPeriods &periods);
 
     // --- Envío de Datos Específicos para la GUI ---
     void sendLiveUpdate(void *ptr, size_t size, bool isAlloc, const char *file, int line, const char *type);
     void sendGeneralMetrics();
     void sendMemoryMap();
     void sendFileAllocations();
+    void sendStackAllocations();
+    void sendModuleMap();
     void sendLeakReport();
     void sendTimelinePoint();
+    void sendSizeHistogram();
+    void sendLifetimeSummary(std::chrono::microseconds shortLived = std::chrono::microseconds(10));
+    void sendThreadAllocations();
+    void sendTagAllocations();
+    // toId 0 = contra el heap de ahora
+    void sendSnapshotDiff(uint32_t fromId, uint32_t toId);
 
     // --- Cctor/Dtor ---
     ~MemoryTracker();
@@ -79,26 +471,199 @@ public:
     MemoryTracker &operator=(const MemoryTracker &) = delete;
 
 private:
+    // Los tests (tests/) llegan a internos como el reloj a través de esta clase
+    friend struct MemoryTrackerTestAccess;
+
     MemoryTracker();
-    void setupPeriodicUpdates();
+    void stopReporter();
+    void reporterLoop();
+    // Envía desde cualquier hilo; lo que el socket no tome lo escribe el reporter
+    void sendPacket(const char *keyword, const char *data, size_t size);
+    // Pedidos de la GUI: SNAPSHOT_TAKE, SNAPSHOT_DIFF "a|b", SNAPSHOT_RELEASE "id"
+    void handleRemoteCommand(const std::string &keyword, const std::string &args);
+    bool findSnapshot(uint32_t id, HeapSnapshot &out);
+
+    void updatePeak(size_t current) noexcept;
+    Stats loadStats() const noexcept;
+
+    // Peso de un registro: cuántas asignaciones/bytes representa. Los conteos
+    // van en punto fijo (kWeightOne = 1 asignación) para no perder la parte
+    // fraccionaria del inverso de la probabilidad de muestreo.
+    struct Weight
+    {
+        uint64_t countFx;
+        uint64_t bytes;
+    };
+    static constexpr uint64_t kWeightOne = uint64_t(1) << 16;
+    static Weight weightOf(uint64_t size, uint16_t flags) noexcept;
+    // Conteo en punto fijo redondeado a asignaciones enteras
+    static size_t countOf(uint64_t countFx) noexcept { return static_cast<size_t>((countFx + kWeightOne / 2) / kWeightOne); }
+
+    // --- Aplicación de eventos (inline o desde el agregador) ---
+    // `outOfOrder`: evento sacado de un buffer. Un Alloc puede llegar después
+    // del de una reutilización de la misma dirección, y un Free después del
+    // Alloc de la reutilización.
+    bool applyAllocation(void *ptr, size_t size, const char *file, int line, const char *type, uint64_t stamp, uint16_t flags, uint32_t stackId, uint32_t slack, uint32_t threadId, uint32_t tagId, bool outOfOrder = false);
+    bool applyFree(void *ptr, uint64_t stamp, uint32_t threadId, size_t expectedSize = 0, uint16_t checkFlags = 0, bool outOfOrder = false);
+    void reportDeallocMismatch(const AllocationInfo &info, size_t expectedSize, bool alignedDelete);
+    void accountAllocLocked(const AllocationInfo &info) noexcept;
+    bool accountFreeLocked(const AllocationInfo &info, uint64_t freedAt, uint32_t freeThread, size_t expectedSize, uint16_t checkFlags) noexcept;
+    // false si seguro no hay registro para ptr en la tabla (ver sampledBlocks)
+    bool mayBeTracked(const void *ptr) const noexcept;
+    long long toWallClockMs(uint64_t stamp) const noexcept;
+    // Cuerpo de scanLeaks(), en un marco debajo del que guardó `caller`
+    LeakScan scanLeaksBelow(const LeakScanCaller &caller, unsigned workerThreads);
+    ReportEntry describeAllocation(const AllocationInfo &info);
+    FileSummary fileSummaryOf(uint32_t fileId, const SiteStatsTable::Counts &c) const;
+    static int64_t steadyNowNs() noexcept;
+
+    uint32_t registerThread();
+    uint32_t tagOf(uint32_t stringId);
+
+    bool pushEvent(const AllocationEvent &ev, void *const *frames = nullptr);
+    ThreadEventBuffer *threadBuffer();
+    void resolveEvent(ThreadEventBuffer &buffer, AllocationEvent &ev, void *const *frames);
+    size_t drainEvents();
+    void aggregatorLoop();
+    void symbolizerLoop();
+
+    // --- Presupuestos ---
+    struct Budget
+    {
+        uint32_t id;
+        uint32_t siteId; // kGlobalBudget: contra currentMemory
+        size_t limitBytes;
+        BudgetCallback callback;
+        bool tripped; // avisó; espera que el uso baje para rearmarse
+        bool pending; // aviso por enviar
+    };
+    static constexpr uint32_t kGlobalBudget = UINT32_MAX;
+    static constexpr size_t kBudgetTopSites = 5;
+    uint32_t addBudget(uint32_t siteId, size_t limitBytes, BudgetCallback callback);
+    // Desde accountAllocLocked(), dentro del lock del shard
+    void budgetCrossed(uint32_t siteId) noexcept;
+    void armBudgetsLocked() noexcept;
+    size_t budgetUsage(const Budget &budget) const noexcept;
+    void stopBudgets();
+    void budgetLoop();
+    void sendBudgetAlert(const BudgetAlert &alert);
 
     // --- Estado de Memoria ---
-    std::unordered_map<void *, AllocationInfo> allocations;
-    std::mutex mtx;
+    AllocationTable allocations;
+    InternTable interned;
+    StackTable stacks;
+    SizeHistogram sizes;
+    LifetimeTable lifetimes;
+    SiteStatsTable siteStats; // por siteId
+    SiteStatsTable fileStats; // por fileId de InternTable
+    SiteStatsTable threadStats; // por currentThreadId() del que asignó
+    PagedDirectory<std::atomic<uint64_t>> remoteFreesFx; // por currentThreadId() del que libera
+    SiteStatsTable tagStats; // por tagId de MT_SCOPE
+    ChangeJournal journal;
+
+    std::mutex snapshotsMtx; // serializa diff() con el recorte del diario
+    std::vector<HeapSnapshot, SlabAllocator<HeapSnapshot>> snapshots; // sin liberar, por ID
+    std::atomic<unsigned> stackDepth{0}; // 0 = sin captura
+    std::atomic<bool> leakScanOnReport{false};
 
-    size_t totalAllocations = 0;
-    size_t activeAllocations = 0;
-    size_t peakMemory = 0;
-    size_t currentMemory = 0;
+    // Los contadores se modifican dentro de la sección crítica del shard, así
+    // que con allocations.lockAll() son coherentes con el contenido de la tabla.
+    alignas(AllocationTable::kCacheLineSize) std::atomic<uint64_t> totalAllocationsFx{0};
+    std::atomic<uint64_t> activeAllocationsFx{0};
+    std::atomic<size_t> peakMemory{0};
+    std::atomic<size_t> currentMemory{0};
     size_t totalLeakedMemory = 0;
+    std::atomic<uint64_t> sizeMismatches{0};
+    std::atomic<uint64_t> alignMismatches{0};
+    std::atomic<uint64_t> headerBytesFx{0}; // mismo punto fijo que los conteos
+    std::atomic<uint64_t> slackBytesFx{0};
+    std::atomic<uint64_t> crossThreadFreesFx{0};
 
-    // --- Integración con Client ---
-    Client *socketClient = nullptr;
-    bool remoteEnabled = false;
+    // Con muestreo casi todos los free son de bloques no registrados. Si no
+    // queda ningún registro sin kSampled, el filtro decide solo si hace falta
+    // buscar en la tabla.
+    std::atomic<uint64_t> unsampledLive{0};
+    SampledBlockFilter sampledBlocks;
+
+    // Hilos que pasaron por el tracker, por currentThreadId()
+    struct ThreadRecord
+    {
+        uint64_t osThreadId;
+        char name[16]; // el límite de los nombres de hilo en Linux
+    };
+    std::atomic<uint32_t> nextThreadId{1};
+    std::mutex threadsMtx;
+    std::vector<ThreadRecord, SlabAllocator<ThreadRecord>> threadRecords;
+
+    // Tags de MT_SCOPE: el camino rápido de internTag() no toma tagsMtx
+    PagedDirectory<std::atomic<uint32_t>> tagOfString; // por ID de InternTable; 0 = sin tag todavía
+    std::mutex tagsMtx;
+    std::vector<uint32_t, SlabAllocator<uint32_t>> tagNames; // ID de InternTable por tagId
+
+    // Los registros guardan sellos de `clock`; clockBaseWall (el sello 0)
+    // permite convertirlos a milisegundos de reloj de pared en los reportes.
+    TscClock clock;
+    std::chrono::high_resolution_clock::time_point clockBaseWall;
+
+    // --- Modo buffered ---
+    std::atomic<bool> bufferedMode{false};
+    std::mutex buffersMtx;                 // protege la lista de buffers
+    ThreadEventBuffer *buffers = nullptr;  // un buffer por hilo que asignó
+    std::mutex drainMtx;                   // un solo consumidor a la vez
+    std::vector<AllocationEvent, SlabAllocator<AllocationEvent>> drainBatch;
+    std::vector<AllocationEvent, SlabAllocator<AllocationEvent>> deferredFrees;
+
+    std::thread aggregator;
+    std::mutex aggregatorMtx;
+    std::condition_variable aggregatorCv;
+    bool aggregatorStop = false;
+    std::chrono::milliseconds aggregatorPeriod{5};
+
+    // --- Simbolización ---
+    Symbolizer symbolizer;
+    std::thread symbolizerThread;
+    std::mutex symbolizerMtx;
+    std::condition_variable symbolizerCv;
+    bool symbolizerStop = false;
+    std::chrono::milliseconds symbolizerPeriod{200};
+
+    // --- Presupuestos ---
+    // Orden de locks: shard -> budgetMtx. El hilo de avisos nunca toma un
+    // shard con budgetMtx tomado.
+    std::atomic<size_t> budgetTrip{SIZE_MAX}; // menor límite global armado
+    std::mutex budgetMtx;
+    std::condition_variable budgetCv;
+    std::vector<Budget, SlabAllocator<Budget>> budgets;
+    std::thread budgetThread;
+    bool budgetStop = false;
+    bool budgetWake = false;
+    uint32_t nextBudgetId = 1;
+    int budgetFd = -1;
+
+    // --- Reporte remoto ---
+    SocketClient socketClient;
+    std::atomic<bool> remoteEnabled{false};
+    std::thread reporterThread;
+    std::mutex reporterMtx; // reportPeriods
+    ReportPeriods reportPeriods;
+    std::atomic<bool> reporterStop{false};
 
     // --- Para estadísticas periódicas ---
-    QTimer *updateTimer = nullptr;
+    // Ocupación de páginas que envía sendGeneralMetrics(): recorre el heap
+    // entero, así que se recalcula cada tanto
+    std::chrono::steady_clock::time_point occupancyRefreshed{};
+    size_t cachedLivePages = 0;
+    double cachedOccupancy = 0.0;
+
+    enum : uint8_t
+    {
+        kSwitchUnresolved = 0, // nadie miró MT_ENABLED todavía: cuenta como encendido
+        kSwitchOn = 1,
+        kSwitchOff = 2
+    };
 
+    static std::atomic<unsigned> samplingShift; // log2 del intervalo; 0 = sin muestreo
+    static std::atomic<uint8_t> enabledState;
     static std::atomic<bool> alive;
     static std::atomic<bool> initializing;
 };
\ No newline at end of file
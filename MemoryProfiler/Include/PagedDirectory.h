@@ -0,0 +1,108 @@
+#pragma once
+#include "SlabAllocator.h"
+#include <atomic>
+#include <new>
+#include <cstdint>
+
+//==================================================
+// Directorio de dos niveles indexado por ID
+//==================================================
+// Para las tablas por sitio o por archivo: cada entrada se crea la primera
+// vez que se pide su ID y nunca se mueve, así leer no toma locks. Dos hilos
+// pueden competir por crear la misma página o entrada: gana el primer
+// compare_exchange y el otro devuelve lo suyo al arena. T debe poder
+// valor-inicializarse en cero (contadores atómicos). 1M IDs, como InternTable.
+template <typename T>
+class PagedDirectory
+{
+public:
+    static constexpr uint32_t kPageBits = 8;
+    static constexpr uint32_t kPageSize = 1u << kPageBits;
+    static constexpr uint32_t kMaxPages = 4096;
+
+    PagedDirectory() = default;
+    PagedDirectory(const PagedDirectory &) = delete;
+    PagedDirectory &operator=(const PagedDirectory &) = delete;
+
+    ~PagedDirectory()
+    {
+        for (auto &slot : pages)
+        {
+            Page *page = slot.load(std::memory_order_relaxed);
+            if (!page)
+                continue;
+            for (auto &entry : page->entries)
+            {
+                if (T *value = entry.load(std::memory_order_relaxed))
+                    SlabArena::shared().deallocate(value, sizeof(T));
+            }
+            SlabArena::shared().deallocate(page, sizeof(Page));
+        }
+    }
+
+    // Crea la entrada si no existe; nullptr si el ID no entra o falta memoria
+    T *get(uint32_t id) noexcept
+    {
+        const uint32_t p = id >> kPageBits;
+        if (p >= kMaxPages)
+            return nullptr;
+
+        Page *page = pages[p].load(std::memory_order_acquire);
+        if (!page)
+        {
+            Page *fresh = create<Page>();
+            if (!fresh)
+                return nullptr;
+            if (pages[p].compare_exchange_strong(page, fresh, std::memory_order_acq_rel))
+                page = fresh;
+            else
+                SlabArena::shared().deallocate(fresh, sizeof(Page));
+        }
+
+        std::atomic<T *> &slot = page->entries[id & (kPageSize - 1)];
+        T *value = slot.load(std::memory_order_acquire);
+        if (!value)
+        {
+            T *fresh = create<T>();
+            if (!fresh)
+                return nullptr;
+            if (slot.compare_exchange_strong(value, fresh, std::memory_order_acq_rel))
+                value = fresh;
+            else
+                SlabArena::shared().deallocate(fresh, sizeof(T));
+        }
+        return value;
+    }
+
+    // Sin crear nada; nullptr si el ID nunca se pidió con get()
+    const T *find(uint32_t id) const noexcept
+    {
+        const uint32_t p = id >> kPageBits;
+        if (p >= kMaxPages)
+            return nullptr;
+        const Page *page = pages[p].load(std::memory_order_acquire);
+        if (!page)
+            return nullptr;
+        return page->entries[id & (kPageSize - 1)].load(std::memory_order_acquire);
+    }
+
+    T *find(uint32_t id) noexcept
+    {
+        return const_cast<T *>(static_cast<const PagedDirectory *>(this)->find(id));
+    }
+
+private:
+    struct Page
+    {
+        std::atomic<T *> entries[kPageSize];
+    };
+
+    template <typename U>
+    static U *create() noexcept
+    {
+        void *mem = SlabArena::shared().allocate(sizeof(U));
+        return mem ? new (mem) U() : nullptr; // valor-inicializado: todo en cero
+    }
+
+    std::atomic<Page *> pages[kMaxPages] = {};
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Filtro de bloques muestreados vivos
+//==================================================
+// Filtro de Bloom de conteo con una sola función hash: cada registro
+// muestreado suma 1 en la ranura de su dirección al entrar en la tabla y
+// resta 1 al salir. Una ranura en 0 garantiza que la dirección no está en
+// la tabla como muestra, así que un free de un bloque no muestreado se
+// descarta sin reloj, sin lock de shard y sin búsqueda en el mapa.
+//
+// Colisiones solo dan falsos positivos (se busca en la tabla y no está).
+// Los contadores viven en el singleton, en memoria estática: las páginas
+// que nunca se tocan no llegan a ocupar RAM.
+class SampledBlockFilter
+{
+public:
+    static constexpr size_t kSlots = size_t(1) << 16;
+
+    SampledBlockFilter() = default;
+    SampledBlockFilter(const SampledBlockFilter &) = delete;
+    SampledBlockFilter &operator=(const SampledBlockFilter &) = delete;
+
+    // Dentro del lock del shard del bloque, junto a los contadores
+    void add(const void *ptr) noexcept { counts[slotOf(ptr)].fetch_add(1, std::memory_order_relaxed); }
+    void remove(const void *ptr) noexcept { counts[slotOf(ptr)].fetch_sub(1, std::memory_order_relaxed); }
+
+    // false: seguro que no hay un registro muestreado con esa dirección
+    bool mayContain(const void *ptr) const noexcept { return counts[slotOf(ptr)].load(std::memory_order_relaxed) != 0; }
+
+private:
+    static size_t slotOf(const void *ptr) noexcept
+    {
+        // Los 4 bits bajos son casi siempre 0 por la alineación de malloc
+        const uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr) >> 4);
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 48);
+    }
+
+    std::atomic<uint32_t> counts[kSlots] = {};
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "PagedDirectory.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Agregados incrementales por ID (sitio o archivo)
+//==================================================
+// Se actualizan en cada alloc/free, así los resúmenes por archivo o por
+// línea cuestan O(IDs) y no O(asignaciones vivas). Los conteos van en el
+// punto fijo del tracker. El pico de bytes vivos se calcula con contadores
+// que otros hilos pueden estar moviendo: es exacto con un solo hilo por ID
+// y una buena cota en los demás casos.
+class SiteStatsTable
+{
+public:
+    struct Counts
+    {
+        uint64_t allocCountFx; // acumuladas desde el arranque
+        uint64_t allocBytes;
+        uint64_t freeCountFx;
+        uint64_t freeBytes;
+        uint64_t peakLiveBytes;
+        uint64_t liveSlackFx; // fragmentación interna de los vivos, en punto fijo
+        uint64_t crossFreeCountFx; // liberados en un hilo distinto del que los asignó
+    };
+
+    SiteStatsTable() = default;
+    SiteStatsTable(const SiteStatsTable &) = delete;
+    SiteStatsTable &operator=(const SiteStatsTable &) = delete;
+
+    // true si con esta asignación los bytes vivos alcanzaron el límite del
+    // ID; solo un hilo lo ve, porque el límite queda desarmado (en 0)
+    bool recordAlloc(uint32_t id, uint64_t countFx, uint64_t bytes, uint64_t slackFx = 0) noexcept;
+    void recordFree(uint32_t id, uint64_t countFx, uint64_t bytes, uint64_t slackFx = 0) noexcept;
+    // Además de recordFree(), cuando el free ocurrió en otro hilo
+    void recordCrossFree(uint32_t id, uint64_t countFx) noexcept;
+
+    // Copia los contadores; false si el ID nunca asignó nada. Los vivos
+    // (alloc - free) quedan recortados a cero.
+    bool snapshot(uint32_t id, Counts &out) const noexcept;
+
+    // Límite de bytes vivos para recordAlloc(); 0 lo desarma
+    void setLimit(uint32_t id, uint64_t limitBytes) noexcept;
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> allocCountFx;
+        std::atomic<uint64_t> allocBytes;
+        std::atomic<uint64_t> freeCountFx;
+        std::atomic<uint64_t> freeBytes;
+        std::atomic<uint64_t> peakLiveBytes;
+        std::atomic<uint64_t> liveSlackFx;
+        std::atomic<uint64_t> crossFreeCountFx;
+        std::atomic<uint64_t> limitBytes; // 0 = sin límite
+    };
+
+    PagedDirectory<Entry> entries;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include "AllocationTable.h"
+#include "LogLinearBuckets.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Histograma de tamaños por clase
+//==================================================
+// Clases log2 con 4 subdivisiones lineales por potencia de dos: tamaños
+// 0..7 exactos, después 8-9, 10-11, 12-13, 14-15, 16-19... El error
+// relativo de cada clase queda por debajo del 25%.
+//
+// Hay una franja de contadores por shard de AllocationTable y se escribe
+// solo dentro de la sección crítica de ese shard, así que cada franja tiene
+// un único escritor a la vez: basta load + store relajados, sin RMW ni
+// líneas de caché compartidas entre hilos. Los lectores suman las franjas
+// sin tomar locks.
+class SizeHistogram
+{
+public:
+    // AllocationInfo::size tiene 48 bits
+    using Scale = LogLinearBuckets<2, 47>;
+    static constexpr unsigned kBucketCount = Scale::kCount;
+
+    // Conteos en el mismo punto fijo que los contadores del tracker
+    struct Counts
+    {
+        uint64_t allocCountFx;
+        uint64_t allocBytes;
+        uint64_t freeCountFx;
+        uint64_t freeBytes;
+    };
+
+    static unsigned bucketOf(uint64_t size) noexcept { return Scale::bucketOf(size); }
+    static uint64_t bucketLower(unsigned bucket) noexcept { return Scale::lower(bucket); }
+    static uint64_t bucketUpper(unsigned bucket) noexcept { return Scale::upper(bucket); }
+
+    // Requieren el lock del shard `stripe`
+    void recordAlloc(size_t stripe, uint64_t size, uint64_t countFx, uint64_t bytes) noexcept
+    {
+        Bucket &b = stripes[stripe].buckets[bucketOf(size)];
+        add(b.allocCountFx, countFx);
+        add(b.allocBytes, bytes);
+    }
+
+    void recordFree(size_t stripe, uint64_t size, uint64_t countFx, uint64_t bytes) noexcept
+    {
+        Bucket &b = stripes[stripe].buckets[bucketOf(size)];
+        add(b.freeCountFx, countFx);
+        add(b.freeBytes, bytes);
+    }
+
+    // Suma de todas las franjas, sin locks
+    void snapshot(Counts (&out)[kBucketCount]) const noexcept;
+
+private:
+    static constexpr size_t kStripes = AllocationTable::kShardCount;
+
+    struct Bucket
+    {
+        std::atomic<uint64_t> allocCountFx{0};
+        std::atomic<uint64_t> allocBytes{0};
+        std::atomic<uint64_t> freeCountFx{0};
+        std::atomic<uint64_t> freeBytes{0};
+    };
+
+    struct alignas(64) Stripe
+    {
+        Bucket buckets[kBucketCount];
+    };
+
+    static void add(std::atomic<uint64_t> &counter, uint64_t value) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    Stripe stripes[kStripes];
+};
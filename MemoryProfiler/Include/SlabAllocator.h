@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Arena de slabs para la contabilidad del tracker
+//==================================================
+// Toda la memoria sale directamente del sistema operativo (mmap/VirtualAlloc),
+// así los nodos de las tablas, los strings internados y los buffers de
+// eventos nunca pasan por los operadores instrumentados, no compiten con el
+// malloc de la aplicación y se pueden reportar aparte como overhead.
+//
+// Bloques pequeños: clases de tamaño fijo con free list por clase, servidas
+// desde chunks de kChunkSize. Bloques grandes: páginas propias. Como los
+// allocators de la STL devuelven el tamaño en deallocate(), no hace falta
+// cabecera por bloque.
+class SlabArena
+{
+public:
+    static constexpr size_t kChunkSize = 256 * 1024;
+    static constexpr size_t kMaxSmallSize = 4096;
+    static constexpr size_t kAlignment = 16;
+
+    // `synchronized` = false cuando el dueño ya serializa el acceso
+    // (p. ej. el arena de cada shard, usado siempre bajo el lock del shard).
+    explicit SlabArena(bool synchronized = true) noexcept : synchronized(synchronized) {}
+    ~SlabArena();
+    SlabArena(const SlabArena &) = delete;
+    SlabArena &operator=(const SlabArena &) = delete;
+
+    void *allocate(size_t bytes) noexcept;
+    void deallocate(void *ptr, size_t bytes) noexcept;
+
+    // Arena compartido (con lock) para la contabilidad que no pertenece a un shard.
+    static SlabArena &shared() noexcept;
+
+    // Páginas directas del SO, redondeadas a página.
+    static void *mapPages(size_t bytes) noexcept;
+    static void unmapPages(void *ptr, size_t bytes) noexcept;
+
+    // Memoria pedida al SO por todos los arenas (overhead del tracker). Solo
+    // cambia al mapear o liberar páginas, no en cada bloque.
+    static size_t totalMappedBytes() noexcept { return mappedBytes.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kClassCount = 13;
+    static const size_t kClassSizes[kClassCount];
+
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    struct Chunk
+    {
+        Chunk *next;
+    };
+
+    static size_t classIndex(size_t bytes) noexcept;
+    static size_t pageRound(size_t bytes) noexcept;
+    void *allocateSmall(size_t cls) noexcept;
+
+    const bool synchronized;
+    std::mutex mtx;
+    FreeBlock *freeLists[kClassCount] = {};
+    Chunk *chunks = nullptr;       // para devolverlos al SO en el destructor
+    char *bumpCursor = nullptr;     // zona libre del chunk actual
+    char *bumpEnd = nullptr;
+
+    static std::atomic<size_t> mappedBytes;
+};
+
+//==================================================
+// Allocator compatible con la STL
+//==================================================
+template <typename T>
+class SlabAllocator
+{
+public:
+    using value_type = T;
+
+    SlabAllocator() noexcept : arena(&SlabArena::shared()) {}
+    explicit SlabAllocator(SlabArena *arena) noexcept : arena(arena) {}
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U> &other) noexcept : arena(other.arena) {}
+
+    T *allocate(size_t n)
+    {
+        void *p = arena->allocate(n * sizeof(T));
+        if (!p)
+            throw std::bad_alloc();
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t n) noexcept { arena->deallocate(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U> &other) const noexcept { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const SlabAllocator<U> &other) const noexcept { return arena != other.arena; }
+
+    SlabArena *arena;
+};
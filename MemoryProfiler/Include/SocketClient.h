@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+//==================================================
+// Transporte a la GUI sin Qt
+//==================================================
+// Conexión TCP con sockets del sistema (POSIX; Winsock en Windows) que
+// habla el protocolo de la GUI: cada paquete es
+//   [keyword_len:u16][data_len:u32][keyword][data]
+// con los largos en big-endian, en ambos sentidos.
+//
+// send() se puede llamar desde cualquier hilo y nunca bloquea: arma el
+// paquete, escribe lo que el socket acepte y deja el resto en una cola que
+// vacía pump(). pump() lo llama un único hilo (el reporter del tracker):
+// escribe lo pendiente y espera pedidos del servidor hasta que llegue uno,
+// venza la espera o alguien llame a wake().
+//
+// Si la GUI no lee, la cola crece hasta kMaxQueuedBytes y los paquetes
+// siguientes se descartan (droppedPackets()). Cualquier error de socket
+// cierra la conexión; no se reconecta solo.
+class SocketClient
+{
+public:
+    using CommandHandler = std::function<void(const std::string &keyword, const std::string &data)>;
+
+    static constexpr size_t kMaxQueuedBytes = 16 * 1024 * 1024;
+
+    SocketClient() = default;
+    ~SocketClient();
+    SocketClient(const SocketClient &) = delete;
+    SocketClient &operator=(const SocketClient &) = delete;
+
+    bool connectToServer(const char *host, uint16_t port, std::chrono::milliseconds timeout = std::chrono::milliseconds(3000));
+    // Descarta lo que quedó en cola
+    void disconnectFromServer();
+    bool isConnected() const noexcept { return connected.load(std::memory_order_acquire); }
+
+    bool send(const char *keyword, const char *data, size_t size);
+    void pump(std::chrono::milliseconds wait, const CommandHandler &onCommand);
+    void wake() noexcept;
+    // Insiste hasta vaciar la cola o agotar `timeout`; true si quedó vacía
+    bool flush(std::chrono::milliseconds timeout);
+
+    size_t droppedPackets() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Requiere sendMtx. false si el socket falló.
+    bool flushLocked();
+    void closeLocked() noexcept;
+    void parseCommands(const CommandHandler &onCommand);
+
+    std::mutex sendMtx; // socket (escritura y cierre) y outbox
+    std::intptr_t sock = -1;
+    std::string outbox;   // bytes aceptados por send() que el socket todavía no tomó
+    std::string inbox;    // lo leído del servidor, con un paquete cortado al final
+    int wakeFds[2] = {-1, -1}; // pipe de wake() (solo POSIX)
+    std::atomic<bool> connected{false};
+    std::atomic<size_t> dropped{0};
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include "AllocationInfo.h"
+#include "ChunkedArray.h"
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+//==================================================
+// Tabla de pilas de llamadas (hash-consing)
+//==================================================
+// Cada pila distinta se guarda una sola vez y se identifica con un ID de
+// AllocationInfo::kStackIdBits bits, que es lo único que lleva el registro.
+// La búsqueda es sin locks (hash abierto de solo inserción); el mutex solo
+// se toma la primera vez que aparece una pila. Los IDs nunca se reutilizan y resolverlos no toma locks.
+class StackTable
+{
+public:
+    static constexpr uint32_t kNoStack = 0;  // sin captura, pila vacía o tabla llena
+    static constexpr uint32_t kMaxDepth = 64;
+
+    struct Frames
+    {
+        const void *const *pcs; // direcciones de retorno, de la más interna hacia afuera
+        uint32_t depth;
+    };
+
+    StackTable();
+    ~StackTable();
+    StackTable(const StackTable &) = delete;
+    StackTable &operator=(const StackTable &) = delete;
+
+    uint32_t intern(void *const *pcs, uint32_t depth);
+    Frames frames(uint32_t id) const noexcept;
+    uint32_t size() const noexcept { return records.size(); }
+
+    // Recorre la cadena de frame pointers del hilo actual (en Windows,
+    // RtlCaptureStackBackTrace). `skip` descarta frames a partir del que
+    // llama a capture(); requiere compilar con -fno-omit-frame-pointer.
+    static uint32_t capture(void **out, uint32_t maxDepth, uint32_t skip) noexcept;
+
+private:
+    struct Record
+    {
+        uint64_t hash;
+        uint32_t depth;
+        uint32_t reserved;
+        // siguen `depth` punteros
+        const void *const *pcs() const noexcept { return reinterpret_cast<const void *const *>(this + 1); }
+    };
+
+    // Se mapea con la primera pila; el SO solo respalda las páginas que se tocan.
+    static constexpr uint32_t kSlotBits = 18;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr uint32_t kMaxRecords = kSlots - kSlots / 4;
+    static_assert(kMaxRecords < (1u << AllocationInfo::kStackIdBits), "los IDs de pila no entran en AllocationInfo::stackId");
+
+    static uint64_t hashFrames(void *const *pcs, uint32_t depth) noexcept;
+    bool find(uint64_t hash, void *const *pcs, uint32_t depth, uint32_t &id, uint32_t &slot) const noexcept;
+
+    std::mutex mtx;
+    std::atomic<std::atomic<uint32_t> *> slots{nullptr}; // 0 = libre; si no, ID en records
+    ChunkedArray<const Record *> records;
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "SlabAllocator.h"
+
+//==================================================
+// Simbolizador de direcciones de retorno
+//==================================================
+// Traduce PCs a función y archivo:línea leyendo directamente los binarios:
+// tabla de símbolos ELF (.symtab, o .dynsym si el binario está stripeado) y
+// tabla de líneas DWARF (.debug_line). Los módulos cargados salen de
+// /proc/self/maps, o de un mapa de módulos guardado para simbolizar offline
+// desde otro proceso. Los resultados (también los fallidos) quedan en caché.
+//
+// resolve() puede tardar la primera vez que toca un módulo: está pensado para
+// el hilo simbolizador del tracker. Los reportes usan cached(), que nunca
+// parsea nada. Solo Linux; en otras plataformas todo queda sin resolver.
+//
+// Todo lo que arma (tablas, caché, textos) sale del SlabArena: corre dentro
+// del tracker y no puede volver a entrar por los operadores instrumentados.
+class Symbolizer
+{
+public:
+    using String = std::basic_string<char, std::char_traits<char>, SlabAllocator<char>>;
+    template <typename T>
+    using Vector = std::vector<T, SlabAllocator<T>>;
+
+    struct Location
+    {
+        String function; // demanglado
+        String file;
+        int line = 0;
+        String module;   // ruta del binario o biblioteca
+        uintptr_t offset = 0; // dirección dentro del módulo (sin el bias de carga)
+        bool resolved = false;
+    };
+
+    Symbolizer();
+    ~Symbolizer();
+    Symbolizer(const Symbolizer &) = delete;
+    Symbolizer &operator=(const Symbolizer &) = delete;
+
+    // --- Mapa de módulos ---
+    bool loadProcessModules();
+    // Formato de texto, una línea por rango ejecutable: "inicio fin bias ruta"
+    // (hexadecimal). loadModuleMap() reemplaza el mapa y desactiva la recarga
+    // desde /proc/self/maps.
+    String moduleMap() const;
+    bool loadModuleMap(std::string_view text);
+
+    // --- Resolución ---
+    Location resolve(const void *pc);
+    bool cached(const void *pc, Location &out) const;
+    size_t cacheSize() const;
+
+    // "función (archivo:línea)", "módulo+0x1f3" o "0x7f..." si no hay nada
+    static String format(const void *pc, const Location &loc);
+
+private:
+    struct Image; // binario ELF mapeado y sus tablas ya parseadas
+
+    struct Module
+    {
+        uintptr_t start;
+        uintptr_t end;
+        uintptr_t bias;
+        String path;
+    };
+
+    // std::hash no está especializado para strings con otro allocator
+    struct StringHash
+    {
+        size_t operator()(const String &s) const noexcept { return std::hash<std::string_view>()(s); }
+    };
+
+    template <typename K, typename V, typename Hash = std::hash<K>>
+    using Map = std::unordered_map<K, V, Hash, std::equal_to<K>, SlabAllocator<std::pair<const K, V>>>;
+
+    bool readProcMaps();
+    Location resolveUncached(uintptr_t pc);
+    const Module *findModule(uintptr_t pc) const noexcept;
+    Image *imageFor(const String &path);
+
+    mutable std::mutex modulesMtx; // módulos e imágenes; solo lo toma resolve()
+    Vector<Module> modules;        // ordenados por inicio
+    Map<String, Image *, StringHash> images; // nullptr si no se pudo abrir
+    bool offline = false;
+
+    mutable std::mutex cacheMtx;
+    Map<uintptr_t, Location> cache;
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include "TypeName.h"
+#include <cstddef>
+#include <new>
+#include <utility>
+
+//==================================================
+// Asignaciones con tipo (MT_NEW, TrackingAllocator)
+//==================================================
+// El `#define new` de MemoryMacros.h solo ve archivo y línea; estas
+// variantes además pasan el nombre de T (TypeName.h), así typeName y todo
+// lo que se agrupa por tipo muestran el tipo real en vez de "unknown":
+//
+//   Widget *w = MT_NEW(Widget, 1, "a");       // delete w;
+//   int *v = MT_NEW_ARRAY(int, 64);           // delete[] v;
+//   std::vector<int, TrackingAllocator<int>> xs(MT_ALLOCATOR(int));
+//
+// Se liberan con delete/delete[] normales. Un T con comas (`std::map<K, V>`)
+// necesita un alias antes de pasarlo a las macros.
+//
+// Va aparte de MemoryMacros.h porque el #define new rompería cada
+// `operator new` de este archivo; MemoryMacros.h lo incluye antes. Con
+// MT_DISABLED todo esto se reduce a new y operator new corrientes.
+
+void* operator new(std::size_t size, const char* file, int line, const char* type);
+void* operator new[](std::size_t size, const char* file, int line, const char* type);
+void* operator new(std::size_t size, std::align_val_t alignment, const char* file, int line, const char* type);
+void* operator new[](std::size_t size, std::align_val_t alignment, const char* file, int line, const char* type);
+
+// Placement delete correspondientes (constructor que lanza)
+void operator delete(void* ptr, const char* file, int line, const char* type) noexcept;
+void operator delete[](void* ptr, const char* file, int line, const char* type) noexcept;
+void operator delete(void* ptr, std::align_val_t alignment, const char* file, int line, const char* type) noexcept;
+void operator delete[](void* ptr, std::align_val_t alignment, const char* file, int line, const char* type) noexcept;
+
+// Los tipos sobrealineados toman solos la variante con std::align_val_t
+template <typename T>
+struct TrackedNew
+{
+    const char* file;
+    int line;
+
+    template <typename... Args>
+    T* operator()(Args&&... args) const
+    {
+#if defined(MT_DISABLED)
+        return ::new T(std::forward<Args>(args)...);
+#else
+        return ::new (file, line, TrackedTypeName<T>::value) T(std::forward<Args>(args)...);
+#endif
+    }
+};
+
+template <typename T>
+struct TrackedNewArray
+{
+    const char* file;
+    int line;
+
+    T* operator()(std::size_t count) const
+    {
+#if defined(MT_DISABLED)
+        return ::new T[count];
+#else
+        return ::new (file, line, TrackedTypeName<T>::arrayValue) T[count];
+#endif
+    }
+};
+
+#define MT_NEW(T, ...) (TrackedNew<T>{__FILE__, __LINE__}(__VA_ARGS__))
+#define MT_NEW_ARRAY(T, count) (TrackedNewArray<T>{__FILE__, __LINE__}(count))
+
+//-----------------------------
+// Allocator para contenedores
+//-----------------------------
+// Cumple los requisitos de Allocator: los contenedores de la STL lo
+// aceptan tal cual. Sin estado propio más allá del sitio, así que dos
+// instancias siempre son intercambiables. Un pedido de un solo objeto
+// (nodos de map/list) queda como "T", uno de varios como "T[]".
+template <typename T>
+class TrackingAllocator
+{
+public:
+    using value_type = T;
+
+    TrackingAllocator() noexcept = default;
+    TrackingAllocator(const char* file, int line) noexcept : file(file), line(line) {}
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U>& other) noexcept : file(other.file), line(other.line) {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+
+#if defined(MT_DISABLED)
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return static_cast<T*>(::operator new[](n * sizeof(T), static_cast<std::align_val_t>(alignof(T))));
+        else
+            return static_cast<T*>(::operator new[](n * sizeof(T)));
+#else
+        const char* type = n == 1 ? TrackedTypeName<T>::value : TrackedTypeName<T>::arrayValue;
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return static_cast<T*>(::operator new[](n * sizeof(T), static_cast<std::align_val_t>(alignof(T)), file, line, type));
+        else
+            return static_cast<T*>(::operator new[](n * sizeof(T), file, line, type));
+#endif
+    }
+
+    // Con el tamaño: el tracker lo compara con el registrado
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete[](ptr, n * sizeof(T), static_cast<std::align_val_t>(alignof(T)));
+        else
+            ::operator delete[](ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U>&) const noexcept { return false; }
+
+private:
+    template <typename U>
+    friend class TrackingAllocator;
+
+    const char* file = "unknown";
+    int line = 0;
+};
+
+#define MT_ALLOCATOR(T) (TrackingAllocator<T>(__FILE__, __LINE__))
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define MT_TSC_X86 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MT_TSC_X86 1
+#elif defined(__aarch64__)
+#define MT_TSC_ARM64 1
+#endif
+
+//==================================================
+// Sellos de tiempo baratos
+//==================================================
+// Un sello es la cuenta del contador de la CPU (rdtsc en x86, cntvct_el0 en
+// AArch64) desde que se construyó el reloj, desplazada para que cada unidad
+// valga entre 2 y 4 ns. Leerlo son unas decenas de ciclos, contra una
+// llamada a clock_gettime por cada steady_clock::now().
+//
+// Los registros guardan solo 48 bits (época de 16 + delta de 32, ver
+// AllocationInfo): alcanzan para varios días y las restas se hacen módulo
+// 2^48. Pasar a ns solo hace falta para las vidas de los bloques y para los
+// reportes; el factor se calibra contra steady_clock al arrancar y
+// recalibrate() lo refina con una base de tiempo más larga.
+//
+// Sin TSC invariante (o en otras arquitecturas) se usa steady_clock y cada
+// unidad vale 2 ns.
+class TscClock
+{
+public:
+    static constexpr unsigned kStampBits = 48;
+    static constexpr uint64_t kStampMask = (uint64_t(1) << kStampBits) - 1;
+
+    TscClock() noexcept;
+    TscClock(const TscClock &) = delete;
+    TscClock &operator=(const TscClock &) = delete;
+
+    // Sello actual; guardarlo con `& kStampMask` (o AllocationInfo::setStamp)
+    uint64_t now() const noexcept { return (readCounter() - baseTicks.load(std::memory_order_relaxed)) >> shift; }
+
+    // Unidades transcurridas entre dos sellos de 48 bits (tolera el wrap)
+    static uint64_t elapsed(uint64_t from, uint64_t to) noexcept { return (to - from) & kStampMask; }
+    // `a` no es posterior a `b` (ventana de medio rango, como los números de secuencia)
+    static bool notAfter(uint64_t a, uint64_t b) noexcept { return elapsed(a, b) < (kStampMask >> 1); }
+    // Sello completo más reciente que no pasa de `reference` y termina en
+    // los 48 bits de `stamp`. Exacto si `stamp` tiene menos de 2^48 unidades de antigüedad.
+    static uint64_t widen(uint64_t stamp, uint64_t reference) noexcept { return reference - elapsed(stamp, reference); }
+
+    int64_t toNs(uint64_t units) const noexcept
+    {
+        return static_cast<int64_t>(static_cast<double>(units) * nsPerUnit.load(std::memory_order_relaxed));
+    }
+
+    // Mejora el factor de conversión con todo el tiempo transcurrido
+    void recalibrate() noexcept;
+    // Adelanta el reloj `units` unidades sin afectar la calibración (tests:
+    // bloques que parecen vivos desde hace días)
+    void advance(uint64_t units) noexcept;
+    bool usesCpuCounter() const noexcept { return cpuCounter; }
+
+private:
+    static uint64_t steadyNs() noexcept;
+
+    uint64_t readCounter() const noexcept
+    {
+#if defined(MT_TSC_X86)
+        if (cpuCounter)
+            return __rdtsc();
+#elif defined(MT_TSC_ARM64)
+        if (cpuCounter)
+        {
+            uint64_t value;
+            asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+            return value;
+        }
+#endif
+        return steadyNs();
+    }
+
+    bool cpuCounter = false;
+    unsigned shift = 1;
+    std::atomic<uint64_t> baseTicks{0};
+    std::atomic<uint64_t> advancedUnits{0};
+    uint64_t baseNs = 0;
+    std::atomic<double> nsPerUnit{2.0};
+};
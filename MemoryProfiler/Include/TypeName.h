@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <string_view>
+
+//==================================================
+// Nombre de tipo en tiempo de compilación
+//==================================================
+// El compilador escribe T dentro de la firma de mt_signature<T>()
+// (__PRETTY_FUNCTION__ / __FUNCSIG__); se recorta en un constexpr y se
+// copia a un arreglo estático terminado en '\0'. Cada tipo tiene así un
+// único puntero para toda la vida del programa, y InternTable lo resuelve
+// por su caché de punteros: se interna una vez por tipo y después el
+// registro no toca el texto.
+//
+// El nombre es el que imprime el compilador (`std::__cxx11::basic_string<char>`
+// en GCC, sin `class `/`struct ` en MSVC). Un compilador sin ninguna de las
+// dos macros deja "unknown".
+template <typename T>
+constexpr const char *mt_signature() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#elif defined(__GNUC__) || defined(__clang__)
+    return __PRETTY_FUNCTION__;
+#else
+    return "";
+#endif
+}
+
+template <typename T>
+constexpr std::string_view mt_type_name_view() noexcept
+{
+    constexpr std::string_view sig = mt_signature<T>();
+#if defined(_MSC_VER) && !defined(__clang__)
+    // "const char *__cdecl mt_signature<int>(void) noexcept"
+    constexpr std::string_view open = "mt_signature<";
+    constexpr size_t begin = sig.find(open);
+    constexpr size_t end = sig.rfind(">(void)");
+    if constexpr (begin == std::string_view::npos || end == std::string_view::npos)
+        return "unknown";
+    else
+    {
+        std::string_view name = sig.substr(begin + open.size(), end - begin - open.size());
+        for (std::string_view prefix : {"class ", "struct ", "union ", "enum "})
+            if (name.substr(0, prefix.size()) == prefix)
+                name.remove_prefix(prefix.size());
+        return name;
+    }
+#else
+    // GCC: "... mt_signature() [with T = int]", Clang: "... mt_signature() [T = int]"
+    constexpr size_t begin = sig.find("T = ");
+    if constexpr (begin == std::string_view::npos || sig.empty() || sig.back() != ']')
+        return "unknown";
+    else
+        return sig.substr(begin + 4, sig.size() - 1 - (begin + 4));
+#endif
+}
+
+template <size_t N>
+constexpr std::array<char, N + 1> mt_type_name_storage(std::string_view name, std::string_view suffix) noexcept
+{
+    std::array<char, N + 1> out{};
+    size_t i = 0;
+    for (char c : name)
+        out[i++] = c;
+    for (char c : suffix)
+        out[i++] = c;
+    return out;
+}
+
+template <typename T>
+struct TrackedTypeName
+{
+    static constexpr std::string_view view = mt_type_name_view<T>();
+    static constexpr auto storage = mt_type_name_storage<view.size()>(view, "");
+    static constexpr auto arrayStorage = mt_type_name_storage<view.size() + 2>(view, "[]");
+
+    static constexpr const char *value = storage.data();           // "T"
+    static constexpr const char *arrayValue = arrayStorage.data(); // "T[]", como new[]
+};
@@ -0,0 +1,125 @@
+#include "AllocationTable.h"
+#include <cstring>
+
+//==================================================
+// Selección de shard
+//==================================================
+size_t AllocationTable::shardIndex(const void *ptr) noexcept
+{
+    // Los bloques de malloc vienen alineados a 16 bytes: se descartan los bits
+    // bajos y se mezcla con una constante de Fibonacci para repartir bien
+    // direcciones consecutivas entre shards.
+    uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)) >> 4;
+    h *= 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h >> (64 - kShardBits));
+}
+
+//==================================================
+// Vista exclusiva
+//==================================================
+AllocationTable::ExclusiveScope::ExclusiveScope(AllocationTable &t) : table(t)
+{
+    // Orden fijo (0..N-1) para no provocar deadlocks entre dos lectores.
+    for (Shard &shard : table.shards)
+    {
+        shard.mtx.lock();
+    }
+}
+
+AllocationTable::ExclusiveScope::~ExclusiveScope()
+{
+    for (size_t i = kShardCount; i-- > 0;)
+    {
+        table.shards[i].mtx.unlock();
+    }
+}
+
+size_t AllocationTable::ExclusiveScope::size() const
+{
+    size_t total = 0;
+    for (const Shard &shard : table.shards)
+    {
+        total += shard.map.size() + shard.blockCount;
+    }
+    return total;
+}
+
+//==================================================
+// Snapshot
+//==================================================
+AllocationTable::Snapshot::~Snapshot()
+{
+    SlabArena::unmapPages(records, capacity * sizeof(AllocationInfo));
+}
+
+AllocationTable::Snapshot::Snapshot(Snapshot &&other) noexcept
+    : records(other.records), count(other.count), capacity(other.capacity), truncated(other.truncated)
+{
+    other.records = nullptr;
+    other.count = other.capacity = 0;
+}
+
+AllocationTable::Snapshot &AllocationTable::Snapshot::operator=(Snapshot &&other) noexcept
+{
+    if (this != &other)
+    {
+        SlabArena::unmapPages(records, capacity * sizeof(AllocationInfo));
+        records = other.records;
+        count = other.count;
+        capacity = other.capacity;
+        truncated = other.truncated;
+        other.records = nullptr;
+        other.count = other.capacity = 0;
+    }
+    return *this;
+}
+
+bool AllocationTable::Snapshot::reserve(size_t n) noexcept
+{
+    if (n <= capacity)
+        return true;
+    auto *grown = static_cast<AllocationInfo *>(SlabArena::mapPages(n * sizeof(AllocationInfo)));
+    if (!grown)
+        return false;
+    if (count)
+        std::memcpy(static_cast<void *>(grown), records, count * sizeof(AllocationInfo));
+    SlabArena::unmapPages(records, capacity * sizeof(AllocationInfo));
+    records = grown;
+    capacity = n;
+    return true;
+}
+
+AllocationTable::Snapshot AllocationTable::snapshot(size_t expected)
+{
+    Snapshot snap;
+    snap.reserve(expected + expected / 8 + 256);
+
+    for (Shard &shard : shards)
+    {
+        std::unique_lock<std::mutex> lock(shard.mtx);
+
+        // Si no entra se agranda con el lock suelto (mmap + copia) y se
+        // vuelve a mirar: el shard pudo crecer mientras tanto
+        while (snap.count + shard.map.size() + shard.blockCount > snap.capacity)
+        {
+            const size_t needed = snap.count + shard.map.size() + shard.blockCount;
+            lock.unlock();
+            if (!snap.reserve(needed + needed / 2))
+            {
+                snap.truncated = true;
+                return snap;
+            }
+            lock.lock();
+        }
+
+        for (const auto &kv : shard.map)
+        {
+            snap.records[snap.count++] = kv.second;
+        }
+        for (BlockHeader *block = shard.blocks; block; block = block->next)
+        {
+            snap.records[snap.count++] = block->info();
+        }
+    }
+    return snap;
+}
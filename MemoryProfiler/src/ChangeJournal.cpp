@@ -0,0 +1,72 @@
+#include "ChangeJournal.h"
+#include "SlabAllocator.h"
+#include <new>
+
+ChangeJournal::~ChangeJournal()
+{
+    for (Stripe &stripe : stripes)
+    {
+        Chunk *chunk = stripe.head.load(std::memory_order_relaxed);
+        while (chunk)
+        {
+            Chunk *next = chunk->next.load(std::memory_order_relaxed);
+            chunk->~Chunk();
+            SlabArena::unmapPages(chunk, sizeof(Chunk));
+            chunk = next;
+        }
+    }
+}
+
+//==================================================
+// Escritura
+//==================================================
+void ChangeJournal::append(Stripe &stripe, const Change &c) noexcept
+{
+    Chunk *tail = stripe.tail;
+    uint32_t n = tail ? tail->count.load(std::memory_order_relaxed) : kChunkEntries;
+    if (n == kChunkEntries)
+    {
+        void *mem = SlabArena::mapPages(sizeof(Chunk));
+        if (!mem)
+        {
+            lost.store(true, std::memory_order_relaxed);
+            return;
+        }
+        Chunk *fresh = new (mem) Chunk();
+        fresh->firstGen = c.generation;
+        // El lector llega a `fresh` por head o por next, nunca por tail
+        if (tail)
+            tail->next.store(fresh, std::memory_order_release);
+        else
+            stripe.head.store(fresh, std::memory_order_release);
+        stripe.tail = fresh;
+        tail = fresh;
+        n = 0;
+    }
+    tail->entries[n] = c;
+    tail->count.store(n + 1, std::memory_order_release);
+}
+
+//==================================================
+// Recorte
+//==================================================
+// El chunk de la cola nunca se libera: es el único que el escritor toca, así
+// que todo lo anterior se puede devolver sin tomar el lock del shard.
+void ChangeJournal::trim(uint32_t gen) noexcept
+{
+    for (Stripe &stripe : stripes)
+    {
+        Chunk *chunk = stripe.head.load(std::memory_order_acquire);
+        while (chunk)
+        {
+            Chunk *next = chunk->next.load(std::memory_order_acquire);
+            const uint32_t count = chunk->count.load(std::memory_order_acquire);
+            if (!next || count == 0 || chunk->entries[count - 1].generation >= gen)
+                break;
+            stripe.head.store(next, std::memory_order_release);
+            chunk->~Chunk();
+            SlabArena::unmapPages(chunk, sizeof(Chunk));
+            chunk = next;
+        }
+    }
+}
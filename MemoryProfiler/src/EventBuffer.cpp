@@ -0,0 +1,23 @@
+#include "EventBuffer.h"
+#include "SlabAllocator.h"
+#include <new>
+
+static_assert((ThreadEventBuffer::kCapacity & (ThreadEventBuffer::kCapacity - 1)) == 0,
+              "kCapacity debe ser potencia de dos");
+
+// Páginas propias del SO: alineadas de sobra y fuera del heap de la aplicación
+ThreadEventBuffer *ThreadEventBuffer::create() noexcept
+{
+    void *mem = SlabArena::mapPages(sizeof(ThreadEventBuffer));
+    if (!mem)
+        return nullptr;
+    return new (mem) ThreadEventBuffer();
+}
+
+void ThreadEventBuffer::destroy(ThreadEventBuffer *buffer) noexcept
+{
+    if (!buffer)
+        return;
+    buffer->~ThreadEventBuffer();
+    SlabArena::unmapPages(buffer, sizeof(ThreadEventBuffer));
+}
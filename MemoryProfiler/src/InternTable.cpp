@@ -0,0 +1,238 @@
+#include "InternTable.h"
+#include <cstring>
+#include <new>
+
+//==================================================
+// Constructor / Destructor
+//==================================================
+InternTable::InternTable()
+{
+    stringCache.store(createCache(kInitialCacheSlots), std::memory_order_release);
+    siteCache.store(createCache(kInitialCacheSlots), std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    internStringLocked("unknown");
+    sites.push_back(Site{kUnknown, 0});
+    siteIds.emplace(0, kUnknown);
+}
+
+InternTable::~InternTable()
+{
+    for (uint32_t i = 0; i < strings.size(); ++i)
+    {
+        const char *str = strings[i];
+        SlabArena::shared().deallocate(const_cast<char *>(str), std::strlen(str) + 1);
+    }
+    destroyCache(stringCache.load(std::memory_order_relaxed));
+    destroyCache(siteCache.load(std::memory_order_relaxed));
+}
+
+//==================================================
+// Caché de punteros
+//==================================================
+size_t InternTable::slotFor(const char *ptr, int line, size_t mask) noexcept
+{
+    uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+    h ^= static_cast<uint64_t>(static_cast<uint32_t>(line)) << 32;
+    h *= 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h >> 32) & mask;
+}
+
+// `slots` potencia de dos. nullptr si el arena no da memoria.
+InternTable::PointerCache *InternTable::createCache(size_t slots) noexcept
+{
+    void *raw = SlabArena::shared().allocate(sizeof(PointerCache) + slots * sizeof(PointerSlot));
+    if (!raw)
+        return nullptr;
+    PointerCache *cache = new (raw) PointerCache{slots - 1, 0, nullptr};
+    for (size_t i = 0; i < slots; ++i)
+        new (&cache->slots()[i]) PointerSlot();
+    return cache;
+}
+
+// Libera la tabla y todas las que reemplazó
+void InternTable::destroyCache(PointerCache *cache) noexcept
+{
+    while (cache)
+    {
+        PointerCache *retired = cache->retired;
+        SlabArena::shared().deallocate(cache, sizeof(PointerCache) + (cache->mask + 1) * sizeof(PointerSlot));
+        cache = retired;
+    }
+}
+
+bool InternTable::cacheLookup(const std::atomic<PointerCache *> &cache, const char *ptr, int line, uint32_t &id) const noexcept
+{
+    const PointerCache *table = cache.load(std::memory_order_acquire);
+    if (!table)
+        return false;
+
+    const PointerSlot *slots = table->slots();
+    size_t slot = slotFor(ptr, line, table->mask);
+    for (size_t probe = 0; probe < kMaxProbes; ++probe, slot = (slot + 1) & table->mask)
+    {
+        const char *key = slots[slot].key.load(std::memory_order_acquire);
+        if (!key)
+            return false;
+        if (key == ptr && slots[slot].line.load(std::memory_order_relaxed) == line)
+        {
+            id = slots[slot].id.load(std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Requiere mtx. true si quedó en la tabla (o ya estaba); false si no hay
+// slot libre dentro de kMaxProbes.
+bool InternTable::tryCacheStore(PointerCache *cache, const char *ptr, int line, uint32_t id) noexcept
+{
+    PointerSlot *slots = cache->slots();
+    size_t slot = slotFor(ptr, line, cache->mask);
+    for (size_t probe = 0; probe < kMaxProbes; ++probe, slot = (slot + 1) & cache->mask)
+    {
+        const char *key = slots[slot].key.load(std::memory_order_relaxed);
+        if (key == ptr && slots[slot].line.load(std::memory_order_relaxed) == line)
+            return true;
+        if (!key)
+        {
+            slots[slot].line.store(line, std::memory_order_relaxed);
+            slots[slot].id.store(id, std::memory_order_relaxed);
+            slots[slot].key.store(ptr, std::memory_order_release);
+            ++cache->used;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Requiere mtx. Sin memoria para crecer, el puntero queda sin cachear.
+void InternTable::cacheStore(std::atomic<PointerCache *> &cache, const char *ptr, int line, uint32_t id) noexcept
+{
+    PointerCache *table = cache.load(std::memory_order_relaxed);
+    if (!table)
+        return;
+    if ((table->used + 1) * 2 <= table->mask + 1 && tryCacheStore(table, ptr, line, id))
+        return;
+
+    // Se copia a una del doble (o más, si alguna clave no entra en kMaxProbes)
+    for (size_t slots = (table->mask + 1) * 2;; slots *= 2)
+    {
+        PointerCache *bigger = createCache(slots);
+        if (!bigger)
+            return;
+
+        bool complete = tryCacheStore(bigger, ptr, line, id);
+        const PointerSlot *old = table->slots();
+        for (size_t i = 0; complete && i <= table->mask; ++i)
+        {
+            if (const char *key = old[i].key.load(std::memory_order_relaxed))
+                complete = tryCacheStore(bigger, key, old[i].line.load(std::memory_order_relaxed), old[i].id.load(std::memory_order_relaxed));
+        }
+        if (!complete)
+        {
+            destroyCache(bigger);
+            continue;
+        }
+
+        bigger->retired = table;
+        cache.store(bigger, std::memory_order_release);
+        return;
+    }
+}
+
+//==================================================
+// Internado
+//==================================================
+uint32_t InternTable::internString(const char *str)
+{
+    if (!str)
+        return kUnknown;
+
+    uint32_t id;
+    if (cacheLookup(stringCache, str, 0, id))
+        return id;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    id = internStringLocked(str);
+    cacheStore(stringCache, str, 0, id);
+    return id;
+}
+
+uint32_t InternTable::internText(std::string_view text)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return internStringLocked(text);
+}
+
+// Requiere mtx.
+uint32_t InternTable::internStringLocked(std::string_view str)
+{
+    auto it = stringIds.find(str);
+    if (it != stringIds.end())
+        return it->second;
+
+    const size_t len = str.size();
+    char *copy = static_cast<char *>(SlabArena::shared().allocate(len + 1));
+    if (!copy)
+        return kUnknown;
+    std::memcpy(copy, str.data(), len);
+    copy[len] = '\0';
+
+    const uint32_t id = strings.size();
+    if (!strings.push_back(copy))
+    {
+        SlabArena::shared().deallocate(copy, len + 1);
+        return kUnknown;
+    }
+    // La clave apunta a la copia, que vive tanto como la tabla
+    stringIds.emplace(std::string_view(copy, len), id);
+    return id;
+}
+
+uint32_t InternTable::internSite(const char *file, int line)
+{
+    if (!file)
+        return kUnknown;
+
+    uint32_t id;
+    if (cacheLookup(siteCache, file, line, id))
+        return id;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    const uint32_t fileId = internStringLocked(file);
+    cacheStore(stringCache, file, 0, fileId);
+
+    const uint64_t key = (static_cast<uint64_t>(fileId) << 32) | static_cast<uint32_t>(line);
+    auto it = siteIds.find(key);
+    if (it != siteIds.end())
+    {
+        id = it->second;
+    }
+    else
+    {
+        id = sites.size();
+        if (!sites.push_back(Site{fileId, line}))
+            return kUnknown;
+        siteIds.emplace(key, id);
+    }
+    cacheStore(siteCache, file, line, id);
+    return id;
+}
+
+//==================================================
+// Resolución
+//==================================================
+const char *InternTable::string(uint32_t id) const noexcept
+{
+    if (id >= strings.size())
+        return strings[kUnknown];
+    return strings[id];
+}
+
+InternTable::Site InternTable::site(uint32_t siteId) const noexcept
+{
+    if (siteId >= sites.size())
+        return sites[kUnknown];
+    return sites[siteId];
+}
@@ -0,0 +1,767 @@
+#include "LeakScanner.h"
+#include "SlabAllocator.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define MT_LEAK_SCAN_SUPPORTED 1
+#endif
+
+namespace
+{
+    struct MtRange
+    {
+        uintptr_t begin;
+        uintptr_t end;
+    };
+
+    // Arreglo creciente en memoria directa del SO: sirve con el mundo detenido
+    template <typename T>
+    struct ScanArray
+    {
+        T *data = nullptr;
+        size_t count = 0;
+        size_t capacity = 0;
+
+        ScanArray() = default;
+        ScanArray(const ScanArray &) = delete;
+        ScanArray &operator=(const ScanArray &) = delete;
+        ~ScanArray()
+        {
+            if (data)
+                SlabArena::unmapPages(data, capacity * sizeof(T));
+        }
+
+        bool reserve(size_t wanted) noexcept
+        {
+            if (wanted <= capacity)
+                return true;
+            size_t grown = capacity ? capacity * 2 : 4096 / sizeof(T);
+            while (grown < wanted)
+                grown *= 2;
+            T *bigger = static_cast<T *>(SlabArena::mapPages(grown * sizeof(T)));
+            if (!bigger)
+                return false;
+            if (data)
+            {
+                std::memcpy(bigger, data, count * sizeof(T));
+                SlabArena::unmapPages(data, capacity * sizeof(T));
+            }
+            data = bigger;
+            capacity = grown;
+            return true;
+        }
+
+        bool push(const T &value) noexcept
+        {
+            if (!reserve(count + 1))
+                return false;
+            data[count++] = value;
+            return true;
+        }
+    };
+
+    template <typename T>
+    T *mt_map_array(size_t count) noexcept
+    {
+        return static_cast<T *>(SlabArena::mapPages(std::max<size_t>(count, 1) * sizeof(T)));
+    }
+
+    template <typename T>
+    void mt_unmap_array(T *array, size_t count) noexcept
+    {
+        if (array)
+            SlabArena::unmapPages(array, std::max<size_t>(count, 1) * sizeof(T));
+    }
+
+    // Un escaneo a la vez: comparten el manejador de señal
+    std::mutex g_mt_scan_mtx;
+}
+
+#if defined(MT_LEAK_SCAN_SUPPORTED)
+//==================================================
+// Detención de hilos
+//==================================================
+// Cada hilo recibe la señal, anota dónde quedó su pila (el marco de la
+// señal, con todos sus registros, está justo encima) y espera dormido hasta
+// que el escaneo termine. El manejador no toca nada que pueda estar tomado.
+namespace
+{
+    constexpr unsigned kMaxStopped = 4096;
+
+    std::atomic<uintptr_t> g_mt_stopped_sp[kMaxStopped];
+    std::atomic<unsigned> g_mt_stop_claimed{0};
+    std::atomic<unsigned> g_mt_stop_parked{0};
+    std::atomic<unsigned> g_mt_stop_left{0};
+    std::atomic<bool> g_mt_stop_resume{false};
+
+    int mt_stop_signal() noexcept
+    {
+        return SIGRTMIN + 6;
+    }
+
+    void mt_pause_us(long us) noexcept
+    {
+        timespec pause{0, us * 1000};
+        nanosleep(&pause, nullptr);
+    }
+
+    uint64_t mt_monotonic_ns() noexcept
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    pid_t mt_gettid() noexcept
+    {
+        return static_cast<pid_t>(syscall(SYS_gettid));
+    }
+
+    void mt_stop_handler(int, siginfo_t *, void *)
+    {
+        const int savedErrno = errno;
+        volatile uintptr_t marker = 0;
+        const unsigned slot = g_mt_stop_claimed.fetch_add(1, std::memory_order_relaxed);
+        if (slot < kMaxStopped)
+            g_mt_stopped_sp[slot].store(reinterpret_cast<uintptr_t>(&marker), std::memory_order_relaxed);
+        g_mt_stop_parked.fetch_add(1, std::memory_order_release);
+
+        while (!g_mt_stop_resume.load(std::memory_order_acquire))
+            mt_pause_us(100);
+
+        g_mt_stop_left.fetch_add(1, std::memory_order_release);
+        errno = savedErrno;
+    }
+
+    // Recorre /proc/self/task con getdents64: opendir pediría memoria a malloc
+    template <typename Fn>
+    bool mt_for_each_task(Fn &&fn) noexcept
+    {
+        const int fd = open("/proc/self/task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        alignas(8) char buf[4096];
+        for (;;)
+        {
+            const long got = syscall(SYS_getdents64, fd, buf, sizeof(buf));
+            if (got <= 0)
+                break;
+            // linux_dirent64: d_ino(8) d_off(8) d_reclen(2) d_type(1) d_name
+            for (long off = 0; off < got;)
+            {
+                unsigned short reclen;
+                std::memcpy(&reclen, buf + off + 16, sizeof(reclen));
+                const char *name = buf + off + 19;
+                if (*name >= '0' && *name <= '9')
+                {
+                    pid_t tid = 0;
+                    for (const char *c = name; *c; ++c)
+                        tid = tid * 10 + (*c - '0');
+                    fn(tid);
+                }
+                off += reclen;
+            }
+        }
+        close(fd);
+        return true;
+    }
+
+    // Regiones legibles de /proc/self/maps, en orden de dirección
+    bool mt_read_maps(ScanArray<MtRange> &out) noexcept
+    {
+        const int fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        ScanArray<char> text;
+        for (;;)
+        {
+            if (!text.reserve(text.count + 4096))
+            {
+                close(fd);
+                return false;
+            }
+            const ssize_t got = read(fd, text.data + text.count, text.capacity - text.count);
+            if (got <= 0)
+                break;
+            text.count += static_cast<size_t>(got);
+        }
+        close(fd);
+
+        auto hex = [](const char *&c) noexcept
+        {
+            uintptr_t value = 0;
+            for (;; ++c)
+            {
+                if (*c >= '0' && *c <= '9')
+                    value = value * 16 + static_cast<uintptr_t>(*c - '0');
+                else if (*c >= 'a' && *c <= 'f')
+                    value = value * 16 + static_cast<uintptr_t>(*c - 'a' + 10);
+                else
+                    return value;
+            }
+        };
+
+        // "inicio-fin perms ..." por línea
+        const char *c = text.data;
+        const char *const end = text.data + text.count;
+        while (c < end)
+        {
+            const char *lineEnd = static_cast<const char *>(std::memchr(c, '\n', static_cast<size_t>(end - c)));
+            if (!lineEnd)
+                break;
+            MtRange range;
+            range.begin = hex(c);
+            ++c;
+            range.end = hex(c);
+            ++c;
+            if (*c == 'r' && !out.push(range))
+                return false;
+            c = lineEnd + 1;
+        }
+        return true;
+    }
+
+    // Región legible que contiene [begin, end), aunque abarque varias contiguas
+    const MtRange *mt_find_readable(const ScanArray<MtRange> &maps, uintptr_t begin, uintptr_t end) noexcept
+    {
+        const MtRange *first = std::upper_bound(maps.data, maps.data + maps.count, begin,
+                                                [](uintptr_t value, const MtRange &r)
+                                                { return value < r.begin; });
+        if (first == maps.data || (first - 1)->end <= begin)
+            return nullptr;
+        const MtRange *region = first - 1;
+        for (const MtRange *r = region; r->end < end; ++r)
+        {
+            if (r + 1 == maps.data + maps.count || (r + 1)->begin != r->end)
+                return nullptr;
+        }
+        return region;
+    }
+
+    int mt_collect_segment(dl_phdr_info *info, size_t, void *data)
+    {
+        auto &out = *static_cast<ScanArray<MtRange> *>(data);
+        for (int i = 0; i < info->dlpi_phnum; ++i)
+        {
+            const ElfW(Phdr) &ph = info->dlpi_phdr[i];
+            if (ph.p_type != PT_LOAD || !(ph.p_flags & PF_W) || ph.p_memsz == 0)
+                continue;
+            const uintptr_t begin = info->dlpi_addr + ph.p_vaddr;
+            if (!out.push({begin, begin + ph.p_memsz}))
+                return 1;
+        }
+        return 0;
+    }
+
+    // Hasta dónde puede llegar una pila desde su puntero actual
+    uintptr_t mt_stack_span() noexcept
+    {
+        constexpr uintptr_t kDefault = 8u << 20;
+        rlimit limit;
+        if (getrlimit(RLIMIT_STACK, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY)
+            return kDefault;
+        return std::max<uintptr_t>(static_cast<uintptr_t>(limit.rlim_cur), kDefault);
+    }
+}
+#endif
+
+//==================================================
+// Marcado en paralelo
+//==================================================
+// Cada ronda reparte ítems (rangos raíz de 64 KB o bloques de la frontera)
+// con un cursor atómico; cada hilo sigue en profundidad lo que marca con su
+// pila local y lo que no entra pasa a la frontera de la ronda siguiente.
+// Marcar es un CAS sobre el estado del bloque: cada uno se recorre una vez.
+class LeakScanner::MarkPool
+{
+public:
+    static constexpr unsigned kMaxHelpers = 7;
+    static constexpr size_t kLocalCapacity = 1u << 16;
+
+    explicit MarkPool(LeakScanner &owner) noexcept : owner(owner) {}
+
+    ~MarkPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            quit = true;
+        }
+        wake.notify_all();
+        for (unsigned i = 0; i < helpers; ++i)
+            threads[i].join();
+        for (Local &local : locals)
+            mt_unmap_array(local.stack, kLocalCapacity);
+    }
+
+    // Crea los hilos antes de detener el mundo; devuelve cuántos participan
+    // contando al llamador, que usa locals[helpers]
+    unsigned start(unsigned wanted) noexcept
+    {
+        wanted = std::min(wanted, kMaxHelpers);
+        for (unsigned i = 0; i <= wanted; ++i)
+        {
+            locals[i].stack = mt_map_array<uint32_t>(kLocalCapacity);
+            if (!locals[i].stack)
+            {
+                if (i == 0)
+                    return 0;
+                wanted = i - 1;
+                break;
+            }
+        }
+        for (unsigned i = 0; i < wanted; ++i)
+        {
+            try
+            {
+                threads[i] = std::thread([this, i]
+                                         { helperLoop(i); });
+            }
+            catch (...)
+            {
+                break;
+            }
+            ++helpers;
+        }
+#if defined(MT_LEAK_SCAN_SUPPORTED)
+        // Los ayudantes no se detienen: hay que conocer su tid
+        for (unsigned i = 0; i < helpers; ++i)
+        {
+            while (tids[i].load(std::memory_order_acquire) == 0)
+                std::this_thread::yield();
+        }
+#endif
+        return helpers + 1;
+    }
+
+    bool isHelper(long tid) const noexcept
+    {
+        for (unsigned i = 0; i < helpers; ++i)
+        {
+            if (tids[i].load(std::memory_order_relaxed) == tid)
+                return true;
+        }
+        return false;
+    }
+
+    void mark(const MtRange *roots, size_t count) noexcept
+    {
+        runRound(roots, nullptr, count);
+        while (const size_t pending = overflow.exchange(0, std::memory_order_acq_rel))
+        {
+            std::swap(owner.frontier, owner.nextFrontier);
+            runRound(nullptr, owner.frontier, pending);
+        }
+    }
+
+private:
+    struct Local
+    {
+        uint32_t *stack = nullptr;
+        size_t depth = 0;
+    };
+
+    void runRound(const MtRange *roots, const uint32_t *blockItems, size_t count) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            rootItems = roots;
+            frontierItems = blockItems;
+            itemCount = count;
+            cursor.store(0, std::memory_order_relaxed);
+            busy = helpers;
+            ++round;
+        }
+        wake.notify_all();
+
+        work(locals[helpers]);
+
+        std::unique_lock<std::mutex> lock(mtx);
+        done.wait(lock, [this]
+                  { return busy == 0; });
+    }
+
+    void helperLoop(unsigned index) noexcept
+    {
+#if defined(MT_LEAK_SCAN_SUPPORTED)
+        tids[index].store(mt_gettid(), std::memory_order_release);
+#endif
+        uint64_t seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                wake.wait(lock, [&]
+                          { return quit || round != seen; });
+                if (quit)
+                    return;
+                seen = round;
+            }
+
+            work(locals[index]);
+
+            std::lock_guard<std::mutex> lock(mtx);
+            if (--busy == 0)
+                done.notify_one();
+        }
+    }
+
+    void work(Local &local) noexcept
+    {
+        for (;;)
+        {
+            const size_t i = cursor.fetch_add(1, std::memory_order_relaxed);
+            if (i >= itemCount)
+                return;
+            if (rootItems)
+            {
+                visit(rootItems[i].begin, rootItems[i].end, local);
+            }
+            else
+            {
+                const Block &block = owner.blocks[frontierItems[i]];
+                visit(block.start, block.end, local);
+            }
+
+            while (local.depth)
+            {
+                const Block &block = owner.blocks[local.stack[--local.depth]];
+                visit(block.start, block.end, local);
+            }
+        }
+    }
+
+    void visit(uintptr_t begin, uintptr_t end, Local &local) noexcept
+    {
+        owner.scanWords(begin, end, [&](size_t pos)
+                        {
+            std::atomic<uint8_t> &mark = owner.marks[pos];
+            uint8_t expected = Unreached;
+            if (mark.load(std::memory_order_relaxed) != Unreached ||
+                !mark.compare_exchange_strong(expected, Reachable, std::memory_order_relaxed))
+                return;
+            if (local.depth < kLocalCapacity)
+                local.stack[local.depth++] = static_cast<uint32_t>(pos);
+            else
+                owner.nextFrontier[overflow.fetch_add(1, std::memory_order_relaxed)] = static_cast<uint32_t>(pos); });
+    }
+
+    LeakScanner &owner;
+    std::thread threads[kMaxHelpers];
+    std::atomic<long> tids[kMaxHelpers] = {};
+    Local locals[kMaxHelpers + 1];
+    unsigned helpers = 0;
+
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t round = 0;
+    unsigned busy = 0;
+    bool quit = false;
+
+    // Ronda actual: rangos raíz o posiciones de la frontera
+    const MtRange *rootItems = nullptr;
+    const uint32_t *frontierItems = nullptr;
+    size_t itemCount = 0;
+    std::atomic<size_t> cursor{0};
+    std::atomic<size_t> overflow{0};
+};
+
+//==================================================
+// Índice de direcciones
+//==================================================
+LeakScanner::LeakScanner(const AllocationTable::Snapshot &records) noexcept
+    : records(records), count(records.size())
+{
+}
+
+LeakScanner::~LeakScanner()
+{
+    mt_unmap_array(blocks, count);
+    mt_unmap_array(marks, count);
+    mt_unmap_array(recordStates, count);
+    mt_unmap_array(frontier, count);
+    mt_unmap_array(nextFrontier, count);
+}
+
+bool LeakScanner::buildIndex() noexcept
+{
+    // Las posiciones se guardan en 32 bits
+    if (count > UINT32_MAX)
+        return false;
+
+    blocks = mt_map_array<Block>(count);
+    marks = mt_map_array<std::atomic<uint8_t>>(count); // mmap: ya en Unreached
+    recordStates = mt_map_array<uint8_t>(count);
+    frontier = mt_map_array<uint32_t>(count);
+    nextFrontier = mt_map_array<uint32_t>(count);
+    if (!blocks || !marks || !recordStates || !frontier || !nextFrontier)
+        return false;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uintptr_t start = reinterpret_cast<uintptr_t>(records[i].address);
+        blocks[i] = {start, start + records[i].size, static_cast<uint32_t>(i)};
+    }
+    std::sort(blocks, blocks + count, [](const Block &a, const Block &b)
+              { return a.start < b.start; });
+
+    if (count)
+    {
+        minAddress = blocks[0].start;
+        for (size_t i = 0; i < count; ++i)
+            maxAddress = std::max(maxAddress, std::max(blocks[i].end, blocks[i].start + 1));
+    }
+    return true;
+}
+
+size_t LeakScanner::find(uintptr_t value) const noexcept
+{
+    // Último bloque que empieza en `value` o antes
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (blocks[mid].start <= value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return kNotFound;
+    const Block &block = blocks[lo - 1];
+    // Un bloque de 0 bytes solo se alcanza por su dirección exacta
+    return value < block.end || value == block.start ? lo - 1 : kNotFound;
+}
+
+template <typename OnHit>
+void LeakScanner::scanWords(uintptr_t begin, uintptr_t end, OnHit &&onHit) const noexcept
+{
+    constexpr uintptr_t kWord = sizeof(uintptr_t);
+    begin = (begin + kWord - 1) & ~(kWord - 1);
+    for (uintptr_t at = begin; at + kWord <= end; at += kWord)
+    {
+        uintptr_t value;
+        std::memcpy(&value, reinterpret_cast<const void *>(at), kWord);
+        if (value < minAddress || value >= maxAddress)
+            continue;
+        const size_t pos = find(value);
+        if (pos != kNotFound)
+            onHit(pos);
+    }
+}
+
+//==================================================
+// Clasificación de lo no alcanzado
+//==================================================
+// Como Valgrind: cada bloque no marcado que todavía nadie alcanzó encabeza
+// un grupo y es perdido directo; lo que se alcanza desde él es indirecto,
+// incluso otro encabezado anterior (que deja de serlo). Un ciclo sin
+// referencias externas queda con un solo bloque directo.
+void LeakScanner::classifyLost() noexcept
+{
+    uint32_t *pending = frontier;
+    for (size_t leader = 0; leader < count; ++leader)
+    {
+        if (marks[leader].load(std::memory_order_relaxed) != Unreached)
+            continue;
+        marks[leader].store(DefinitelyLost, std::memory_order_relaxed);
+
+        size_t depth = 0;
+        pending[depth++] = static_cast<uint32_t>(leader);
+        while (depth)
+        {
+            const Block &block = blocks[pending[--depth]];
+            scanWords(block.start, block.end, [&](size_t pos)
+                      {
+                if (pos == leader)
+                    return;
+                const uint8_t state = marks[pos].load(std::memory_order_relaxed);
+                if (state == Unreached)
+                {
+                    marks[pos].store(IndirectlyLost, std::memory_order_relaxed);
+                    pending[depth++] = static_cast<uint32_t>(pos);
+                }
+                else if (state == DefinitelyLost)
+                {
+                    marks[pos].store(IndirectlyLost, std::memory_order_relaxed);
+                } });
+        }
+    }
+}
+
+//==================================================
+// Escaneo
+//==================================================
+// Lleva los registros callee-saved del llamador a su propia pila
+#if defined(MT_LEAK_SCAN_SUPPORTED)
+__attribute__((noinline)) void LeakScanner::captureCaller(LeakScanCaller &caller) noexcept
+{
+    setjmp(caller.regs);
+}
+#else
+void LeakScanner::captureCaller(LeakScanCaller &) noexcept
+{
+}
+#endif
+
+bool LeakScanner::run(const LeakScanCaller &caller, unsigned workers) noexcept
+{
+#if !defined(MT_LEAK_SCAN_SUPPORTED)
+    (void)caller;
+    (void)workers;
+    return false;
+#else
+    if (!buildIndex())
+        return false;
+
+    std::lock_guard<std::mutex> serial(g_mt_scan_mtx);
+
+    // dl_iterate_phdr toma el lock del cargador: antes de detener a nadie
+    ScanArray<MtRange> segments;
+    if (dl_iterate_phdr(mt_collect_segment, &segments) != 0)
+        return false;
+
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    MarkPool pool(*this);
+    workerCount = pool.start(workers - 1);
+    if (workerCount == 0)
+        return false;
+
+    // Detener el mundo
+    struct sigaction action;
+    struct sigaction previous;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = mt_stop_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(mt_stop_signal(), &action, &previous) != 0)
+        return false;
+
+    for (auto &slot : g_mt_stopped_sp)
+        slot.store(0, std::memory_order_relaxed);
+    g_mt_stop_claimed.store(0, std::memory_order_relaxed);
+    g_mt_stop_parked.store(0, std::memory_order_relaxed);
+    g_mt_stop_left.store(0, std::memory_order_relaxed);
+    g_mt_stop_resume.store(false, std::memory_order_release);
+
+    const pid_t pid = getpid();
+    const pid_t self = mt_gettid();
+    ScanArray<pid_t> signalled;
+    everyoneStopped = true;
+
+    // Se repite por si algún hilo creó otro antes de detenerse
+    for (bool added = true; added;)
+    {
+        added = false;
+        const bool listed = mt_for_each_task([&](pid_t tid)
+                                             {
+            if (tid == self || pool.isHelper(tid) ||
+                std::find(signalled.data, signalled.data + signalled.count, tid) != signalled.data + signalled.count)
+                return;
+            if (!signalled.push(tid))
+            {
+                everyoneStopped = false;
+                return;
+            }
+            if (syscall(SYS_tgkill, pid, tid, mt_stop_signal()) == 0)
+                added = true;
+            else
+                --signalled.count; });
+        if (!listed)
+            everyoneStopped = false;
+
+        const uint64_t deadline = mt_monotonic_ns() + 2000000000ull;
+        while (g_mt_stop_parked.load(std::memory_order_acquire) < signalled.count)
+        {
+            if (mt_monotonic_ns() > deadline)
+            {
+                everyoneStopped = false;
+                break;
+            }
+            mt_pause_us(50);
+        }
+    }
+    stopped = g_mt_stop_parked.load(std::memory_order_acquire);
+    if (g_mt_stop_claimed.load(std::memory_order_relaxed) > kMaxStopped)
+        everyoneStopped = false;
+
+    // Raíces: segmentos escribibles y pilas
+    ScanArray<MtRange> maps;
+    const bool mapped = mt_read_maps(maps);
+    const uintptr_t span = mt_stack_span();
+    auto addStack = [&](uintptr_t sp)
+    {
+        const MtRange *region = mt_find_readable(maps, sp, sp + 1);
+        if (!region)
+            return;
+        segments.push({sp, std::min(region->end, sp + span)});
+    };
+
+    if (mapped)
+    {
+        const unsigned slots = std::min(g_mt_stop_claimed.load(std::memory_order_relaxed), kMaxStopped);
+        for (unsigned i = 0; i < slots; ++i)
+        {
+            if (const uintptr_t sp = g_mt_stopped_sp[i].load(std::memory_order_relaxed))
+                addStack(sp);
+        }
+        addStack(reinterpret_cast<uintptr_t>(&caller));
+
+        // Raíces en 64 KB: reparten mejor un .bss grande
+        constexpr uintptr_t kItem = 64u << 10;
+        ScanArray<MtRange> items;
+        for (size_t i = 0; i < segments.count; ++i)
+        {
+            const MtRange root = segments.data[i];
+            if (!mt_find_readable(maps, root.begin, root.end))
+                continue;
+            for (uintptr_t at = root.begin; at < root.end; at += kItem)
+                items.push({at, std::min(root.end, at + kItem)});
+        }
+
+        // Bloques liberados y desmapeados después de la foto
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!mt_find_readable(maps, blocks[i].start, std::max(blocks[i].end, blocks[i].start + 1)))
+                marks[i].store(Gone, std::memory_order_relaxed);
+        }
+
+        pool.mark(items.data, items.count);
+        classifyLost();
+    }
+
+    // Reanudar y esperar a que todos salgan del manejador
+    g_mt_stop_resume.store(true, std::memory_order_release);
+    const uint64_t deadline = mt_monotonic_ns() + 2000000000ull;
+    while (g_mt_stop_left.load(std::memory_order_acquire) < g_mt_stop_parked.load(std::memory_order_acquire) &&
+           mt_monotonic_ns() < deadline)
+        mt_pause_us(50);
+    // Con alguna señal aún pendiente el manejador se queda: la acción por
+    // defecto de una señal de tiempo real termina el proceso
+    if (g_mt_stop_left.load(std::memory_order_acquire) == signalled.count)
+        sigaction(mt_stop_signal(), &previous, nullptr);
+
+    if (!mapped)
+        return false;
+
+    for (size_t i = 0; i < count; ++i)
+        recordStates[blocks[i].record] = marks[i].load(std::memory_order_relaxed);
+    return true;
+#endif
+}
@@ -0,0 +1,27 @@
+#include "LifetimeTable.h"
+
+//==================================================
+// Registro
+//==================================================
+void LifetimeTable::record(uint32_t siteId, int64_t lifetimeNs, uint64_t countFx) noexcept
+{
+    Histogram *h = histograms.get(siteId);
+    if (!h)
+        return;
+    const uint64_t ns = lifetimeNs > 0 ? static_cast<uint64_t>(lifetimeNs) : 0;
+    h->counts[Scale::bucketOf(ns)].fetch_add(countFx, std::memory_order_relaxed);
+}
+
+//==================================================
+// Lectura
+//==================================================
+bool LifetimeTable::snapshot(uint32_t siteId, uint64_t (&out)[kBucketCount]) const noexcept
+{
+    const Histogram *h = histograms.find(siteId);
+    if (!h)
+        return false;
+
+    for (unsigned b = 0; b < kBucketCount; ++b)
+        out[b] = h->counts[b].load(std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,475 @@
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "MemoryTracker.h"
+
+//==================================================
+// Interposición de la API de asignación de C
+//==================================================
+// Solo entra en libmemoryprofiler_preload.so (Linux). Con
+//   LD_PRELOAD=libmemoryprofiler_preload.so ./programa
+// malloc/calloc/realloc/free/aligned_alloc/posix_memalign/memalign del
+// proceso pasan por aquí antes de llegar a la libc. Sin los operadores de
+// MemoryOperators.cpp: new/delete de libstdc++ terminan en malloc/free y se
+// ven igual.
+//
+// Arranque: las funciones reales se resuelven con dlsym(RTLD_NEXT), que
+// puede a su vez pedir memoria (glibc reserva el buffer de dlerror con
+// calloc). Mientras el hilo está resolviendo se sirve desde un arena
+// estático; esos bloques nunca llegan a la libc.
+//
+// Configuración por variables de entorno (todas opcionales):
+//   MT_SAMPLE_BYTES=n   muestreo con intervalo medio de n bytes
+//   MT_STACK_DEPTH=n    captura de pilas de hasta n frames
+//   MT_SYMBOLIZE=1      simbolización en segundo plano (implica pilas)
+//   MT_BUFFERED=1       modo con buffers por hilo
+//   MT_REMOTE=host:port reporte remoto a la GUI
+//   MT_REPORT_MS=n      período de los mensajes periódicos a la GUI (1000)
+//   MT_REPORT_AT_EXIT=0 no imprimir el reporte de fugas al salir
+//   MT_REPORT_FILE=ruta reporte de salida a un archivo (%p = pid) en vez de stderr
+//   MT_ENABLED=0        no construir el tracker: solo se reenvía a la libc
+//
+// El stdout es del programa: nada de lo que escribe el interposer pasa por
+// ahí (rompería $(cmd) y los pipes).
+
+#define MT_EXPORT extern "C" __attribute__((visibility("default")))
+#define MT_ALWAYS_INLINE inline __attribute__((always_inline))
+
+using MallocFn = void *(*)(size_t);
+using CallocFn = void *(*)(size_t, size_t);
+using ReallocFn = void *(*)(void *, size_t);
+using FreeFn = void (*)(void *);
+using AlignedAllocFn = void *(*)(size_t, size_t);
+using PosixMemalignFn = int (*)(void **, size_t, size_t);
+
+static std::atomic<MallocFn> g_mt_real_malloc{nullptr};
+static std::atomic<CallocFn> g_mt_real_calloc{nullptr};
+static std::atomic<ReallocFn> g_mt_real_realloc{nullptr};
+static std::atomic<FreeFn> g_mt_real_free{nullptr};
+static std::atomic<AlignedAllocFn> g_mt_real_aligned_alloc{nullptr};
+static std::atomic<PosixMemalignFn> g_mt_real_posix_memalign{nullptr};
+static std::atomic<AlignedAllocFn> g_mt_real_memalign{nullptr};
+
+// Se activa al terminar mt_preload_init(): antes de eso ni el tracker ni la
+// configuración existen y las asignaciones pasan sin registrar.
+static std::atomic<bool> g_mt_preload_ready{false};
+
+// Destino del reporte de salida, abierto en mt_preload_init(): stderr
+// duplicado o MT_REPORT_FILE. Duplicado porque hay programas (ls, cat...)
+// que cierran stdout y stderr en su atexit, antes que nuestro destructor.
+static std::atomic<int> g_mt_report_fd{-1};
+static pid_t g_mt_report_pid = 0;
+
+static thread_local bool g_mt_resolving = false;
+static thread_local bool g_mt_in_hook = false;
+static thread_local int64_t g_mt_sample_countdown = 0;
+
+//==================================================
+// Arena de arranque
+//==================================================
+// Bump allocator sobre memoria estática (ya en cero, y nunca se reutiliza:
+// sirve también para calloc). Cada bloque guarda su tamaño justo antes del
+// payload para poder moverlo en realloc.
+static constexpr size_t kMtBootstrapBytes = 64 * 1024;
+alignas(64) static unsigned char g_mt_bootstrap[kMtBootstrapBytes];
+static std::atomic<size_t> g_mt_bootstrap_used{0};
+
+static void *mt_bootstrap_alloc(size_t size, size_t alignment) noexcept
+{
+    if (alignment < 2 * sizeof(void *))
+        alignment = 2 * sizeof(void *);
+    if (size > kMtBootstrapBytes || alignment > kMtBootstrapBytes)
+        return nullptr;
+
+    const uintptr_t base = reinterpret_cast<uintptr_t>(g_mt_bootstrap);
+    size_t used = g_mt_bootstrap_used.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        const uintptr_t payload = (base + used + sizeof(size_t) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+        const size_t end = static_cast<size_t>(payload - base) + size;
+        if (end > kMtBootstrapBytes)
+            return nullptr;
+        if (g_mt_bootstrap_used.compare_exchange_weak(used, end, std::memory_order_relaxed))
+        {
+            reinterpret_cast<size_t *>(payload)[-1] = size;
+            return reinterpret_cast<void *>(payload);
+        }
+    }
+}
+
+static inline bool mt_is_bootstrap(const void *ptr) noexcept
+{
+    const unsigned char *p = static_cast<const unsigned char *>(ptr);
+    return p >= g_mt_bootstrap && p < g_mt_bootstrap + kMtBootstrapBytes;
+}
+
+static inline size_t mt_bootstrap_size(const void *ptr) noexcept
+{
+    return static_cast<const size_t *>(ptr)[-1];
+}
+
+//==================================================
+// Resolución de la libc
+//==================================================
+template <typename Fn>
+static void mt_resolve_one(std::atomic<Fn> &slot, const char *name) noexcept
+{
+    slot.store(reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name)), std::memory_order_release);
+}
+
+// free se publica al final y hace de bandera de "todo resuelto". Varios hilos
+// pueden resolver a la vez: todos escriben los mismos punteros.
+static bool mt_resolve_real() noexcept
+{
+    if (g_mt_real_free.load(std::memory_order_acquire))
+        return true;
+    if (g_mt_resolving)
+        return false;
+
+    g_mt_resolving = true;
+    mt_resolve_one(g_mt_real_malloc, "malloc");
+    mt_resolve_one(g_mt_real_calloc, "calloc");
+    mt_resolve_one(g_mt_real_realloc, "realloc");
+    mt_resolve_one(g_mt_real_aligned_alloc, "aligned_alloc");
+    mt_resolve_one(g_mt_real_posix_memalign, "posix_memalign");
+    mt_resolve_one(g_mt_real_memalign, "memalign");
+    mt_resolve_one(g_mt_real_free, "free");
+    g_mt_resolving = false;
+
+    return g_mt_real_free.load(std::memory_order_acquire) != nullptr;
+}
+
+// nullptr mientras este hilo está dentro de dlsym: usar el arena
+template <typename Fn>
+static MT_ALWAYS_INLINE Fn mt_real(const std::atomic<Fn> &slot) noexcept
+{
+    Fn fn = slot.load(std::memory_order_acquire);
+    if (!fn && mt_resolve_real())
+        fn = slot.load(std::memory_order_acquire);
+    return fn;
+}
+
+//==================================================
+// Registro en el tracker
+//==================================================
+// Mismo criterio que los operadores, con su propia cuenta regresiva
+static inline bool mt_skip_unsampled(size_t size) noexcept
+{
+    if (!MemoryTracker::isSampling())
+        return false;
+
+    g_mt_sample_countdown -= static_cast<int64_t>(size);
+    if (g_mt_sample_countdown > 0)
+        return true;
+
+    return !MemoryTracker::sampleCountdownExpired(g_mt_sample_countdown);
+}
+
+// Siempre inline: registerAllocation() salta su frame y el del hook, así la
+// pila capturada empieza en quien llamó a malloc.
+static MT_ALWAYS_INLINE void mt_track(void *ptr, size_t size, const char *type) noexcept
+{
+    // Con MT_ENABLED=0 nunca queda listo: un solo branch
+    if (!g_mt_preload_ready.load(std::memory_order_acquire) || !ptr || g_mt_in_hook)
+        return;
+    if (!MemoryTracker::isEnabled())
+        return;
+    if (mt_skip_unsampled(size))
+        return;
+
+    g_mt_in_hook = true;
+    if (MemoryTracker::isAlive())
+    {
+        MemoryTracker &tracker = MemoryTracker::getInstance();
+        tracker.registerAllocation(ptr, size, "unknown", 0, type, false,
+                                   tracker.isBufferedMode() ? MemoryTracker::kUsableDeferred : malloc_usable_size(ptr));
+    }
+    g_mt_in_hook = false;
+}
+
+static MT_ALWAYS_INLINE void mt_untrack(void *ptr) noexcept
+{
+    if (!g_mt_preload_ready.load(std::memory_order_acquire) || !ptr || g_mt_in_hook)
+        return;
+
+    g_mt_in_hook = true;
+    if (MemoryTracker::isAlive())
+        MemoryTracker::getInstance().unregisterAllocation(ptr);
+    g_mt_in_hook = false;
+}
+
+//==================================================
+// API interpuesta
+//==================================================
+MT_EXPORT void *malloc(size_t size) noexcept
+{
+    MallocFn real = mt_real(g_mt_real_malloc);
+    if (!real)
+        return mt_bootstrap_alloc(size, 0);
+
+    void *ptr = real(size);
+    mt_track(ptr, size, "malloc");
+    return ptr;
+}
+
+MT_EXPORT void *calloc(size_t count, size_t size) noexcept
+{
+    if (size && count > SIZE_MAX / size)
+    {
+        errno = ENOMEM;
+        return nullptr;
+    }
+
+    CallocFn real = mt_real(g_mt_real_calloc);
+    if (!real)
+        return mt_bootstrap_alloc(count * size, 0);
+
+    void *ptr = real(count, size);
+    mt_track(ptr, count * size, "calloc");
+    return ptr;
+}
+
+MT_EXPORT void *realloc(void *ptr, size_t size) noexcept
+{
+    ReallocFn real = mt_real(g_mt_real_realloc);
+
+    // Los bloques del arena no los conoce la libc: se copian a uno nuevo
+    if (!real || mt_is_bootstrap(ptr))
+    {
+        void *moved = real ? malloc(size) : mt_bootstrap_alloc(size, 0);
+        if (moved && ptr)
+        {
+            const size_t old = mt_bootstrap_size(ptr);
+            std::memcpy(moved, ptr, old < size ? old : size);
+        }
+        return moved;
+    }
+
+    // Se desregistra antes: después del realloc la dirección vieja ya puede
+    // ser de otro hilo.
+    mt_untrack(ptr);
+    void *moved = real(ptr, size);
+    // Si falla, el bloque viejo sigue siendo del llamador: se registra de
+    // nuevo. El tamaño pedido ya no se conoce, queda el utilizable.
+    if (!moved && size)
+        mt_track(ptr, malloc_usable_size(ptr), "realloc");
+    else
+        mt_track(moved, size, "realloc");
+    return moved;
+}
+
+MT_EXPORT void free(void *ptr) noexcept
+{
+    if (!ptr || mt_is_bootstrap(ptr))
+        return;
+
+    mt_untrack(ptr);
+    if (FreeFn real = mt_real(g_mt_real_free))
+        real(ptr);
+}
+
+MT_EXPORT void *aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    AlignedAllocFn real = mt_real(g_mt_real_aligned_alloc);
+    if (!real)
+        return mt_bootstrap_alloc(size, alignment);
+
+    void *ptr = real(alignment, size);
+    mt_track(ptr, size, "aligned_alloc");
+    return ptr;
+}
+
+MT_EXPORT void *memalign(size_t alignment, size_t size) noexcept
+{
+    AlignedAllocFn real = mt_real(g_mt_real_memalign);
+    if (!real)
+        return mt_bootstrap_alloc(size, alignment);
+
+    void *ptr = real(alignment, size);
+    mt_track(ptr, size, "memalign");
+    return ptr;
+}
+
+MT_EXPORT int posix_memalign(void **out, size_t alignment, size_t size) noexcept
+{
+    PosixMemalignFn real = mt_real(g_mt_real_posix_memalign);
+    if (!real)
+    {
+        if (alignment < sizeof(void *) || (alignment & (alignment - 1)))
+            return EINVAL;
+        void *ptr = mt_bootstrap_alloc(size, alignment);
+        if (!ptr)
+            return ENOMEM;
+        *out = ptr;
+        return 0;
+    }
+
+    const int rc = real(out, alignment, size);
+    if (rc == 0)
+        mt_track(*out, size, "posix_memalign");
+    return rc;
+}
+
+//==================================================
+// Arranque / salida del proceso
+//==================================================
+static bool mt_env_flag(const char *name, bool fallback) noexcept
+{
+    const char *value = std::getenv(name);
+    if (!value || !*value)
+        return fallback;
+    return std::strcmp(value, "0") != 0;
+}
+
+static unsigned long mt_env_number(const char *name) noexcept
+{
+    const char *value = std::getenv(name);
+    return value ? std::strtoul(value, nullptr, 10) : 0;
+}
+
+// Corre en el hilo de presupuestos del tracker
+static void mt_print_budget_alert(const MemoryTracker::BudgetAlert &alert)
+{
+    std::fprintf(stderr, "[MemoryTracker] Memory budget exceeded: %zu of %zu bytes live\n", alert.liveBytes, alert.limitBytes);
+    for (const auto &site : alert.topSites)
+        std::fprintf(stderr, "  %s:%d | %zu bytes in %zu blocks\n", site.file.c_str(), site.line, site.liveMemory, site.liveCount);
+}
+
+static int mt_open_report_fd() noexcept
+{
+    const char *path = std::getenv("MT_REPORT_FILE");
+    if (path && *path)
+    {
+        std::string name;
+        for (const char *c = path; *c; ++c)
+        {
+            if (c[0] == '%' && c[1] == 'p')
+            {
+                name += std::to_string(static_cast<long>(::getpid()));
+                ++c;
+            }
+            else
+            {
+                name += *c;
+            }
+        }
+        const int fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd >= 0)
+            return fd;
+        std::fprintf(stderr, "[MemoryTracker] cannot open MT_REPORT_FILE %s: %s; reporting to stderr\n",
+                     name.c_str(), std::strerror(errno));
+    }
+    return ::fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 3);
+}
+
+static void mt_write_all(int fd, std::string_view text) noexcept
+{
+    size_t written = 0;
+    while (written < text.size())
+    {
+        const ssize_t n = ::write(fd, text.data() + written, text.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        written += static_cast<size_t>(n);
+    }
+}
+
+__attribute__((constructor)) static void mt_preload_init()
+{
+    if (!mt_resolve_real() || !MemoryTracker::resolveEnabled())
+        return;
+
+    // Lo que el tracker asigne mientras se configura no se registra
+    g_mt_in_hook = true;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    if (mt_env_flag("MT_REPORT_AT_EXIT", true))
+    {
+        g_mt_report_pid = ::getpid();
+        g_mt_report_fd.store(mt_open_report_fd(), std::memory_order_release);
+    }
+
+    if (const unsigned long bytes = mt_env_number("MT_SAMPLE_BYTES"))
+        tracker.enableSampling(bytes);
+
+    const bool symbolize = mt_env_flag("MT_SYMBOLIZE", false);
+    unsigned long depth = mt_env_number("MT_STACK_DEPTH");
+    if (symbolize && depth == 0)
+        depth = 16;
+    if (depth)
+        tracker.enableStackCapture(static_cast<unsigned>(depth));
+    if (symbolize)
+        tracker.enableSymbolization();
+
+    if (mt_env_flag("MT_BUFFERED", false))
+        tracker.enableBufferedMode();
+    if (mt_env_flag("MT_LEAK_SCAN", false))
+        tracker.setLeakScanOnReport(true);
+    if (const unsigned long bytes = mt_env_number("MT_BUDGET_BYTES"))
+        tracker.setMemoryBudget(bytes, mt_print_budget_alert);
+
+    if (const unsigned long ms = mt_env_number("MT_REPORT_MS"))
+    {
+        const std::chrono::milliseconds period(ms);
+        tracker.setReportPeriods({period, period, period});
+    }
+    if (const char *remote = std::getenv("MT_REMOTE"))
+    {
+        const char *colon = std::strrchr(remote, ':');
+        if (colon && colon != remote)
+        {
+            const std::string host(remote, colon);
+            tracker.enableRemoteReporting(host.c_str(), static_cast<uint16_t>(std::strtoul(colon + 1, nullptr, 10)));
+        }
+        else
+        {
+            tracker.enableRemoteReporting(remote);
+        }
+    }
+
+    g_mt_in_hook = false;
+    g_mt_preload_ready.store(true, std::memory_order_release);
+}
+
+// Un hijo de fork() (o de vfork(), que comparte la memoria del padre) no
+// reporta: el reporte es del proceso que cargó la biblioteca.
+static void mt_report_at_exit() noexcept
+{
+    if (!g_mt_preload_ready.load(std::memory_order_acquire) || ::getpid() != g_mt_report_pid)
+        return;
+    const int fd = g_mt_report_fd.exchange(-1, std::memory_order_acq_rel);
+    if (fd < 0)
+        return;
+
+    g_mt_in_hook = true;
+    {
+        // Del SlabArena, como todo lo que arma el tracker
+        std::basic_ostringstream<char, std::char_traits<char>, SlabAllocator<char>> report;
+        report << "[MemoryTracker] " << program_invocation_short_name << " (pid " << ::getpid() << ")\n";
+        MemoryTracker::getInstance().reportLeaks(report);
+        const auto text = report.str();
+        mt_write_all(fd, std::string_view(text.data(), text.size()));
+    }
+    ::close(fd);
+    g_mt_in_hook = false;
+}
+
+// Solo desde el destructor: armar el reporte pide memoria y toma locks, así
+// que no puede correr en _exit() (se llama tras fork() y desde señales). Los
+// programas que terminan con _exit(), como dash, salen sin reporte.
+__attribute__((destructor)) static void mt_preload_fini()
+{
+    mt_report_at_exit();
+}
@@ -1,151 +1,488 @@
 ﻿#include <cstddef>
 #include <cstdlib>
+#include <cstdint>
 #include <new>
 #include "MemoryTracker.h"
+#include "BlockHeader.h"
+#include "TrackedNew.h"
 
-static thread_local bool g_in_op_new = false;
+#if defined(_MSC_VER)
+#include <malloc.h>
+#define MT_FORCEINLINE __forceinline
+#else
+#define MT_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+#if defined(__linux__)
+#include <malloc.h>
+#endif
+
+// MT_DISABLED: los operadores quedan en malloc/free, sin cabecera ni registro
+#if defined(MT_DISABLED)
+#undef MT_INLINE_HEADERS
+#endif
 
 // Declaración para forzar link de este TU desde el test
 void force_link_memory_operators() {}
 
+#if !defined(MT_DISABLED)
+static thread_local bool g_in_op_new = false;
+static thread_local int64_t g_mt_sample_countdown = 0;
+
 static inline void maybe_init_tracker() {
     // Si está construyéndose, NO inicializar ni tocar el tracker
     if (MemoryTracker::isInitializing()) return;
 
-    // Si aún no está vivo y no está construyéndose, inicializarlo
-    if (!MemoryTracker::isAlive()) {
+    // Si aún no está vivo y no está construyéndose, inicializarlo (salvo que
+    // MT_ENABLED=0 lo apague)
+    if (!MemoryTracker::isAlive() && MemoryTracker::resolveEnabled()) {
         (void)MemoryTracker::getInstance();
     }
 }
 
+// Con muestreo activo, una asignación no elegida solo paga este decremento
+static inline bool mt_skip_unsampled(std::size_t size) noexcept {
+    if (!MemoryTracker::isSampling()) return false;
+
+    g_mt_sample_countdown -= static_cast<int64_t>(size);
+    if (g_mt_sample_countdown > 0) return true;
+
+    return !MemoryTracker::sampleCountdownExpired(g_mt_sample_countdown);
+}
+
+// Tamaño usable del bloque que entregó malloc, para la holgura. Solo se
+// pregunta aquí, donde el puntero seguro salió de malloc. Fuera de Linux 0.
+static inline std::size_t mt_usable_size(void* base) noexcept {
+#if defined(__linux__)
+    return malloc_usable_size(base);
+#else
+    (void)base;
+    return 0;
+#endif
+}
+#endif
+
 //-----------------------------
-// new con file/line (opcional)
+// Registro compartido
 //-----------------------------
-void* operator new(std::size_t size, const char* file, int line) {
-    void* ptr = std::malloc(size);
-    if (!ptr) throw std::bad_alloc();
+// Siempre inline: registerAllocation() salta su propio frame y el del
+// operador, así que no puede haber un frame intermedio.
+static MT_FORCEINLINE void mt_track_new(void* ptr, std::size_t size, const char* file, int line,
+                                        const char* type, bool aligned) {
+#if defined(MT_DISABLED)
+    (void)ptr; (void)size; (void)file; (void)line; (void)type; (void)aligned;
+#else
+    // Con el interruptor apagado esta es toda la sobrecarga
+    if (!MemoryTracker::isEnabled()) return;
 
-    if (!g_in_op_new) {
+    if (!g_in_op_new && !mt_skip_unsampled(size)) {
         g_in_op_new = true;
 
         if (!MemoryTracker::isInitializing()) {
             maybe_init_tracker();
             if (MemoryTracker::isAlive()) {
-                MemoryTracker::getInstance().registerAllocation(ptr, size, file, line, "unknown");
+#if defined(MT_INLINE_HEADERS)
+                BlockHeader* block = BlockHeader::of(ptr);
+                MemoryTracker::getInstance().registerBlock(block, size, file, line, type, aligned, mt_usable_size(block->base()));
+#else
+                // En modo buffered ni se mide: el agregador estima la holgura
+                MemoryTracker& tracker = MemoryTracker::getInstance();
+                tracker.registerAllocation(ptr, size, file, line, type, aligned,
+                                           tracker.isBufferedMode() ? MemoryTracker::kUsableDeferred : mt_usable_size(ptr));
+#endif
             }
         }
 
         g_in_op_new = false;
     }
+#endif
+}
+
+// size: el que pasa el compilador en los delete sized, 0 si no lo pasó
+static MT_FORCEINLINE void mt_track_delete(void* ptr, std::size_t size, bool aligned) noexcept {
+#if defined(MT_DISABLED)
+    (void)ptr; (void)size; (void)aligned;
+#elif defined(MT_INLINE_HEADERS)
+    // La cabecera dice si el bloque está registrado: sin búsqueda y sin
+    // depender de los guards (un bloque enlazado siempre debe desenlazarse)
+    BlockHeader* block = BlockHeader::of(ptr);
+    if (block->flags & BlockHeader::kLinked) {
+        const bool prev = g_in_op_new;
+        g_in_op_new = true;
+        MemoryTracker::getInstance().unregisterBlock(block, size, aligned);
+        g_in_op_new = prev;
+    }
+#else
+    // isAlive() primero: si el tracker nunca arrancó, un solo branch
+    if (MemoryTracker::isAlive() && !g_in_op_new && !MemoryTracker::isInitializing()) {
+        g_in_op_new = true;
+        MemoryTracker::getInstance().unregisterAllocation(ptr, size, aligned);
+        g_in_op_new = false;
+    }
+#endif
+}
+
+//-----------------------------
+// Memoria sobrealineada
+//-----------------------------
+// malloc solo garantiza alignof(std::max_align_t). En Windows los bloques de
+// _aligned_malloc deben liberarse con _aligned_free, por eso los delete
+// alineados no pueden caer en free().
+static inline void* mt_aligned_malloc(std::size_t size, std::align_val_t alignment) noexcept {
+    const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    void* ptr = nullptr;
+    const std::size_t minAlign = sizeof(void*);
+    if (posix_memalign(&ptr, align < minAlign ? minAlign : align, size ? size : 1) != 0) return nullptr;
     return ptr;
+#endif
+}
+
+static inline void mt_aligned_free(void* ptr) noexcept {
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
 }
 
 //-----------------------------
-// new/delete estándar
+// Reserva cruda
 //-----------------------------
-void* operator new(std::size_t size) {
-    void* ptr = std::malloc(size);
+// Devuelven/reciben el puntero del usuario. Con MT_INLINE_HEADERS el bloque
+// real empieza baseOffset bytes antes y la cabecera ocupa el final de ese
+// hueco; liberar mira la cabecera, así que un delete de la forma equivocada
+// igual devuelve el bloque con la función correcta.
+#if defined(MT_INLINE_HEADERS)
+static inline void* mt_init_header(void* base, std::size_t offset, bool aligned) noexcept {
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(static_cast<unsigned char*>(base) + offset - sizeof(BlockHeader));
+    block->flags = aligned ? AllocationInfo::kAligned : 0;
+    block->baseOffset = static_cast<uint32_t>(offset);
+    return block->user();
+}
+#endif
+
+static inline void* mt_raw_malloc(std::size_t size) noexcept {
+#if defined(MT_INLINE_HEADERS)
+    if (size > SIZE_MAX - sizeof(BlockHeader)) return nullptr;
+    void* base = std::malloc(size + sizeof(BlockHeader));
+    return base ? mt_init_header(base, sizeof(BlockHeader), false) : nullptr;
+#else
+    return std::malloc(size);
+#endif
+}
+
+static inline void* mt_raw_aligned_malloc(std::size_t size, std::align_val_t alignment) noexcept {
+#if defined(MT_INLINE_HEADERS)
+    // La cabecera se redondea a la alineación pedida para que el payload la conserve
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    const std::size_t offset = (sizeof(BlockHeader) + align - 1) & ~(align - 1);
+    if (offset > UINT32_MAX || size > SIZE_MAX - offset) return nullptr;
+    void* base = mt_aligned_malloc(size + offset, alignment);
+    return base ? mt_init_header(base, offset, true) : nullptr;
+#else
+    return mt_aligned_malloc(size, alignment);
+#endif
+}
+
+static inline void mt_raw_free(void* ptr) noexcept {
+#if defined(MT_INLINE_HEADERS)
+    BlockHeader* block = BlockHeader::of(ptr);
+    if (block->flags & AllocationInfo::kAligned) mt_aligned_free(block->base());
+    else std::free(block->base());
+#else
+    std::free(ptr);
+#endif
+}
+
+static inline void mt_raw_aligned_free(void* ptr) noexcept {
+#if defined(MT_INLINE_HEADERS)
+    mt_raw_free(ptr);
+#else
+    mt_aligned_free(ptr);
+#endif
+}
+
+//-----------------------------
+// new con file/line (opcional)
+//-----------------------------
+void* operator new(std::size_t size, const char* file, int line) {
+    void* ptr = mt_raw_malloc(size);
     if (!ptr) throw std::bad_alloc();
 
-    if (!g_in_op_new) {
-        g_in_op_new = true;
+    mt_track_new(ptr, size, file, line, "unknown", false);
+    return ptr;
+}
 
-        if (!MemoryTracker::isInitializing()) {
-            maybe_init_tracker();
-            if (MemoryTracker::isAlive()) {
-                MemoryTracker::getInstance().registerAllocation(ptr, size, "unknown", 0, "unknown");
-            }
-        }
+void* operator new[](std::size_t size, const char* file, int line) {
+    void* ptr = mt_raw_malloc(size);
+    if (!ptr) throw std::bad_alloc();
 
-        g_in_op_new = false;
+    mt_track_new(ptr, size, file, line, "unknown[]", false);
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const char* file, int line) {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
+
+    mt_track_new(ptr, size, file, line, "aligned", true);
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const char* file, int line) {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
+
+    mt_track_new(ptr, size, file, line, "aligned[]", true);
+    return ptr;
+}
+
+// Placement delete: solo se llaman si el constructor lanza una excepción
+void operator delete(void* ptr, const char*, int) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, const char*, int) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
     }
+}
+
+void operator delete(void* ptr, std::align_val_t, const char*, int) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::align_val_t, const char*, int) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+//-----------------------------
+// new con file/line y tipo (MT_NEW, TrackingAllocator)
+//-----------------------------
+// Mismo cuerpo que las de arriba: registerAllocation() cuenta con un solo
+// frame de operador por encima.
+void* operator new(std::size_t size, const char* file, int line, const char* type) {
+    void* ptr = mt_raw_malloc(size);
+    if (!ptr) throw std::bad_alloc();
+
+    mt_track_new(ptr, size, file, line, type, false);
     return ptr;
 }
 
-void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
-    void* ptr = std::malloc(size);
+void* operator new[](std::size_t size, const char* file, int line, const char* type) {
+    void* ptr = mt_raw_malloc(size);
+    if (!ptr) throw std::bad_alloc();
 
-    if (ptr && !g_in_op_new) {
-        g_in_op_new = true;
+    mt_track_new(ptr, size, file, line, type, false);
+    return ptr;
+}
 
-        if (!MemoryTracker::isInitializing()) {
-            maybe_init_tracker();
-            if (MemoryTracker::isAlive()) {
-                MemoryTracker::getInstance().registerAllocation(ptr, size, "unknown", 0, "unknown");
-            }
-        }
+void* operator new(std::size_t size, std::align_val_t alignment, const char* file, int line, const char* type) {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
 
-        g_in_op_new = false;
+    mt_track_new(ptr, size, file, line, type, true);
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const char* file, int line, const char* type) {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
+
+    mt_track_new(ptr, size, file, line, type, true);
+    return ptr;
+}
+
+void operator delete(void* ptr, const char*, int, const char*) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, const char*, int, const char*) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
+    }
+}
+
+void operator delete(void* ptr, std::align_val_t, const char*, int, const char*) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::align_val_t, const char*, int, const char*) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
     }
+}
+
+//-----------------------------
+// new/delete estándar
+//-----------------------------
+void* operator new(std::size_t size) {
+    void* ptr = mt_raw_malloc(size);
+    if (!ptr) throw std::bad_alloc();
+
+    mt_track_new(ptr, size, "unknown", 0, "unknown", false);
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    void* ptr = mt_raw_malloc(size);
+
+    if (ptr) mt_track_new(ptr, size, "unknown", 0, "unknown", false);
     return ptr;
 }
 
 void operator delete(void* ptr) noexcept {
     if (ptr) {
-        if (!g_in_op_new && MemoryTracker::isAlive() && !MemoryTracker::isInitializing()) {
-            g_in_op_new = true;
-            MemoryTracker::getInstance().unregisterAllocation(ptr);
-            g_in_op_new = false;
-        }
-        std::free(ptr);
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
     }
 }
 
 void operator delete(void* ptr, const std::nothrow_t&) noexcept {
     if (ptr) {
-        if (!g_in_op_new && MemoryTracker::isAlive() && !MemoryTracker::isInitializing()) {
-            g_in_op_new = true;
-            MemoryTracker::getInstance().unregisterAllocation(ptr);
-            g_in_op_new = false;
-        }
-        std::free(ptr);
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
+    }
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, size, false);
+        mt_raw_free(ptr);
     }
 }
 
 void* operator new[](std::size_t size) {
-    void* ptr = std::malloc(size);
+    void* ptr = mt_raw_malloc(size);
     if (!ptr) throw std::bad_alloc();
 
-    if (!g_in_op_new) {
-        g_in_op_new = true;
+    mt_track_new(ptr, size, "unknown", 0, "unknown[]", false);
+    return ptr;
+}
 
-        if (!MemoryTracker::isInitializing()) {
-            maybe_init_tracker();
-            if (MemoryTracker::isAlive()) {
-                MemoryTracker::getInstance().registerAllocation(ptr, size, "unknown", 0, "unknown[]");
-            }
-        }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    void* ptr = mt_raw_malloc(size);
 
-        g_in_op_new = false;
+    if (ptr) mt_track_new(ptr, size, "unknown", 0, "unknown[]", false);
+    return ptr;
+}
+
+void operator delete[](void* ptr) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, false);
+        mt_raw_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::size_t size) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, size, false);
+        mt_raw_free(ptr);
     }
+}
+
+//-----------------------------
+// new/delete alineados (C++17)
+//-----------------------------
+// Categoría propia ("aligned"/"aligned[]") y kAligned en el registro, para
+// que los buffers SIMD no se mezclen con el resto y para detectar un delete
+// sin alinear sobre un bloque alineado.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
+
+    mt_track_new(ptr, size, "unknown", 0, "aligned", true);
     return ptr;
 }
 
-void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
-    void* ptr = std::malloc(size);
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
 
-    if (ptr && !g_in_op_new) {
-        g_in_op_new = true;
+    if (ptr) mt_track_new(ptr, size, "unknown", 0, "aligned", true);
+    return ptr;
+}
 
-        if (!MemoryTracker::isInitializing()) {
-            maybe_init_tracker();
-            if (MemoryTracker::isAlive()) {
-                MemoryTracker::getInstance().registerAllocation(ptr, size, "unknown", 0, "unknown[]");
-            }
-        }
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
+    if (!ptr) throw std::bad_alloc();
 
-        g_in_op_new = false;
-    }
+    mt_track_new(ptr, size, "unknown", 0, "aligned[]", true);
     return ptr;
 }
 
-void operator delete[](void* ptr) noexcept {
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    void* ptr = mt_raw_aligned_malloc(size, alignment);
+
+    if (ptr) mt_track_new(ptr, size, "unknown", 0, "aligned[]", true);
+    return ptr;
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
     if (ptr) {
-        if (!g_in_op_new && MemoryTracker::isAlive() && !MemoryTracker::isInitializing()) {
-            g_in_op_new = true;
-            MemoryTracker::getInstance().unregisterAllocation(ptr);
-            g_in_op_new = false;
-        }
-        std::free(ptr);
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+void operator delete(void* ptr, std::size_t size, std::align_val_t) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, size, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, 0, true);
+        mt_raw_aligned_free(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::size_t size, std::align_val_t) noexcept {
+    if (ptr) {
+        mt_track_delete(ptr, size, true);
+        mt_raw_aligned_free(ptr);
     }
 }
@@ -0,0 +1,33 @@
+#include "MemoryScope.h"
+#include "MemoryTracker.h"
+
+thread_local uint32_t MemoryScope::tag = 0;
+
+// Mientras se construye el tracker no se puede internar, y apagado no se
+// construye: el ámbito queda con el tag que ya tenía el hilo
+MemoryScope::MemoryScope(const char *name) : previous(tag)
+{
+    if (!MemoryTracker::isInitializing() && MemoryTracker::resolveEnabled())
+        setTag(MemoryTracker::getInstance().internTag(name));
+}
+
+MemoryScope::MemoryScope(std::string_view name) : previous(tag)
+{
+    if (!MemoryTracker::isInitializing() && MemoryTracker::resolveEnabled())
+        setTag(MemoryTracker::getInstance().internTag(name));
+}
+
+MemoryScope::~MemoryScope()
+{
+    setTag(previous);
+}
+
+// En modo buffered el agregador resuelve el tag de cada Alloc repitiendo
+// estos cambios en orden con los eventos del hilo
+void MemoryScope::setTag(uint32_t tagId) noexcept
+{
+    if (tag == tagId)
+        return;
+    tag = tagId;
+    MemoryTracker::scopeChanged(tagId);
+}
@@ -1,19 +1,42 @@
 ﻿#include "MemoryTracker.h"
+#include "LeakScanner.h"
 #include "MTDebug.h"
-#include "ServerClient.h"
-#include <QTimer>
 #include <iostream>
 #include <chrono>
 #include <utility>
 #include <sstream>
 #include <algorithm>
-#include <map>
+#include <unordered_map>
+#include <new>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 //==================================================
 // Anti-reentrada
 //==================================================
 static thread_local bool g_mt_in_tracker = false;
 
+// MemoryTracker::currentThreadId(); 0 = todavía sin asignar
+static thread_local uint32_t g_mt_thread_id = 0;
+
+// Los mensajes para la GUI se arman con memoria del SlabArena compartido
+using TrackerStream = std::basic_stringstream<char, std::char_traits<char>, SlabAllocator<char>>;
+using TrackerString = Symbolizer::String;
+template <typename T>
+using TrackerVector = Symbolizer::Vector<T>;
+
 struct ReentryGuard
 {
     bool prev;
@@ -21,44 +44,103 @@ struct ReentryGuard
     ~ReentryGuard() { g_mt_in_tracker = prev; }
 };
 
+// Texto libre (nombres de función, rutas) dentro de un mensaje '|'-separado
+static TrackerString mt_wire_field(std::string_view field)
+{
+    TrackerString text(field);
+    std::replace(text.begin(), text.end(), '|', ' ');
+    std::replace(text.begin(), text.end(), ';', ' ');
+    return text;
+}
+
+//==================================================
+// Buffer de eventos del hilo actual
+//==================================================
+// Al terminar el hilo se marca el buffer como retirado; el agregador lo
+// libera cuando ya lo vació. Si algo asigna después (otros destructores
+// thread_local), `dead` evita crear un buffer nuevo que nadie retiraría.
+struct ThreadBufferSlot
+{
+    ThreadEventBuffer *buffer = nullptr;
+    bool dead = false;
+    ~ThreadBufferSlot()
+    {
+        if (buffer)
+            buffer->retire();
+        buffer = nullptr;
+        dead = true;
+    }
+};
+
+static thread_local ThreadBufferSlot g_mt_event_slot;
+
+static_assert(StackTable::kMaxDepth <= ThreadEventBuffer::kMaxFrames,
+              "una pila capturada debe caber detrás de su evento");
+
+//==================================================
+// Generador aleatorio del muestreo (por hilo)
+//==================================================
+static thread_local uint64_t g_mt_sample_rng = 0;
+static thread_local bool g_mt_sampler_seeded = false;
+
+// Uniforme en (0, 1]; xorshift64* es suficiente para elegir puntos de muestreo
+static double mt_sample_uniform() noexcept
+{
+    uint64_t x = g_mt_sample_rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    g_mt_sample_rng = x;
+    return static_cast<double>(((x * 0x2545F4914F6CDD1Dull) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+// Bytes hasta la próxima muestra: exponencial de media 2^shift, que es la
+// versión continua de la geométrica sobre bytes que usa tcmalloc.
+static int64_t mt_next_sample_interval(unsigned shift) noexcept
+{
+    const double mean = std::ldexp(1.0, static_cast<int>(shift));
+    const double bytes = -std::log(mt_sample_uniform()) * mean;
+    return bytes < 1.0 ? 1 : static_cast<int64_t>(bytes);
+}
+
 //==================================================
 // Flags de estado del singleton
 //==================================================
 std::atomic<bool> MemoryTracker::alive{false};
 std::atomic<bool> MemoryTracker::initializing{false};
+std::atomic<unsigned> MemoryTracker::samplingShift{0};
+std::atomic<uint8_t> MemoryTracker::enabledState{kSwitchUnresolved};
 
 //==================================================
 // Constructor / Destructor
 //==================================================
 MemoryTracker::MemoryTracker()
 {
-    totalAllocations = 0;
-    activeAllocations = 0;
+    totalAllocationsFx = 0;
+    activeAllocationsFx = 0;
     currentMemory = 0;
     peakMemory = 0;
     totalLeakedMemory = 0;
-    socketClient = nullptr;
-    updateTimer = nullptr;
+
+    // Instante de pared que corresponde al sello 0
+    clockBaseWall = std::chrono::high_resolution_clock::now() -
+                    std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+                        std::chrono::nanoseconds(clock.toNs(clock.now())));
 }
 
 MemoryTracker::~MemoryTracker()
 {
-    // Enviar reporte final antes de destruir
+    disableBufferedMode();
+    disableSymbolization();
+    stopBudgets();
+
+    // Enviar reporte final antes de destruir: el reporter lo termina de escribir
     if (remoteEnabled)
     {
         sendLeakReport();
     }
-
-    if (updateTimer)
-    {
-        updateTimer->stop();
-        delete updateTimer;
-    }
-
-    if (socketClient)
-    {
-        delete socketClient;
-    }
+    stopReporter();
+    socketClient.disconnectFromServer();
 
     alive.store(false, std::memory_order_release);
 }
@@ -70,8 +152,6 @@ MemoryTracker &MemoryTracker::getInstance()
 {
     static MemoryTracker *p = []() -> MemoryTracker *
     {
-        std::printf("[MT] getInstance: constructing...\n");
-        std::fflush(stdout);
         initializing.store(true, std::memory_order_release);
 
         alignas(MemoryTracker) static unsigned char storage[sizeof(MemoryTracker)];
@@ -79,9 +159,6 @@ MemoryTracker &MemoryTracker::getInstance()
 
         alive.store(true, std::memory_order_release);
         initializing.store(false, std::memory_order_release);
-
-        std::printf("[MT] getInstance: constructed\n");
-        std::fflush(stdout);
         return inst;
     }();
     return *p;
@@ -97,150 +174,1972 @@ bool MemoryTracker::isInitializing() noexcept
     return initializing.load(std::memory_order_acquire);
 }
 
+//==================================================
+// Interruptor global
+//==================================================
+// Se llama desde dentro de operator new/malloc: getenv no pide memoria.
+bool MemoryTracker::resolveEnabled() noexcept
+{
+    uint8_t state = enabledState.load(std::memory_order_relaxed);
+    if (state == kSwitchUnresolved)
+    {
+        const char *value = std::getenv("MT_ENABLED");
+        const uint8_t fromEnv = value && std::strcmp(value, "0") == 0 ? kSwitchOff : kSwitchOn;
+        // Si setEnabled() se adelantó, gana lo que pidió la aplicación
+        if (enabledState.compare_exchange_strong(state, fromEnv, std::memory_order_relaxed))
+            state = fromEnv;
+    }
+    return state == kSwitchOn;
+}
+
+void MemoryTracker::setEnabled(bool enabled) noexcept
+{
+    enabledState.store(enabled ? kSwitchOn : kSwitchOff, std::memory_order_relaxed);
+}
+
+//==================================================
+// Fragmentación interna
+//==================================================
+// malloc entrega bloques redondeados a su clase de tamaño. La diferencia
+// entre lo usable y lo pedido la mide quien sabe que el bloque salió de
+// malloc (operadores, interposer) y queda en el registro: el free la resta
+// tal cual, sin volver a preguntarle nada a malloc.
+static uint32_t mt_slack(size_t usableSize, uint64_t requested) noexcept
+{
+    if (usableSize <= requested)
+        return 0;
+    return static_cast<uint32_t>(std::min<uint64_t>(usableSize - requested, AllocationInfo::kMaxSlack));
+}
+
+// En modo buffered nadie mide: cuando el agregador aplica el Alloc el
+// bloque puede estar ya liberado y preguntarle a malloc no es seguro. Se
+// repite el redondeo de los chunks de glibc en 64 bits (8 bytes de cabecera,
+// múltiplos de 16, mínimo 32); los bloques servidos con mmap redondean a
+// página y quedan subestimados. Con otro allocator la holgura queda en 0.
+static size_t mt_estimated_usable(size_t requested) noexcept
+{
+#if defined(__GLIBC__) && UINTPTR_MAX > 0xFFFFFFFFu
+    const size_t chunk = requested + 8 < 32 ? 32 : (requested + 8 + 15) & ~size_t(15);
+    return chunk - 8;
+#else
+    (void)requested;
+    return 0;
+#endif
+}
+
 //==================================================
 // Registro / Desregistro
 //==================================================
-void MemoryTracker::registerAllocation(void *ptr, size_t size, const char *file, int line, const char *type)
+void MemoryTracker::registerAllocation(void *ptr, size_t size, const char *file, int line, const char *type, bool aligned, size_t usableSize)
+{
+    if (!ptr)
+        return;
+    if (g_mt_in_tracker)
+        return;
+    ReentryGuard guard;
+
+    const uint64_t now = clock.now();
+
+    // Con muestreo activo, lo que llega aquí ya fue elegido por los operadores
+    const unsigned shift = samplingShift.load(std::memory_order_relaxed);
+    uint16_t flags = shift ? static_cast<uint16_t>(AllocationInfo::kSampled | (shift << AllocationInfo::kSampleShiftBit)) : 0;
+    if (aligned)
+        flags |= AllocationInfo::kAligned;
+
+    // La pila solo se puede leer aquí, en el hilo que asigna. Se saltan
+    // este frame y el del operador que nos llamó.
+    void *pcs[StackTable::kMaxDepth];
+    const unsigned depth = stackDepth.load(std::memory_order_relaxed);
+    const uint32_t frames = depth ? StackTable::capture(pcs, depth, 2) : 0;
+
+    // El productor solo copia lo que después ya no existe; hilo, tag, ID de
+    // pila y holgura estimada los resuelve el agregador al drenar.
+    if (bufferedMode.load(std::memory_order_relaxed))
+    {
+        AllocationEvent ev{ptr, size, file, type, now, line, AllocationEvent::Alloc, 0, flags, StackTable::kNoStack, 0, static_cast<uint16_t>(frames), 0, 0};
+        if (usableSize == kUsableDeferred)
+            ev.flags |= AllocationEvent::kEstimateSlack;
+        else
+            ev.slack = static_cast<uint16_t>(mt_slack(usableSize, size));
+        if (pushEvent(ev, pcs))
+            return;
+    }
+
+    if (usableSize == kUsableDeferred)
+        usableSize = mt_estimated_usable(size);
+    const uint32_t stackId = frames ? stacks.intern(pcs, frames) : StackTable::kNoStack;
+    applyAllocation(ptr, size, file, line, type, now, flags, stackId, mt_slack(usableSize, size), currentThreadId(), MemoryScope::current());
+}
+
+void MemoryTracker::unregisterAllocation(void *ptr)
+{
+    if (!ptr)
+        return;
+    if (g_mt_in_tracker)
+        return;
+    // Con muestreo, un free no muestreado termina aquí. En modo buffered
+    // el Alloc puede estar aún en un buffer: decide el agregador.
+    if (!bufferedMode.load(std::memory_order_relaxed) && !mayBeTracked(ptr))
+        return;
+    ReentryGuard guard;
+
+    const uint64_t now = clock.now();
+
+    if (bufferedMode.load(std::memory_order_relaxed))
+    {
+        AllocationEvent ev{ptr, 0, nullptr, nullptr, now, 0, AllocationEvent::Free, 0, 0, StackTable::kNoStack, 0, 0, 0, 0};
+        if (pushEvent(ev))
+            return;
+    }
+
+    applyFree(ptr, now, currentThreadId());
+}
+
+void MemoryTracker::unregisterAllocation(void *ptr, size_t size, bool aligned)
+{
+    if (!ptr)
+        return;
+    if (g_mt_in_tracker)
+        return;
+    if (!bufferedMode.load(std::memory_order_relaxed) && !mayBeTracked(ptr))
+        return;
+    ReentryGuard guard;
+
+    const uint64_t now = clock.now();
+    const uint16_t check = AllocationEvent::kCheckedFree | (aligned ? AllocationInfo::kAligned : 0);
+
+    if (bufferedMode.load(std::memory_order_relaxed))
+    {
+        AllocationEvent ev{ptr, size, nullptr, nullptr, now, 0, AllocationEvent::Free, 0, check, StackTable::kNoStack, 0, 0, 0, 0};
+        if (pushEvent(ev))
+            return;
+    }
+
+    applyFree(ptr, now, currentThreadId(), size, check);
+}
+
+//==================================================
+// Hilos
+//==================================================
+uint32_t MemoryTracker::currentThreadId()
+{
+    uint32_t id = g_mt_thread_id;
+    if (!id)
+    {
+        ReentryGuard guard;
+        id = g_mt_thread_id = registerThread();
+    }
+    return id;
+}
+
+// Una vez por hilo. El nombre puede cambiar después (se pone al arrancar el
+// hilo, a veces después de su primera asignación): getThreadSummaries() lo
+// vuelve a leer mientras el hilo exista.
+uint32_t MemoryTracker::registerThread()
+{
+    const uint32_t id = std::min(nextThreadId.fetch_add(1, std::memory_order_relaxed), AllocationInfo::kMaxThreadId);
+
+    ThreadRecord record{};
+    if (id < AllocationInfo::kMaxThreadId)
+    {
+#if defined(__linux__)
+        record.osThreadId = static_cast<uint64_t>(::syscall(SYS_gettid));
+        pthread_getname_np(pthread_self(), record.name, sizeof(record.name));
+#endif
+    }
+    else
+    {
+        std::snprintf(record.name, sizeof(record.name), "(more threads)");
+    }
+
+    std::lock_guard<std::mutex> lock(threadsMtx);
+    if (threadRecords.size() <= id)
+        threadRecords.resize(id + 1, ThreadRecord{});
+    if (id < AllocationInfo::kMaxThreadId || !threadRecords[id].name[0])
+        threadRecords[id] = record;
+    return id;
+}
+
+//==================================================
+// Tags por ámbito
+//==================================================
+uint32_t MemoryTracker::internTag(const char *name)
+{
+    if (!name || !*name)
+        return 0;
+    ReentryGuard guard;
+    // InternTable no toma su mutex para un puntero que ya vio
+    return tagOf(interned.internString(name));
+}
+
+uint32_t MemoryTracker::internTag(std::string_view name)
+{
+    if (name.empty())
+        return 0;
+    ReentryGuard guard;
+    return tagOf(interned.internText(name));
+}
+
+// Camino rápido sin tagsMtx: el texto ya tiene tag
+uint32_t MemoryTracker::tagOf(uint32_t stringId)
+{
+    std::atomic<uint32_t> *slot = tagOfString.get(stringId);
+    if (!slot)
+        return AllocationInfo::kMaxTagId;
+    if (const uint32_t tagId = slot->load(std::memory_order_acquire))
+        return tagId;
+
+    std::lock_guard<std::mutex> lock(tagsMtx);
+    uint32_t tagId = slot->load(std::memory_order_relaxed);
+    if (tagId)
+        return tagId;
+    if (tagNames.empty())
+        tagNames.push_back(InternTable::kUnknown); // tagId 0: fuera de todo ámbito
+    if (tagNames.size() < AllocationInfo::kMaxTagId)
+    {
+        tagId = static_cast<uint32_t>(tagNames.size());
+        tagNames.push_back(stringId);
+    }
+    else
+    {
+        tagId = AllocationInfo::kMaxTagId;
+        if (tagNames.size() == AllocationInfo::kMaxTagId)
+            tagNames.push_back(interned.internString("(more tags)"));
+    }
+    slot->store(tagId, std::memory_order_release);
+    return tagId;
+}
+
+std::string MemoryTracker::tagName(uint32_t tagId)
+{
+    if (tagId == 0)
+        return "(untagged)";
+    ReentryGuard guard;
+    std::lock_guard<std::mutex> lock(tagsMtx);
+    return tagId < tagNames.size() ? interned.string(tagNames[tagId]) : interned.string(InternTable::kUnknown);
+}
+
+//==================================================
+// Modo cabecera en línea
+//==================================================
+// El registro se escribe en la cabecera del propio bloque y se aplica
+// siempre en el hilo que asigna (sin modo buffered): enlazarlo en la lista
+// del shard es O(1) y el free ya no necesita buscar nada.
+void MemoryTracker::registerBlock(BlockHeader *block, size_t size, const char *file, int line, const char *type, bool aligned, size_t usableSize)
+{
+    if (!block)
+        return;
+    if (g_mt_in_tracker)
+        return;
+    ReentryGuard guard;
+
+    const unsigned shift = samplingShift.load(std::memory_order_relaxed);
+    uint16_t flags = shift ? static_cast<uint16_t>(AllocationInfo::kSampled | (shift << AllocationInfo::kSampleShiftBit)) : 0;
+    if (aligned)
+        flags |= AllocationInfo::kAligned;
+
+    // Mismo salto que registerAllocation(): este frame y el del operador
+    uint32_t stackId = StackTable::kNoStack;
+    if (const unsigned depth = stackDepth.load(std::memory_order_relaxed))
+    {
+        void *pcs[StackTable::kMaxDepth];
+        stackId = stacks.intern(pcs, StackTable::capture(pcs, depth, 2));
+    }
+
+    block->size = size;
+    block->flags = flags;
+    block->stamp = clock.now() & TscClock::kStampMask;
+    block->siteId = interned.internSite(file, line);
+    block->typeId = interned.internString(type);
+    block->stackId = stackId;
+    block->threadId = currentThreadId();
+    block->tagId = MemoryScope::current();
+    // La cabecera no cuenta como holgura: ya está en headerBytesFx
+    block->slack = mt_slack(usableSize, size + block->baseOffset);
+
+    const uint64_t headerFx = weightOf(size, flags).countFx * block->baseOffset;
+    allocations.link(block,
+                     [this, headerFx](const AllocationInfo &info)
+                     {
+                         accountAllocLocked(info);
+                         headerBytesFx.fetch_add(headerFx, std::memory_order_relaxed);
+                     });
+
+    if (remoteEnabled.load(std::memory_order_relaxed))
+    {
+        sendLiveUpdate(block->user(), size, true, file, line, type);
+    }
+}
+
+// No se salta dentro del tracker: un bloque enlazado tiene que salir de la
+// lista antes de volver a malloc, o la lista quedaría apuntando a memoria libre.
+void MemoryTracker::unregisterBlock(BlockHeader *block, size_t size, bool aligned)
+{
+    ReentryGuard guard;
+
+    const uint64_t freedAt = clock.now() & TscClock::kStampMask;
+    const uint16_t check = AllocationEvent::kCheckedFree | (aligned ? AllocationInfo::kAligned : 0);
+    const uint64_t headerFx = weightOf(block->size, block->flags).countFx * block->baseOffset;
+    const uint32_t threadId = currentThreadId();
+    bool mismatch = false;
+    AllocationInfo mismatched{};
+    allocations.unlink(block,
+                       [this, freedAt, threadId, size, check, headerFx, &mismatch, &mismatched](const AllocationInfo &info)
+                       {
+                           headerBytesFx.fetch_sub(headerFx, std::memory_order_relaxed);
+                           if (accountFreeLocked(info, freedAt, threadId, size, check))
+                           {
+                               mismatch = true;
+                               mismatched = info;
+                           }
+                       });
+
+    if (mismatch)
+        reportDeallocMismatch(mismatched, size, aligned);
+
+    if (remoteEnabled.load(std::memory_order_relaxed))
+    {
+        sendLiveUpdate(block->user(), 0, false, "", 0, "");
+    }
+}
+
+bool MemoryTracker::applyAllocation(void *ptr, size_t size, const char *file, int line, const char *type, uint64_t stamp, uint16_t flags, uint32_t stackId, uint32_t slack, uint32_t threadId, uint32_t tagId, bool outOfOrder)
+{
+    const uint32_t typeId = interned.internString(type);
+
+    AllocationInfo info{};
+    info.address = ptr;
+    info.size = size;
+    info.slack = slack;
+    info.flags = flags;
+    info.setStamp(stamp);
+    info.siteId = interned.internSite(file, line);
+    info.typeId = typeId <= AllocationInfo::kMaxTypeId ? typeId : InternTable::kUnknown;
+    info.stackId = stackId;
+    info.threadId = threadId;
+    info.tagId = tagId;
+
+    // Solo se bloquea el shard de ptr; los contadores se actualizan dentro
+    // de esa sección crítica para que lockAll() los vea coherentes.
+    // Si la dirección ya tiene registro: desde un buffer puede ser el de una
+    // reutilización posterior (este Alloc y su Free llegaron tarde) y se
+    // conserva; si no, su Free nunca se vio y se da de baja aquí.
+    const uint64_t newest = outOfOrder ? clock.now() : 0;
+    const bool inserted = allocations.insert(
+        info,
+        [outOfOrder, stamp, newest](const AllocationInfo &existing)
+        {
+            return outOfOrder && TscClock::widen(existing.stamp(), newest) > stamp;
+        },
+        [this, stamp](const AllocationInfo &replaced)
+        {
+            accountFreeLocked(replaced, stamp & TscClock::kStampMask, 0, 0, 0);
+        },
+        [this](const AllocationInfo &added)
+        {
+            accountAllocLocked(added);
+        });
+    if (!inserted)
+        return false;
+
+    // Enviar actualización en tiempo real (fuera del lock del shard)
+    if (remoteEnabled.load(std::memory_order_relaxed))
+    {
+        sendLiveUpdate(ptr, size, true, file, line, type);
+    }
+
+    MT_LOGLN("[TRK] ALLOC ptr=" << ptr << " size=" << size << " @" << (file ? file : "unknown") << ":" << line);
+    return true;
+}
+
+bool MemoryTracker::applyFree(void *ptr, uint64_t stamp, uint32_t threadId, size_t expectedSize, uint16_t checkFlags, bool outOfOrder)
+{
+    // Como si no estuviera: un Free diferido se reintenta igual
+    if (!mayBeTracked(ptr))
+        return false;
+
+    // Desde un buffer, un registro creado después de este free pertenece a
+    // una reutilización de la dirección (el Alloc viejo nunca se vio): no se
+    // toca. El sello del registro se completa contra el reloj actual y se
+    // compara en 64 bits: una ventana de medio rango de 48 bits confundiría
+    // un bloque de varios días con uno del futuro. Inline no hace falta:
+    // el free se aplica antes de devolver el bloque a la libc.
+    const uint64_t freedAt = stamp & TscClock::kStampMask;
+    const uint64_t newest = outOfOrder ? clock.now() : 0;
+    bool mismatch = false;
+    AllocationInfo mismatched{};
+    const bool found = allocations.eraseIf(
+        ptr,
+        [outOfOrder, stamp, newest](const AllocationInfo &info)
+        {
+            return !outOfOrder || TscClock::widen(info.stamp(), newest) <= stamp;
+        },
+        [this, freedAt, threadId, expectedSize, checkFlags, &mismatch, &mismatched](const AllocationInfo &info)
+        {
+            if (accountFreeLocked(info, freedAt, threadId, expectedSize, checkFlags))
+            {
+                mismatch = true;
+                mismatched = info;
+            }
+        });
+
+    if (mismatch)
+        reportDeallocMismatch(mismatched, expectedSize, (checkFlags & AllocationInfo::kAligned) != 0);
+
+    if (found)
+    {
+        // Enviar actualización en tiempo real
+        if (remoteEnabled.load(std::memory_order_relaxed))
+        {
+            sendLiveUpdate(ptr, 0, false, "", 0, "");
+        }
+
+        MT_LOGLN("[TRK] FREE ptr=" << ptr);
+    }
+    return found;
+}
+
+//==================================================
+// Contabilidad bajo el lock del shard
+//==================================================
+// Comunes al mapa y a las listas del modo cabecera. Se llaman dentro de la
+// sección crítica del shard del bloque para que lockAll() vea los contadores
+// coherentes con el contenido de la tabla.
+void MemoryTracker::accountAllocLocked(const AllocationInfo &info) noexcept
+{
+    const Weight w = weightOf(info.size, info.flags);
+    const uint64_t slackFx = w.countFx * info.slack;
+    sizes.recordAlloc(AllocationTable::shardIndex(info.address), info.size, w.countFx, w.bytes);
+    const bool siteCrossed = siteStats.recordAlloc(info.siteId, w.countFx, w.bytes, slackFx);
+    slackBytesFx.fetch_add(slackFx, std::memory_order_relaxed);
+    fileStats.recordAlloc(interned.site(info.siteId).fileId, w.countFx, w.bytes);
+    threadStats.recordAlloc(info.threadId, w.countFx, w.bytes);
+    tagStats.recordAlloc(info.tagId, w.countFx, w.bytes);
+    journal.record(AllocationTable::shardIndex(info.address), info, info.stamp(), false);
+    if (info.flags & AllocationInfo::kSampled)
+        sampledBlocks.add(info.address);
+    else
+        unsampledLive.fetch_add(1, std::memory_order_relaxed);
+    totalAllocationsFx.fetch_add(w.countFx, std::memory_order_relaxed);
+    activeAllocationsFx.fetch_add(w.countFx, std::memory_order_relaxed);
+    const size_t current = currentMemory.fetch_add(w.bytes, std::memory_order_relaxed) + w.bytes;
+    updatePeak(current);
+
+    // Sin presupuestos budgetTrip es SIZE_MAX y el de sitio está en 0
+    if (current >= budgetTrip.load(std::memory_order_relaxed))
+        budgetCrossed(kGlobalBudget);
+    if (siteCrossed)
+        budgetCrossed(info.siteId);
+}
+
+// Devuelve true si el delete no coincide con el new (ver checkFlags)
+bool MemoryTracker::accountFreeLocked(const AllocationInfo &info, uint64_t freedAt, uint32_t freeThread, size_t expectedSize, uint16_t checkFlags) noexcept
+{
+    // El delete sized ya trae el tamaño: se usa si coincide con el
+    // registro. Si no, se conserva el registrado para que los
+    // contadores sigan cuadrando con lo que sumó el Alloc.
+    uint64_t size = info.size;
+    bool mismatch = false;
+    if (checkFlags & AllocationEvent::kCheckedFree)
+    {
+        const bool sizeOk = expectedSize == 0 || expectedSize == info.size;
+        const bool alignOk = ((checkFlags ^ info.flags) & AllocationInfo::kAligned) == 0;
+        if (sizeOk)
+            size = expectedSize ? expectedSize : size;
+        mismatch = !sizeOk || !alignOk;
+    }
+
+    const Weight w = weightOf(size, info.flags);
+    const uint64_t slackFx = w.countFx * info.slack;
+    sizes.recordFree(AllocationTable::shardIndex(info.address), size, w.countFx, w.bytes);
+    lifetimes.record(info.siteId, clock.toNs(TscClock::elapsed(info.stamp(), freedAt)), w.countFx);
+    siteStats.recordFree(info.siteId, w.countFx, w.bytes, slackFx);
+    slackBytesFx.fetch_sub(slackFx, std::memory_order_relaxed);
+    fileStats.recordFree(interned.site(info.siteId).fileId, w.countFx, w.bytes);
+    threadStats.recordFree(info.threadId, w.countFx, w.bytes);
+    tagStats.recordFree(info.tagId, w.countFx, w.bytes);
+    // Entregas productor/consumidor: el bloque vuelve a la caché o arena de
+    // otro hilo, que es caro en casi todos los allocators
+    if (freeThread != info.threadId && freeThread && info.threadId)
+    {
+        siteStats.recordCrossFree(info.siteId, w.countFx);
+        threadStats.recordCrossFree(info.threadId, w.countFx);
+        if (std::atomic<uint64_t> *remote = remoteFreesFx.get(freeThread))
+            remote->fetch_add(w.countFx, std::memory_order_relaxed);
+        crossThreadFreesFx.fetch_add(w.countFx, std::memory_order_relaxed);
+    }
+    journal.record(AllocationTable::shardIndex(info.address), info, freedAt, true);
+    if (info.flags & AllocationInfo::kSampled)
+        sampledBlocks.remove(info.address);
+    else
+        unsampledLive.fetch_sub(1, std::memory_order_relaxed);
+    currentMemory.fetch_sub(w.bytes, std::memory_order_relaxed);
+    activeAllocationsFx.fetch_sub(w.countFx, std::memory_order_relaxed);
+    return mismatch;
+}
+
+// Sin registros fuera del filtro, una ranura en 0 descarta el puntero sin
+// tocar la tabla. Sin muestreo todo registro cuenta en unsampledLive: con
+// alguno vivo se busca siempre, y con la tabla vacía no hay nada que buscar.
+bool MemoryTracker::mayBeTracked(const void *ptr) const noexcept
+{
+    return unsampledLive.load(std::memory_order_relaxed) != 0 || sampledBlocks.mayContain(ptr);
+}
+
+// Fuera del lock del shard. Solo se detallan las primeras: un delete mal
+// emparejado en un bucle no debe inundar stderr.
+void MemoryTracker::reportDeallocMismatch(const AllocationInfo &info, size_t expectedSize, bool alignedDelete)
+{
+    constexpr uint64_t kMaxDetailed = 16;
+    const bool alignedNew = (info.flags & AllocationInfo::kAligned) != 0;
+
+    static std::atomic<uint64_t> detailed{0};
+
+    if (alignedNew != alignedDelete)
+        alignMismatches.fetch_add(1, std::memory_order_relaxed);
+    if (expectedSize && expectedSize != info.size)
+        sizeMismatches.fetch_add(1, std::memory_order_relaxed);
+    if (detailed.fetch_add(1, std::memory_order_relaxed) >= kMaxDetailed)
+        return;
+
+    const InternTable::Site site = interned.site(info.siteId);
+    std::fprintf(stderr, "[MT] operator delete mismatch at %p: %s new of %llu bytes @%s:%d, %s delete of %llu bytes\n",
+                 info.address,
+                 alignedNew ? "aligned" : "plain", static_cast<unsigned long long>(info.size),
+                 interned.string(site.fileId), site.line,
+                 alignedDelete ? "aligned" : "plain",
+                 static_cast<unsigned long long>(expectedSize ? expectedSize : info.size));
+}
+
+int64_t MemoryTracker::steadyNowNs() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Solo para reportes: es la única conversión de un sello a tiempo de pared
+long long MemoryTracker::toWallClockMs(uint64_t stamp) const noexcept
+{
+    const auto wall = clockBaseWall + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+                                          std::chrono::nanoseconds(clock.toNs(stamp)));
+    return std::chrono::duration_cast<std::chrono::milliseconds>(wall.time_since_epoch()).count();
+}
+
+//==================================================
+// Modo buffered
+//==================================================
+void MemoryTracker::enableBufferedMode(std::chrono::milliseconds drainPeriod)
+{
+    if (g_mt_in_tracker)
+        return;
+    ReentryGuard guard;
+
+    {
+        std::lock_guard<std::mutex> lock(aggregatorMtx);
+        aggregatorPeriod = drainPeriod;
+        aggregatorStop = false;
+    }
+
+    if (!aggregator.joinable())
+    {
+        aggregator = std::thread([this]()
+                                 { aggregatorLoop(); });
+    }
+
+    bufferedMode.store(true, std::memory_order_release);
+    MT_LOGLN("[MT] Buffered mode enabled, drain period " << drainPeriod.count() << "ms");
+}
+
+void MemoryTracker::disableBufferedMode()
+{
+    bufferedMode.store(false, std::memory_order_release);
+
+    if (aggregator.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(aggregatorMtx);
+            aggregatorStop = true;
+        }
+        aggregatorCv.notify_all();
+        aggregator.join();
+    }
+
+    // Lo que quedó encolado antes del cambio de modo se aplica ahora
+    flushEvents();
+}
+
+bool MemoryTracker::isBufferedMode() const noexcept
+{
+    return bufferedMode.load(std::memory_order_acquire);
+}
+
+void MemoryTracker::flushEvents()
+{
+    ReentryGuard guard;
+    std::lock_guard<std::mutex> lock(drainMtx);
+
+    // Dos pasadas: la segunda resuelve los Free que se pospusieron porque su
+    // Alloc (de otro hilo) se publicó mientras se recorría la lista.
+    drainEvents();
+    drainEvents();
+}
+
+ThreadEventBuffer *MemoryTracker::threadBuffer()
+{
+    ThreadBufferSlot &slot = g_mt_event_slot;
+    if (slot.buffer)
+        return slot.buffer;
+    if (slot.dead)
+        return nullptr;
+
+    ThreadEventBuffer *buffer = ThreadEventBuffer::create();
+    if (!buffer)
+        return nullptr;
+    // Los cambios de tag posteriores llegan como eventos Scope
+    buffer->threadId = currentThreadId();
+    buffer->tag = MemoryScope::current();
+
+    {
+        std::lock_guard<std::mutex> lock(buffersMtx);
+        buffer->next = buffers;
+        buffers = buffer;
+    }
+    slot.buffer = buffer;
+    return buffer;
+}
+
+bool MemoryTracker::pushEvent(const AllocationEvent &ev, void *const *frames)
+{
+    ThreadEventBuffer *buffer = threadBuffer();
+    if (!buffer)
+    {
+        // Sin buffer propio: aplicar inline, pero después de lo ya encolado
+        flushEvents();
+        return false;
+    }
+
+    if (buffer->tryPush(ev, frames))
+        return true;
+
+    // Ring lleno: el propio hilo drena en lugar de perder el evento
+    aggregatorCv.notify_one();
+    flushEvents();
+    return buffer->tryPush(ev, frames);
+}
+
+void MemoryTracker::scopeChanged(uint32_t tagId) noexcept
+{
+    // Un buffer nuevo ya arranca con el tag del momento
+    if (!g_mt_event_slot.buffer || !isAlive())
+        return;
+    AllocationEvent ev{};
+    ev.kind = AllocationEvent::Scope;
+    ev.tagId = tagId;
+    getInstance().pushEvent(ev);
+}
+
+// Completa lo que el productor dejó sin resolver, en el orden del hilo que
+// lo publicó. Requiere drainMtx.
+void MemoryTracker::resolveEvent(ThreadEventBuffer &buffer, AllocationEvent &ev, void *const *frames)
+{
+    if (ev.kind == AllocationEvent::Scope)
+    {
+        buffer.tag = ev.tagId;
+        return;
+    }
+
+    ev.threadId = buffer.threadId;
+    if (ev.kind == AllocationEvent::Alloc)
+    {
+        ev.tagId = buffer.tag;
+        if (ev.frames)
+            ev.stackId = stacks.intern(frames, ev.frames);
+        if (ev.flags & AllocationEvent::kEstimateSlack)
+        {
+            ev.flags &= ~AllocationEvent::kEstimateSlack;
+            ev.slack = static_cast<uint16_t>(mt_slack(mt_estimated_usable(ev.size), ev.size));
+        }
+    }
+    drainBatch.push_back(ev);
+}
+
+// Requiere drainMtx.
+size_t MemoryTracker::drainEvents()
+{
+    drainBatch.clear();
+    drainBatch.insert(drainBatch.end(), deferredFrees.begin(), deferredFrees.end());
+    deferredFrees.clear();
+
+    size_t drained = 0;
+    {
+        std::lock_guard<std::mutex> lock(buffersMtx);
+        ThreadEventBuffer **link = &buffers;
+        while (ThreadEventBuffer *buffer = *link)
+        {
+            // Leer `retired` antes de drenar: si ya estaba retirado, este
+            // drenado ve sus últimos eventos y se puede liberar.
+            const bool retired = buffer->isRetired();
+            drained += buffer->drain([this, buffer](AllocationEvent &ev, void *const *frames)
+                                     { resolveEvent(*buffer, ev, frames); });
+
+            if (retired && buffer->empty())
+            {
+                *link = buffer->next;
+                ThreadEventBuffer::destroy(buffer);
+                continue;
+            }
+            link = &buffer->next;
+        }
+    }
+
+    // Cada hilo publica en orden; el timestamp ordena los hilos entre sí
+    // (un free en otro hilo siempre ocurre después de su alloc).
+    std::stable_sort(drainBatch.begin(), drainBatch.end(),
+                     [](const AllocationEvent &a, const AllocationEvent &b)
+                     {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    for (const AllocationEvent &ev : drainBatch)
+    {
+        if (ev.kind == AllocationEvent::Alloc)
+        {
+            applyAllocation(ev.ptr, ev.size, ev.file, ev.line, ev.type, ev.timestamp, ev.flags, ev.stackId, ev.slack, ev.threadId, ev.tagId, true);
+        }
+        else if (!applyFree(ev.ptr, ev.timestamp, ev.threadId, ev.size, ev.flags, true) && ev.deferrals == 0)
+        {
+            // Su Alloc puede estar en un buffer que ya se recorrió; se
+            // reintenta una sola vez y luego se descarta (puntero no rastreado).
+            AllocationEvent retry = ev;
+            retry.deferrals = 1;
+            deferredFrees.push_back(retry);
+        }
+    }
+    return drained;
+}
+
+void MemoryTracker::aggregatorLoop()
+{
+    // Todo lo que este hilo asigne es del propio tracker
+    ReentryGuard guard;
+
+    std::unique_lock<std::mutex> lock(aggregatorMtx);
+    while (!aggregatorStop)
+    {
+        aggregatorCv.wait_for(lock, aggregatorPeriod);
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> drainLock(drainMtx);
+            drainEvents();
+        }
+        lock.lock();
+    }
+}
+
+void MemoryTracker::updatePeak(size_t current) noexcept
+{
+    size_t peak = peakMemory.load(std::memory_order_relaxed);
+    while (current > peak &&
+           !peakMemory.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
+//==================================================
+// Muestreo estadístico
+//==================================================
+void MemoryTracker::enableSampling(size_t meanIntervalBytes)
+{
+    // Potencia de dos más cercana, dentro de lo que cabe en los 6 bits de flags
+    unsigned shift = 0;
+    while (shift < 40 && (size_t(1) << (shift + 1)) <= meanIntervalBytes + (meanIntervalBytes >> 1))
+        ++shift;
+    if (shift < 4)
+        shift = 4;
+    samplingShift.store(shift, std::memory_order_relaxed);
+    MT_LOGLN("[MT] Sampling enabled, mean interval " << (size_t(1) << shift) << " bytes");
+}
+
+void MemoryTracker::disableSampling()
+{
+    samplingShift.store(0, std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::samplingInterval() noexcept
+{
+    const unsigned shift = samplingShift.load(std::memory_order_relaxed);
+    return shift ? size_t(1) << shift : 0;
+}
+
+bool MemoryTracker::sampleCountdownExpired(int64_t &countdown) noexcept
+{
+    const unsigned shift = samplingShift.load(std::memory_order_relaxed);
+    if (!shift)
+        return true;
+
+    if (!g_mt_sampler_seeded)
+    {
+        // Primera asignación del hilo: sin esto siempre se muestrearía
+        g_mt_sampler_seeded = true;
+        g_mt_sample_rng = (reinterpret_cast<uintptr_t>(&countdown) ^ static_cast<uint64_t>(steadyNowNs())) * 0x9E3779B97F4A7C15ull | 1;
+        countdown += mt_next_sample_interval(shift);
+        if (countdown > 0)
+            return false;
+    }
+
+    countdown = mt_next_sample_interval(shift);
+    return true;
+}
+
+//==================================================
+// Captura de pilas
+//==================================================
+void MemoryTracker::enableStackCapture(unsigned depth)
+{
+    if (depth > StackTable::kMaxDepth)
+        depth = StackTable::kMaxDepth;
+    stackDepth.store(depth, std::memory_order_relaxed);
+    MT_LOGLN("[MT] Stack capture enabled, depth " << depth);
+}
+
+void MemoryTracker::disableStackCapture()
+{
+    stackDepth.store(0, std::memory_order_relaxed);
+}
+
+unsigned MemoryTracker::stackCaptureDepth() const noexcept
+{
+    return stackDepth.load(std::memory_order_relaxed);
+}
+
+//==================================================
+// Simbolización
+//==================================================
+void MemoryTracker::enableSymbolization(std::chrono::milliseconds period)
+{
+    if (g_mt_in_tracker)
+        return;
+    ReentryGuard guard;
+
+    {
+        std::lock_guard<std::mutex> lock(symbolizerMtx);
+        symbolizerPeriod = period;
+        symbolizerStop = false;
+    }
+
+    if (!symbolizerThread.joinable())
+    {
+        symbolizerThread = std::thread([this]()
+                                       { symbolizerLoop(); });
+    }
+    MT_LOGLN("[MT] Symbolization enabled, period " << period.count() << "ms");
+}
+
+void MemoryTracker::disableSymbolization()
+{
+    if (symbolizerThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(symbolizerMtx);
+            symbolizerStop = true;
+        }
+        symbolizerCv.notify_all();
+        symbolizerThread.join();
+    }
+}
+
+void MemoryTracker::symbolizerLoop()
+{
+    // Todo lo que este hilo asigne es del propio tracker
+    ReentryGuard guard;
+
+    uint32_t nextStack = StackTable::kNoStack + 1;
+    std::unique_lock<std::mutex> lock(symbolizerMtx);
+    while (!symbolizerStop)
+    {
+        lock.unlock();
+        // Solo las pilas nuevas; los PCs que comparten con otras salen de la caché
+        const uint32_t count = stacks.size();
+        for (; nextStack < count; ++nextStack)
+        {
+            const StackTable::Frames frames = stacks.frames(nextStack);
+            for (uint32_t i = 0; i < frames.depth; ++i)
+                symbolizer.resolve(frames.pcs[i]);
+        }
+        lock.lock();
+        symbolizerCv.wait_for(lock, symbolizerPeriod);
+    }
+}
+
+std::string MemoryTracker::describeFrame(const void *pc)
+{
+    Symbolizer::Location loc;
+    symbolizer.cached(pc, loc);
+    const TrackerString text = Symbolizer::format(pc, loc);
+    return std::string(text.data(), text.size());
+}
+
+std::string MemoryTracker::getModuleMap()
+{
+    ReentryGuard guard;
+    symbolizer.loadProcessModules();
+    const TrackerString map = symbolizer.moduleMap();
+    return std::string(map.data(), map.size());
+}
+
+MemoryTracker::Weight MemoryTracker::weightOf(uint64_t size, uint16_t flags) noexcept
+{
+    if (!(flags & AllocationInfo::kSampled))
+        return {kWeightOne, size};
+
+    // Un bloque de `size` bytes se muestrea con p = 1 - e^(-size/T); pesar
+    // cada muestra por 1/p da estimaciones insesgadas de conteo y bytes.
+    const unsigned shift = (flags >> AllocationInfo::kSampleShiftBit) & 0x3F;
+    const double mean = std::ldexp(1.0, static_cast<int>(shift));
+    const double p = -std::expm1(-static_cast<double>(size ? size : 1) / mean);
+    return {static_cast<uint64_t>(std::llround(static_cast<double>(kWeightOne) / p)),
+            static_cast<uint64_t>(std::llround(static_cast<double>(size) / p))};
+}
+
+//==================================================
+// Presupuestos de memoria
+//==================================================
+uint32_t MemoryTracker::setMemoryBudget(size_t limitBytes, BudgetCallback callback)
+{
+    return addBudget(kGlobalBudget, limitBytes, std::move(callback));
+}
+
+uint32_t MemoryTracker::setSiteBudget(const char *file, int line, size_t limitBytes, BudgetCallback callback)
+{
+    uint32_t siteId;
+    {
+        ReentryGuard guard;
+        siteId = interned.internSite(file ? file : "unknown", line);
+    }
+    return addBudget(siteId, limitBytes, std::move(callback));
+}
+
+uint32_t MemoryTracker::addBudget(uint32_t siteId, size_t limitBytes, BudgetCallback callback)
+{
+    if (limitBytes == 0)
+        return 0;
+    // El callback reemplazado se destruye afuera: lo que libere es de la aplicación
+    BudgetCallback replaced;
+    ReentryGuard guard;
+
+    std::lock_guard<std::mutex> lock(budgetMtx);
+    if (siteId != kGlobalBudget)
+    {
+        const auto it = std::find_if(budgets.begin(), budgets.end(),
+                                     [siteId](const Budget &b)
+                                     { return b.siteId == siteId; });
+        if (it != budgets.end())
+        {
+            replaced = std::move(it->callback);
+            budgets.erase(it);
+        }
+        siteStats.setLimit(siteId, limitBytes);
+    }
+
+    const uint32_t id = nextBudgetId++;
+    budgets.push_back({id, siteId, limitBytes, std::move(callback), false, false});
+    armBudgetsLocked();
+
+#if defined(__linux__)
+    if (budgetFd < 0)
+        budgetFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    if (!budgetThread.joinable())
+    {
+        budgetStop = false;
+        budgetThread = std::thread([this]()
+                                   { budgetLoop(); });
+    }
+    MT_LOGLN("[MT] Budget " << id << " set to " << limitBytes << " bytes");
+    return id;
+}
+
+void MemoryTracker::removeBudget(uint32_t id)
+{
+    BudgetCallback removed;
+    ReentryGuard guard;
+    std::lock_guard<std::mutex> lock(budgetMtx);
+    const auto it = std::find_if(budgets.begin(), budgets.end(),
+                                 [id](const Budget &b)
+                                 { return b.id == id; });
+    if (it == budgets.end())
+        return;
+    if (it->siteId != kGlobalBudget)
+        siteStats.setLimit(it->siteId, 0);
+    removed = std::move(it->callback);
+    budgets.erase(it);
+    armBudgetsLocked();
+}
+
+int MemoryTracker::budgetAlertFd()
+{
+    ReentryGuard guard;
+    std::lock_guard<std::mutex> lock(budgetMtx);
+#if defined(__linux__)
+    if (budgetFd < 0)
+        budgetFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    return budgetFd;
+}
+
+// El primer hilo que cruza un umbral lo desarma (budgetTrip sube o el
+// límite del sitio vuelve a 0): los demás siguen sin tocar budgetMtx.
+void MemoryTracker::budgetCrossed(uint32_t siteId) noexcept
+{
+    std::lock_guard<std::mutex> lock(budgetMtx);
+    const size_t current = currentMemory.load(std::memory_order_relaxed);
+    bool crossed = false;
+    for (Budget &b : budgets)
+    {
+        if (b.tripped || b.siteId != siteId)
+            continue;
+        if (siteId == kGlobalBudget && current < b.limitBytes)
+            continue;
+        b.tripped = true;
+        b.pending = true;
+        crossed = true;
+    }
+    if (!crossed)
+        return;
+    armBudgetsLocked();
+    budgetWake = true;
+    budgetCv.notify_one();
+}
+
+// Requiere budgetMtx
+void MemoryTracker::armBudgetsLocked() noexcept
+{
+    size_t trip = SIZE_MAX;
+    for (const Budget &b : budgets)
+    {
+        if (b.siteId == kGlobalBudget && !b.tripped)
+            trip = std::min(trip, b.limitBytes);
+    }
+    budgetTrip.store(trip, std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::budgetUsage(const Budget &budget) const noexcept
+{
+    if (budget.siteId == kGlobalBudget)
+        return currentMemory.load(std::memory_order_relaxed);
+    SiteStatsTable::Counts c;
+    if (!siteStats.snapshot(budget.siteId, c))
+        return 0;
+    return static_cast<size_t>(c.allocBytes - c.freeBytes);
+}
+
+void MemoryTracker::stopBudgets()
+{
+    if (budgetThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(budgetMtx);
+            budgetStop = true;
+        }
+        budgetCv.notify_all();
+        budgetThread.join();
+    }
+#if defined(__linux__)
+    if (budgetFd >= 0)
+    {
+        close(budgetFd);
+        budgetFd = -1;
+    }
+#endif
+}
+
+void MemoryTracker::budgetLoop()
+{
+    // Lo que asignen este hilo y los callbacks es del propio tracker
+    ReentryGuard guard;
+
+    struct Ready
+    {
+        BudgetAlert alert;
+        BudgetCallback callback;
+    };
+    TrackerVector<Ready> ready;
+
+    std::unique_lock<std::mutex> lock(budgetMtx);
+    while (!budgetStop)
+    {
+        // Con alguno disparado se mira seguido si ya puede rearmarse
+        const bool anyTripped = std::any_of(budgets.begin(), budgets.end(),
+                                            [](const Budget &b)
+                                            { return b.tripped; });
+        const auto woken = [this]()
+        { return budgetStop || budgetWake; };
+        if (anyTripped)
+            budgetCv.wait_for(lock, std::chrono::milliseconds(100), woken);
+        else
+            budgetCv.wait(lock, woken);
+        if (budgetStop)
+            break;
+        budgetWake = false;
+
+        for (Budget &b : budgets)
+        {
+            if (b.pending)
+            {
+                b.pending = false;
+                BudgetAlert alert{b.id, std::string(), 0, b.limitBytes, budgetUsage(b), 0, {}};
+                if (b.siteId != kGlobalBudget)
+                {
+                    const InternTable::Site site = interned.site(b.siteId);
+                    alert.file = interned.string(site.fileId);
+                    alert.line = site.line;
+                }
+                ready.push_back({std::move(alert), b.callback});
+            }
+            else if (b.tripped && budgetUsage(b) < b.limitBytes - b.limitBytes / 10)
+            {
+                // Histéresis del 10%: un uso que oscila en el límite no inunda de avisos
+                b.tripped = false;
+                if (b.siteId != kGlobalBudget)
+                    siteStats.setLimit(b.siteId, b.limitBytes);
+            }
+        }
+        armBudgetsLocked();
+        if (ready.empty())
+            continue;
+
+        // Sin budgetMtx: getTopSites() vacía los buffers y eso puede volver a cruzar
+        lock.unlock();
+        const auto topSites = getTopSites(kBudgetTopSites);
+        const long long now = toWallClockMs(clock.now() & TscClock::kStampMask);
+        for (Ready &r : ready)
+        {
+            r.alert.topSites = topSites;
+            r.alert.timestamp_ms = now;
+            sendBudgetAlert(r.alert);
+#if defined(__linux__)
+            const uint64_t one = 1;
+            if (budgetFd >= 0 && write(budgetFd, &one, sizeof(one)) < 0)
+                MT_LOGLN("[MT] Budget eventfd write failed");
+#endif
+            if (r.callback)
+                r.callback(r.alert);
+            MT_LOGLN("[MT] Budget " << r.alert.budgetId << " crossed: " << r.alert.liveBytes << "/" << r.alert.limitBytes << " bytes");
+        }
+        ready.clear();
+        lock.lock();
+    }
+}
+
+//==================================================
+// Reportes y Estadísticas
+//==================================================
+MemoryTracker::Stats MemoryTracker::getCurrentStats()
+{
+    // Se consulta seguido: aprovecha para afinar la conversión de sellos
+    clock.recalibrate();
+    flushEvents();
+    return loadStats();
+}
+
+//==================================================
+// Memoria real del proceso
+//==================================================
+#if defined(__linux__)
+// Lee un archivo de /proc sin pasar por stdio
+static size_t mt_read_proc(const char *path, char *buf, size_t size) noexcept
+{
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+    size_t used = 0;
+    while (used + 1 < size)
+    {
+        const ssize_t got = ::read(fd, buf + used, size - 1 - used);
+        if (got <= 0)
+            break;
+        used += static_cast<size_t>(got);
+    }
+    ::close(fd);
+    buf[used] = '\0';
+    return used;
+}
+
+// Bytes de una línea "\nClave:   123 kB" de smaps_rollup
+static size_t mt_smaps_bytes(const char *text, const char *key) noexcept
+{
+    const char *at = std::strstr(text, key);
+    return at ? static_cast<size_t>(std::strtoull(at + std::strlen(key), nullptr, 10)) * 1024 : 0;
+}
+#endif
+
+MemoryTracker::Footprint MemoryTracker::getFootprint(bool withPageOccupancy)
+{
+    ReentryGuard guard;
+    const Stats stats = getCurrentStats();
+
+    Footprint fp{};
+    fp.requestedBytes = stats.currentMemory;
+    fp.slackBytes = stats.slackBytes;
+    size_t pageSize = 4096;
+
+#if defined(__linux__)
+    pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    char text[4096];
+    if (mt_read_proc("/proc/self/statm", text, sizeof(text)))
+    {
+        // tamaño residente compartido ... (en páginas)
+        char *rest = nullptr;
+        std::strtoull(text, &rest, 10);
+        fp.rssBytes = static_cast<size_t>(std::strtoull(rest, nullptr, 10)) * pageSize;
+    }
+    if (mt_read_proc("/proc/self/smaps_rollup", text, sizeof(text)))
+    {
+        fp.anonBytes = mt_smaps_bytes(text, "\nAnonymous:");
+        fp.pssBytes = mt_smaps_bytes(text, "\nPss:");
+        fp.swapBytes = mt_smaps_bytes(text, "\nSwap:");
+    }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 mi = mallinfo2();
+    fp.heapCommitted = mi.arena + mi.hblkhd;
+    fp.heapInUse = mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+    // Campos int: se truncan pasados los 4 GB
+    const struct mallinfo mi = mallinfo();
+    fp.heapCommitted = static_cast<size_t>(static_cast<unsigned>(mi.arena)) + static_cast<unsigned>(mi.hblkhd);
+    fp.heapInUse = static_cast<size_t>(static_cast<unsigned>(mi.uordblks)) + static_cast<unsigned>(mi.hblkhd);
+#endif
+#endif
+
+    // Con muestreo la foto solo tiene las muestras: no alcanza para contar páginas
+    if (withPageOccupancy && !isSampling())
+    {
+        const AllocationTable::Snapshot live = allocations.snapshot(stats.activeAllocations);
+        std::vector<std::pair<uintptr_t, uintptr_t>, SlabAllocator<std::pair<uintptr_t, uintptr_t>>> spans;
+        spans.reserve(live.size());
+        uint64_t liveBytes = 0;
+        for (const AllocationInfo &info : live)
+        {
+            if (!info.size)
+                continue;
+            const uintptr_t start = reinterpret_cast<uintptr_t>(info.address);
+            spans.emplace_back(start / pageSize, (start + info.size - 1) / pageSize);
+            liveBytes += info.size;
+        }
+
+        // Páginas distintas: rangos ordenados, contando solo lo que no se solapa
+        std::sort(spans.begin(), spans.end());
+        uintptr_t covered = 0; // primera página todavía no contada
+        for (const auto &span : spans)
+        {
+            const uintptr_t first = std::max(span.first, covered);
+            if (span.second >= first)
+                fp.livePages += span.second - first + 1;
+            covered = std::max(covered, span.second + 1);
+        }
+        if (fp.livePages)
+            fp.pageOccupancy = static_cast<double>(liveBytes) / (static_cast<double>(fp.livePages) * static_cast<double>(pageSize));
+    }
+    return fp;
+}
+
+MemoryTracker::Stats MemoryTracker::loadStats() const noexcept
+{
+    // Lectura sin lock: cada contador es exacto, aunque entre ellos pueden
+    // diferir en una operación en curso.
+    return {static_cast<size_t>((totalAllocationsFx.load(std::memory_order_relaxed) + kWeightOne / 2) / kWeightOne),
+            static_cast<size_t>((activeAllocationsFx.load(std::memory_order_relaxed) + kWeightOne / 2) / kWeightOne),
+            currentMemory.load(std::memory_order_relaxed),
+            peakMemory.load(std::memory_order_relaxed),
+            SlabArena::totalMappedBytes(),
+            samplingInterval(),
+            static_cast<size_t>(sizeMismatches.load(std::memory_order_relaxed)),
+            static_cast<size_t>(alignMismatches.load(std::memory_order_relaxed)),
+            static_cast<size_t>(headerBytesFx.load(std::memory_order_relaxed) / kWeightOne),
+            static_cast<size_t>(slackBytesFx.load(std::memory_order_relaxed) / kWeightOne),
+            countOf(crossThreadFreesFx.load(std::memory_order_relaxed))};
+}
+
+MemoryTracker::LiveAllocations MemoryTracker::liveAllocations()
+{
+    ReentryGuard guard;
+    clock.recalibrate();
+    flushEvents();
+
+    // Las estadísticas se leen antes de copiar: pueden diferir de la foto en
+    // las operaciones que corrieron mientras se copiaba
+    const Stats stats = loadStats();
+    const size_t expected = static_cast<size_t>(activeAllocationsFx.load(std::memory_order_relaxed) / kWeightOne);
+    return LiveAllocations(*this, stats, allocations.snapshot(expected));
+}
+
+MemoryTracker::ReportEntry MemoryTracker::LiveAllocations::entry(size_t i) const
+{
+    ReentryGuard guard;
+    return tracker->describeAllocation(records[i]);
+}
+
+// Los IDs se resuelven a texto recién aquí
+MemoryTracker::ReportEntry MemoryTracker::describeAllocation(const AllocationInfo &info)
+{
+    const InternTable::Site site = interned.site(info.siteId);
+
+    ReportEntry e;
+    e.address = info.address;
+    e.size = info.size;
+    e.file = interned.string(site.fileId);
+    e.line = site.line;
+    e.typeName = interned.string(info.typeId);
+    e.timestamp_ms = toWallClockMs(info.stamp());
+    e.weight = static_cast<double>(weightOf(info.size, info.flags).countFx) / kWeightOne;
+    e.stackId = info.stackId;
+    e.threadId = info.threadId;
+    if (info.tagId)
+        e.tag = tagName(info.tagId);
+    if (info.stackId != StackTable::kNoStack)
+        e.location = describeFrame(stacks.frames(info.stackId).pcs[0]);
+    return e;
+}
+
+MemoryTracker::Report MemoryTracker::collectReport()
+{
+    ReentryGuard guard;
+    const LiveAllocations live = liveAllocations();
+
+    Report r;
+    r.stats = live.stats();
+    r.leaks.reserve(live.size());
+    for (const AllocationInfo &info : live.records)
+    {
+        r.leaks.push_back(describeAllocation(info));
+    }
+    return r;
+}
+
+//==================================================
+// Fugas por alcanzabilidad
+//==================================================
+// Sin inline: los locales del escaneo no pueden quedar en el marco que se
+// recorre como raíz
+#if defined(_MSC_VER)
+#define MT_NOINLINE __declspec(noinline)
+#else
+#define MT_NOINLINE __attribute__((noinline))
+#endif
+
+MemoryTracker::LeakScan MemoryTracker::scanLeaks(unsigned workerThreads)
+{
+    LeakScanCaller caller;
+    LeakScanner::captureCaller(caller);
+    return scanLeaksBelow(caller, workerThreads);
+}
+
+MT_NOINLINE MemoryTracker::LeakScan MemoryTracker::scanLeaksBelow(const LeakScanCaller &caller, unsigned workerThreads)
+{
+    ReentryGuard guard;
+    const auto started = std::chrono::steady_clock::now();
+    const LiveAllocations live = liveAllocations();
+
+    LeakScan scan{};
+    LeakScanner scanner(live.records);
+    scan.scanned = scanner.run(caller, workerThreads);
+    scan.complete = scan.scanned && scanner.allThreadsStopped() && live.complete();
+    scan.stoppedThreads = scanner.stoppedThreads();
+    scan.workerThreads = scanner.workerThreads();
+
+    // Las entradas se arman con el mundo ya reanudado
+    uint64_t reachableFx = 0;
+    uint64_t definitelyFx = 0;
+    uint64_t indirectlyFx = 0;
+    for (size_t i = 0; i < live.size(); ++i)
+    {
+        const AllocationInfo &info = live.records[i];
+        const Weight w = weightOf(info.size, info.flags);
+        switch (scan.scanned ? scanner.state(i) : LeakScanner::DefinitelyLost)
+        {
+        case LeakScanner::Reachable:
+            reachableFx += w.countFx;
+            scan.reachableBytes += w.bytes;
+            break;
+        case LeakScanner::DefinitelyLost:
+            definitelyFx += w.countFx;
+            scan.definitelyLostBytes += w.bytes;
+            scan.definitelyLost.push_back(describeAllocation(info));
+            break;
+        case LeakScanner::IndirectlyLost:
+            indirectlyFx += w.countFx;
+            scan.indirectlyLostBytes += w.bytes;
+            scan.indirectlyLost.push_back(describeAllocation(info));
+            break;
+        default: // liberado durante el escaneo
+            break;
+        }
+    }
+    scan.reachableCount = countOf(reachableFx);
+    scan.definitelyLostCount = countOf(definitelyFx);
+    scan.indirectlyLostCount = countOf(indirectlyFx);
+
+    auto bySize = [](const ReportEntry &a, const ReportEntry &b)
+    { return a.size > b.size; };
+    std::sort(scan.definitelyLost.begin(), scan.definitelyLost.end(), bySize);
+    std::sort(scan.indirectlyLost.begin(), scan.indirectlyLost.end(), bySize);
+
+    scan.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return scan;
+}
+
+void MemoryTracker::setLeakScanOnReport(bool enabled)
+{
+    leakScanOnReport.store(enabled, std::memory_order_relaxed);
+}
+
+MemoryTracker::FileSummary MemoryTracker::fileSummaryOf(uint32_t fileId, const SiteStatsTable::Counts &c) const
+{
+    return {interned.string(fileId),
+            countOf(c.allocCountFx),
+            static_cast<size_t>(c.allocBytes),
+            countOf(c.allocCountFx - c.freeCountFx),
+            static_cast<size_t>(c.allocBytes - c.freeBytes),
+            countOf(c.freeCountFx),
+            static_cast<size_t>(c.peakLiveBytes)};
+}
+
+std::vector<MemoryTracker::FileSummary> MemoryTracker::getFileSummaries()
+{
+    return getTopFiles(SIZE_MAX);
+}
+
+std::vector<MemoryTracker::FileSummary> MemoryTracker::getTopFiles(size_t count)
+{
+    ReentryGuard guard;
+    flushEvents();
+
+    // Los fileId son IDs de InternTable: los de nombres de tipo no tienen entrada
+    std::vector<FileSummary> result;
+    SiteStatsTable::Counts c;
+    const uint32_t stringCount = interned.stringCount();
+    for (uint32_t fileId = 0; fileId < stringCount; ++fileId)
+    {
+        if (fileStats.snapshot(fileId, c))
+            result.push_back(fileSummaryOf(fileId, c));
+    }
+
+    const auto byLiveMemory = [](const FileSummary &a, const FileSummary &b)
+    {
+        return a.leakedMemory > b.leakedMemory;
+    };
+    if (count < result.size())
+    {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), byLiveMemory);
+        result.resize(count);
+    }
+    else
+    {
+        std::sort(result.begin(), result.end(), byLiveMemory);
+    }
+    return result;
+}
+
+std::vector<MemoryTracker::SiteSummary> MemoryTracker::getSiteSummaries()
+{
+    return getTopSites(SIZE_MAX);
+}
+
+std::vector<MemoryTracker::SiteSummary> MemoryTracker::getTopSites(size_t count)
+{
+    ReentryGuard guard;
+    flushEvents();
+
+    std::vector<SiteSummary> result;
+    SiteStatsTable::Counts c;
+    const uint32_t siteCount = interned.siteCount();
+    for (uint32_t siteId = 0; siteId < siteCount; ++siteId)
+    {
+        if (!siteStats.snapshot(siteId, c))
+            continue;
+        const InternTable::Site site = interned.site(siteId);
+        result.push_back({interned.string(site.fileId),
+                          site.line,
+                          countOf(c.allocCountFx),
+                          static_cast<size_t>(c.allocBytes),
+                          countOf(c.allocCountFx - c.freeCountFx),
+                          static_cast<size_t>(c.allocBytes - c.freeBytes),
+                          countOf(c.freeCountFx),
+                          static_cast<size_t>(c.peakLiveBytes),
+                          static_cast<size_t>(c.liveSlackFx / kWeightOne),
+                          countOf(c.crossFreeCountFx)});
+    }
+
+    const auto byLiveMemory = [](const SiteSummary &a, const SiteSummary &b)
+    {
+        return a.liveMemory > b.liveMemory;
+    };
+    if (count < result.size())
+    {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), byLiveMemory);
+        result.resize(count);
+    }
+    else
+    {
+        std::sort(result.begin(), result.end(), byLiveMemory);
+    }
+    return result;
+}
+
+std::vector<MemoryTracker::ThreadSummary> MemoryTracker::getThreadSummaries()
+{
+    ReentryGuard guard;
+    flushEvents();
+
+    std::vector<ThreadSummary> result;
+    SiteStatsTable::Counts c;
+    std::lock_guard<std::mutex> lock(threadsMtx);
+    for (uint32_t threadId = 1; threadId < threadRecords.size(); ++threadId)
+    {
+        const bool allocated = threadStats.snapshot(threadId, c);
+        const std::atomic<uint64_t> *remote = remoteFreesFx.find(threadId);
+        const uint64_t remoteFx = remote ? remote->load(std::memory_order_relaxed) : 0;
+        if (!allocated && !remoteFx)
+            continue;
+        if (!allocated)
+            c = SiteStatsTable::Counts{};
+
+        ThreadRecord &record = threadRecords[threadId];
+#if defined(__linux__)
+        // Mientras el hilo viva; después queda el último nombre leído. Un
+        // TID reutilizado por otro hilo del proceso puede renombrarlo.
+        if (record.osThreadId)
+        {
+            char path[64];
+            char comm[32];
+            std::snprintf(path, sizeof(path), "/proc/self/task/%llu/comm", static_cast<unsigned long long>(record.osThreadId));
+            if (size_t n = mt_read_proc(path, comm, sizeof(comm)))
+            {
+                if (comm[n - 1] == '\n')
+                    comm[n - 1] = '\0';
+                std::memcpy(record.name, comm, sizeof(record.name) - 1);
+                record.name[sizeof(record.name) - 1] = '\0';
+            }
+        }
+#endif
+        result.push_back({threadId,
+                          record.osThreadId,
+                          std::string(record.name, strnlen(record.name, sizeof(record.name))),
+                          countOf(c.allocCountFx),
+                          static_cast<size_t>(c.allocBytes),
+                          countOf(c.allocCountFx - c.freeCountFx),
+                          static_cast<size_t>(c.allocBytes - c.freeBytes),
+                          countOf(c.freeCountFx),
+                          static_cast<size_t>(c.peakLiveBytes),
+                          countOf(c.crossFreeCountFx),
+                          countOf(remoteFx)});
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const ThreadSummary &a, const ThreadSummary &b)
+              {
+                  return a.liveMemory > b.liveMemory;
+              });
+    return result;
+}
+
+std::vector<MemoryTracker::TagSummary> MemoryTracker::getTagSummaries()
+{
+    ReentryGuard guard;
+    flushEvents();
+
+    uint32_t tagCount;
+    {
+        std::lock_guard<std::mutex> lock(tagsMtx);
+        tagCount = std::max<uint32_t>(static_cast<uint32_t>(tagNames.size()), 1);
+    }
+
+    std::vector<TagSummary> result;
+    SiteStatsTable::Counts c;
+    for (uint32_t tagId = 0; tagId < tagCount; ++tagId)
+    {
+        if (!tagStats.snapshot(tagId, c))
+            continue;
+        result.push_back({tagId,
+                          tagName(tagId),
+                          countOf(c.allocCountFx),
+                          static_cast<size_t>(c.allocBytes),
+                          countOf(c.allocCountFx - c.freeCountFx),
+                          static_cast<size_t>(c.allocBytes - c.freeBytes),
+                          countOf(c.freeCountFx),
+                          static_cast<size_t>(c.peakLiveBytes)});
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const TagSummary &a, const TagSummary &b)
+              {
+                  return a.liveMemory > b.liveMemory;
+              });
+    return result;
+}
+
+std::vector<MemoryTracker::StackSummary> MemoryTracker::getStackSummaries()
+{
+    ReentryGuard guard;
+    flushEvents();
+    // Se agregan los bloques vivos por stackId y cada pila se copia una vez.
+    // Los conteos se suman en punto fijo y se redondean al final.
+    struct Accumulator
+    {
+        uint64_t countFx = 0;
+        uint64_t bytes = 0;
+    };
+    std::unordered_map<uint32_t, Accumulator, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                       SlabAllocator<std::pair<const uint32_t, Accumulator>>>
+        byStack;
+
+    const AllocationTable::Snapshot live = allocations.snapshot(activeAllocationsFx.load(std::memory_order_relaxed) / kWeightOne);
+    for (const AllocationInfo &info : live)
+    {
+        const Weight w = weightOf(info.size, info.flags);
+        Accumulator &acc = byStack[info.stackId];
+        acc.countFx += w.countFx;
+        acc.bytes += w.bytes;
+    }
+
+    std::vector<StackSummary> result;
+    result.reserve(byStack.size());
+    for (const auto &pair : byStack)
+    {
+        const StackTable::Frames frames = stacks.frames(pair.first);
+        const size_t count = static_cast<size_t>((pair.second.countFx + kWeightOne / 2) / kWeightOne);
+        result.push_back({pair.first,
+                          std::vector<const void *>(frames.pcs, frames.pcs + frames.depth),
+                          count,
+                          pair.second.bytes});
+    }
+
+    // Ordenar por memoria total (descendente)
+    std::sort(result.begin(), result.end(),
+              [](const StackSummary &a, const StackSummary &b)
+              {
+                  return a.totalMemory > b.totalMemory;
+              });
+
+    return result;
+}
+
+MemoryTracker::SizeDistribution MemoryTracker::getSizeDistribution()
 {
-    if (!ptr)
-        return;
-    if (g_mt_in_tracker)
-        return;
     ReentryGuard guard;
+    flushEvents();
+
+    // Sin locks: cada contador es exacto, el conjunto puede ir una operación atrasado
+    SizeHistogram::Counts counts[SizeHistogram::kBucketCount];
+    sizes.snapshot(counts);
+
+    SizeDistribution d{};
+    uint64_t totalFx = 0;
+    uint64_t activeFx = 0;
+    // Alloc y free se leen por separado: un free reciente puede verse antes
+    // que su alloc, así que las diferencias se recortan a cero
+    for (auto &c : counts)
+    {
+        c.freeCountFx = std::min(c.freeCountFx, c.allocCountFx);
+        c.freeBytes = std::min(c.freeBytes, c.allocBytes);
+        totalFx += c.allocCountFx;
+        activeFx += c.allocCountFx - c.freeCountFx;
+    }
 
-    std::lock_guard<std::mutex> lock(mtx);
-
-    AllocationInfo info;
-    info.address = ptr;
-    info.size = size;
-    info.file = file ? std::string(file) : "unknown";
-    info.line = line;
-    info.typeName = type ? std::string(type) : "unknown";
-    info.timestamp = std::chrono::high_resolution_clock::now();
+    // Cuantiles sobre el conteo acumulado en punto fijo
+    const uint64_t totalTargets[2] = {totalFx / 2, totalFx - totalFx / 100};
+    const uint64_t activeTargets[2] = {activeFx / 2, activeFx - activeFx / 100};
+    size_t *totalOut[2] = {&d.p50, &d.p99};
+    size_t *activeOut[2] = {&d.activeP50, &d.activeP99};
+    uint64_t totalSeen = 0;
+    uint64_t activeSeen = 0;
 
-    allocations[ptr] = std::move(info);
+    for (unsigned b = 0; b < SizeHistogram::kBucketCount; ++b)
+    {
+        const SizeHistogram::Counts &c = counts[b];
+        if (!c.allocCountFx)
+            continue;
 
-    ++totalAllocations;
-    ++activeAllocations;
-    currentMemory += size;
-    if (currentMemory > peakMemory)
-        peakMemory = currentMemory;
+        const uint64_t activeCountFx = c.allocCountFx - c.freeCountFx;
+        const size_t upper = static_cast<size_t>(SizeHistogram::bucketUpper(b));
+        for (int q = 0; q < 2; ++q)
+        {
+            if (totalSeen <= totalTargets[q] && totalSeen + c.allocCountFx > totalTargets[q])
+                *totalOut[q] = upper;
+            if (activeCountFx && activeSeen <= activeTargets[q] && activeSeen + activeCountFx > activeTargets[q])
+                *activeOut[q] = upper;
+        }
+        totalSeen += c.allocCountFx;
+        activeSeen += activeCountFx;
+
+        d.classes.push_back({static_cast<size_t>(SizeHistogram::bucketLower(b)),
+                             upper,
+                             static_cast<size_t>((c.allocCountFx + kWeightOne / 2) / kWeightOne),
+                             static_cast<size_t>(c.allocBytes),
+                             static_cast<size_t>((activeCountFx + kWeightOne / 2) / kWeightOne),
+                             static_cast<size_t>(c.allocBytes - c.freeBytes)});
+    }
+    return d;
+}
 
-    // Enviar actualización en tiempo real
-    if (remoteEnabled)
+// Valor del cuantil q en un histograma log-lineal, interpolando dentro del bucket
+template <typename Scale, size_t N>
+static double mt_histogram_quantile(const uint64_t (&counts)[N], uint64_t total, double q)
+{
+    const double target = q * static_cast<double>(total);
+    double seen = 0.0;
+    for (unsigned b = 0; b < N; ++b)
     {
-        sendLiveUpdate(ptr, size, true, file, line, type);
+        if (!counts[b])
+            continue;
+        const double next = seen + static_cast<double>(counts[b]);
+        if (next >= target)
+        {
+            const double lo = static_cast<double>(Scale::lower(b));
+            const double width = static_cast<double>(Scale::upper(b) - Scale::lower(b) + 1);
+            return lo + width * (target - seen) / static_cast<double>(counts[b]);
+        }
+        seen = next;
     }
-
-    MT_LOGLN("[TRK] ALLOC ptr=" << ptr << " size=" << size << " @" << (file ? file : "unknown") << ":" << line);
+    return static_cast<double>(Scale::upper(N - 1));
 }
 
-void MemoryTracker::unregisterAllocation(void *ptr)
+std::vector<MemoryTracker::LifetimeSummary> MemoryTracker::getLifetimeSummaries(std::chrono::microseconds shortLived)
 {
-    if (!ptr)
-        return;
-    if (g_mt_in_tracker)
-        return;
     ReentryGuard guard;
+    flushEvents();
 
-    std::lock_guard<std::mutex> lock(mtx);
+    using Scale = LifetimeTable::Scale;
+    const uint64_t thresholdNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(shortLived).count());
 
-    auto it = allocations.find(ptr);
-    if (it != allocations.end())
+    struct Ranked
+    {
+        LifetimeSummary summary;
+        double shortLivedFx;
+    };
+    TrackerVector<Ranked> ranked;
+
+    uint64_t counts[LifetimeTable::kBucketCount];
+    const uint32_t siteCount = interned.siteCount();
+    for (uint32_t siteId = 0; siteId < siteCount; ++siteId)
     {
-        currentMemory -= it->second.size;
-        if (activeAllocations > 0)
-            --activeAllocations;
-        allocations.erase(it);
+        if (!lifetimes.snapshot(siteId, counts))
+            continue;
 
-        // Enviar actualización en tiempo real
-        if (remoteEnabled)
+        uint64_t totalFx = 0;
+        double shortFx = 0.0;
+        for (unsigned b = 0; b < LifetimeTable::kBucketCount; ++b)
         {
-            sendLiveUpdate(ptr, 0, false, "", 0, "");
+            totalFx += counts[b];
+            // El bucket que contiene el umbral aporta la parte proporcional
+            if (Scale::upper(b) < thresholdNs)
+                shortFx += static_cast<double>(counts[b]);
+            else if (Scale::lower(b) < thresholdNs)
+                shortFx += static_cast<double>(counts[b]) * static_cast<double>(thresholdNs - Scale::lower(b)) /
+                           static_cast<double>(Scale::upper(b) - Scale::lower(b) + 1);
         }
-
-        MT_LOGLN("[TRK] FREE ptr=" << ptr);
+        if (!totalFx)
+            continue;
+
+        const InternTable::Site site = interned.site(siteId);
+        LifetimeSummary s;
+        s.file = interned.string(site.fileId);
+        s.line = site.line;
+        s.freedCount = static_cast<size_t>((totalFx + kWeightOne / 2) / kWeightOne);
+        s.medianUs = mt_histogram_quantile<Scale>(counts, totalFx, 0.50) / 1000.0;
+        s.p99Us = mt_histogram_quantile<Scale>(counts, totalFx, 0.99) / 1000.0;
+        s.shortLivedFraction = shortFx / static_cast<double>(totalFx);
+        ranked.push_back({std::move(s), shortFx});
     }
+
+    std::sort(ranked.begin(), ranked.end(),
+              [](const Ranked &a, const Ranked &b)
+              {
+                  return a.shortLivedFx > b.shortLivedFx;
+              });
+
+    std::vector<LifetimeSummary> result;
+    result.reserve(ranked.size());
+    for (auto &r : ranked)
+        result.push_back(std::move(r.summary));
+    return result;
 }
 
 //==================================================
-// Reportes y Estadísticas
+// Snapshots del heap
 //==================================================
-MemoryTracker::Stats MemoryTracker::getCurrentStats()
+MemoryTracker::HeapSnapshot MemoryTracker::takeSnapshot()
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    return {totalAllocations, activeAllocations, currentMemory, peakMemory};
+    ReentryGuard guard;
+    flushEvents();
+    std::lock_guard<std::mutex> lock(snapshotsMtx);
+
+    // Primero la generación y después el sello: todo evento con sello
+    // posterior queda etiquetado con esta generación o una mayor
+    journal.setEnabled(true);
+    HeapSnapshot snap;
+    snap.id = journal.advance();
+    snap.stamp = clock.now() & TscClock::kStampMask;
+    snap.timestamp_ms = toWallClockMs(snap.stamp);
+    snap.stats = loadStats();
+    snapshots.push_back(snap);
+    return snap;
 }
 
-MemoryTracker::Report MemoryTracker::collectReport()
+void MemoryTracker::releaseSnapshot(uint32_t id)
 {
     ReentryGuard guard;
-    std::lock_guard<std::mutex> lock(mtx);
+    std::lock_guard<std::mutex> lock(snapshotsMtx);
 
-    Report r;
-    r.stats = {totalAllocations, activeAllocations, currentMemory, peakMemory};
-    r.leaks.reserve(allocations.size());
+    snapshots.erase(std::remove_if(snapshots.begin(), snapshots.end(),
+                                   [id](const HeapSnapshot &s)
+                                   { return s.id == id; }),
+                    snapshots.end());
 
-    for (const auto &kv : allocations)
+    // Sin snapshots el diario deja de escribirse y se vacía
+    if (snapshots.empty())
     {
-        const auto &info = kv.second;
-        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            info.timestamp.time_since_epoch())
-                            .count();
-
-        ReportEntry e;
-        e.address = info.address;
-        e.size = info.size;
-        e.file = info.file;
-        e.line = info.line;
-        e.typeName = info.typeName;
-        e.timestamp_ms = ms;
+        journal.setEnabled(false);
+        journal.trim(UINT32_MAX);
+    }
+    else
+    {
+        journal.trim(snapshots.front().id);
+    }
+}
 
-        r.leaks.push_back(std::move(e));
+bool MemoryTracker::findSnapshot(uint32_t id, HeapSnapshot &out)
+{
+    std::lock_guard<std::mutex> lock(snapshotsMtx);
+    for (const HeapSnapshot &s : snapshots)
+    {
+        if (s.id == id)
+        {
+            out = s;
+            return true;
+        }
     }
-    return r;
+    return false;
 }
 
-std::vector<MemoryTracker::FileSummary> MemoryTracker::getFileSummaries()
+MemoryTracker::HeapDiff MemoryTracker::diff(const HeapSnapshot &a, const HeapSnapshot &b)
 {
     ReentryGuard guard;
-    std::lock_guard<std::mutex> lock(mtx);
+    flushEvents();
 
-    std::map<std::string, FileSummary> fileMap;
+    const HeapSnapshot &from = a.id <= b.id ? a : b;
+    const HeapSnapshot &to = a.id <= b.id ? b : a;
 
-    for (const auto &kv : allocations)
+    // Clave: sitio, tipo y clase de tamaño. appeared lleva signo: los
+    // bloques que nacen y mueren entre los dos snapshots se cancelan.
+    struct Accumulator
     {
-        const auto &info = kv.second;
-        std::string filename = info.file.empty() ? "unknown" : info.file;
-
-        if (fileMap.find(filename) == fileMap.end())
+        uint32_t siteId;
+        uint32_t typeId;
+        unsigned bucket;
+        int64_t appearedFx = 0;
+        int64_t appearedBytes = 0;
+        uint64_t disappearedFx = 0;
+        uint64_t disappearedBytes = 0;
+    };
+    std::unordered_map<uint64_t, Accumulator, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                       SlabAllocator<std::pair<const uint64_t, Accumulator>>>
+        byKey;
+
+    HeapDiff d{};
+    d.fromId = from.id;
+    d.toId = to.id;
+    {
+        std::lock_guard<std::mutex> lock(snapshotsMtx);
+        bool fromLive = false;
+        bool toLive = false;
+        for (const HeapSnapshot &s : snapshots)
         {
-            fileMap[filename] = {filename, 0, 0, 0, 0};
+            fromLive |= s.id == from.id;
+            toLive |= s.id == to.id;
         }
-
-        fileMap[filename].allocationCount++;
-        fileMap[filename].totalMemory += info.size;
-        fileMap[filename].leakCount++;
-        fileMap[filename].leakedMemory += info.size;
+        d.complete = fromLive && toLive && !journal.overflowed();
+
+        // Un evento con sello anterior a `to` puede tomar la etiqueta
+        // siguiente si otro snapshot se abrió en el medio
+        journal.forEach(from.id, to.id + 1,
+                        [&](const ChangeJournal::Change &c)
+                        {
+                            if (TscClock::notAfter(c.stamp, from.stamp) || !TscClock::notAfter(c.stamp, to.stamp))
+                                return;
+
+                            const unsigned bucket = SizeHistogram::bucketOf(c.size);
+                            const uint64_t key = (uint64_t(c.siteId) << 32) | (uint64_t(c.typeId) << 16) | bucket;
+                            auto it = byKey.find(key);
+                            if (it == byKey.end())
+                                it = byKey.emplace(key, Accumulator{c.siteId, static_cast<uint32_t>(c.typeId), bucket}).first;
+                            Accumulator &acc = it->second;
+
+                            const bool freed = (c.flags & ChangeJournal::Change::kFreed) != 0;
+                            const Weight w = weightOf(c.size, static_cast<uint16_t>(c.flags & ~ChangeJournal::Change::kFreed));
+                            if (!freed)
+                            {
+                                acc.appearedFx += static_cast<int64_t>(w.countFx);
+                                acc.appearedBytes += static_cast<int64_t>(w.bytes);
+                            }
+                            else if (TscClock::notAfter(c.allocStamp, from.stamp))
+                            {
+                                acc.disappearedFx += w.countFx;
+                                acc.disappearedBytes += w.bytes;
+                            }
+                            else
+                            {
+                                acc.appearedFx -= static_cast<int64_t>(w.countFx);
+                                acc.appearedBytes -= static_cast<int64_t>(w.bytes);
+                            }
+                        });
     }
 
-    std::vector<FileSummary> result;
-    for (const auto &pair : fileMap)
+    for (const auto &pair : byKey)
     {
-        result.push_back(pair.second);
+        const Accumulator &acc = pair.second;
+        const uint64_t appearedFx = acc.appearedFx > 0 ? static_cast<uint64_t>(acc.appearedFx) : 0;
+        const uint64_t appearedBytes = acc.appearedBytes > 0 ? static_cast<uint64_t>(acc.appearedBytes) : 0;
+        if (!appearedFx && !acc.disappearedFx)
+            continue;
+
+        const InternTable::Site site = interned.site(acc.siteId);
+        HeapDiffEntry e;
+        e.file = interned.string(site.fileId);
+        e.line = site.line;
+        e.typeName = interned.string(acc.typeId);
+        e.minSize = static_cast<size_t>(SizeHistogram::bucketLower(acc.bucket));
+        e.maxSize = static_cast<size_t>(SizeHistogram::bucketUpper(acc.bucket));
+        e.appearedCount = countOf(appearedFx);
+        e.appearedBytes = static_cast<size_t>(appearedBytes);
+        e.disappearedCount = countOf(acc.disappearedFx);
+        e.disappearedBytes = static_cast<size_t>(acc.disappearedBytes);
+
+        d.appearedCount += e.appearedCount;
+        d.appearedBytes += e.appearedBytes;
+        d.disappearedCount += e.disappearedCount;
+        d.disappearedBytes += e.disappearedBytes;
+        d.entries.push_back(std::move(e));
     }
 
-    // Ordenar por memoria total (descendente)
-    std::sort(result.begin(), result.end(),
-              [](const FileSummary &a, const FileSummary &b)
+    std::sort(d.entries.begin(), d.entries.end(),
+              [](const HeapDiffEntry &x, const HeapDiffEntry &y)
               {
-                  return a.totalMemory > b.totalMemory;
+                  return static_cast<long long>(x.appearedBytes) - static_cast<long long>(x.disappearedBytes) >
+                         static_cast<long long>(y.appearedBytes) - static_cast<long long>(y.disappearedBytes);
               });
-
-    return result;
+    return d;
 }
 
 void MemoryTracker::reportLeaks()
+{
+    reportLeaks(std::cout);
+}
+
+void MemoryTracker::reportLeaks(std::ostream &out)
 {
 #ifndef MT_SILENT_REPORT
     if (g_mt_in_tracker)
@@ -254,85 +2153,274 @@ void MemoryTracker::reportLeaks()
 
     Report r = collectReport();
 
-    std::cout << "\n=== Memory Report ===\n";
-    std::cout << "Total allocations: " << r.stats.totalAllocations << "\n";
-    std::cout << "Active allocations: " << r.stats.activeAllocations << "\n";
-    std::cout << "Peak memory usage: " << r.stats.peakMemory << " bytes\n";
-    std::cout << "Current memory: " << r.stats.currentMemory << " bytes\n";
+    out << "\n=== Memory Report ===\n";
+    out << "Total allocations: " << r.stats.totalAllocations << "\n";
+    out << "Active allocations: " << r.stats.activeAllocations << "\n";
+    out << "Peak memory usage: " << r.stats.peakMemory << " bytes\n";
+    out << "Current memory: " << r.stats.currentMemory << " bytes\n";
+    out << "Tracker overhead: " << r.stats.trackerOverhead << " bytes\n";
+    if (r.stats.headerOverhead)
+        out << "Inline header overhead: " << r.stats.headerOverhead << " bytes\n";
+
+    const Footprint fp = getFootprint(true);
+    out << "Allocator slack (usable - requested): " << fp.slackBytes << " bytes\n";
+    if (fp.rssBytes)
+    {
+        out << "RSS: " << fp.rssBytes << " bytes | heap committed: " << fp.heapCommitted
+                  << " bytes | heap in use: " << fp.heapInUse << " bytes\n";
+    }
+    if (fp.livePages)
+    {
+        out << "Live pages: " << fp.livePages << " (" << fp.pageOccupancy * 100.0 << "% occupied)\n";
+    }
 
-    if (r.leaks.empty())
+    const SizeDistribution dist = getSizeDistribution();
+    out << "Allocation size p50/p99: " << dist.p50 << " / " << dist.p99
+              << " bytes (live: " << dist.activeP50 << " / " << dist.activeP99 << ")\n";
+    if (r.stats.sampleInterval)
     {
-        std::cout << "[MemoryTracker] No leaks detected.\n";
-        return;
+        out << "Sampling: 1 sample every ~" << r.stats.sampleInterval
+                  << " bytes (figures above are estimates)\n";
+    }
+    if (r.stats.sizeMismatches || r.stats.alignMismatches)
+    {
+        out << "Mismatched deletes: " << r.stats.sizeMismatches << " wrong size, "
+                  << r.stats.alignMismatches << " wrong alignment form\n";
     }
 
-    std::cout << "[MemoryTracker] Memory leaks detected (" << r.leaks.size() << "):\n";
-    for (const auto &e : r.leaks)
+    const auto churn = getLifetimeSummaries();
+    if (!churn.empty() && churn.front().shortLivedFraction > 0.0)
+    {
+        out << "Short-lived churn (freed within 10us):\n";
+        for (size_t i = 0; i < churn.size() && i < 5 && churn[i].shortLivedFraction > 0.0; ++i)
+        {
+            out << "  " << churn[i].file << ":" << churn[i].line
+                      << " | freed: " << churn[i].freedCount
+                      << " | <10us: " << churn[i].shortLivedFraction * 100.0 << "%"
+                      << " | median: " << churn[i].medianUs << "us"
+                      << " | p99: " << churn[i].p99Us << "us\n";
+        }
+    }
+
+    const auto threads = getThreadSummaries();
+    if (threads.size() > 1 || r.stats.crossThreadFrees)
     {
-        std::cout << "  Leak at " << e.address
+        out << "Threads (" << r.stats.crossThreadFrees << " blocks freed by another thread):\n";
+        for (size_t i = 0; i < threads.size() && i < 5; ++i)
+        {
+            out << "  #" << threads[i].threadId << " " << threads[i].name
+                      << " | live: " << threads[i].liveMemory << " bytes in " << threads[i].liveCount
+                      << " | total: " << threads[i].totalMemory
+                      << " | freed elsewhere: " << threads[i].crossThreadFrees
+                      << " | freed for others: " << threads[i].remoteFrees << "\n";
+        }
+    }
+
+    // Solo si la aplicación usa MT_SCOPE: sin tags todo cae en tagId 0
+    const auto tags = getTagSummaries();
+    if (!tags.empty() && (tags.size() > 1 || tags.front().tagId != 0))
+    {
+        out << "Memory by scope tag:\n";
+        for (const auto &tag : tags)
+        {
+            out << "  " << tag.name
+                      << " | live: " << tag.liveMemory << " bytes in " << tag.liveCount
+                      << " | peak: " << tag.peakMemory
+                      << " | total: " << tag.totalMemory << " bytes in " << tag.allocationCount << "\n";
+        }
+    }
+
+    auto printEntry = [&out](const char *label, const ReportEntry &e)
+    {
+        out << "  " << label << " at " << e.address
                   << " | size: " << e.size
                   << " | type: " << e.typeName
                   << " | file: " << e.file << ":" << e.line
-                  << " | ts(ms): " << e.timestamp_ms
-                  << "\n";
+                  << " | ts(ms): " << e.timestamp_ms;
+        if (e.weight != 1.0)
+            out << " | weight: " << e.weight;
+        if (e.threadId)
+            out << " | thread: #" << e.threadId;
+        if (!e.tag.empty())
+            out << " | tag: " << e.tag;
+        if (e.stackId != StackTable::kNoStack)
+            out << " | stack: #" << e.stackId << " at " << e.location;
+        out << "\n";
+    };
+
+    if (leakScanOnReport.load(std::memory_order_relaxed))
+    {
+        const LeakScan scan = scanLeaks();
+        if (scan.scanned)
+        {
+            out << "Leak scan: " << scan.stoppedThreads << " threads stopped, "
+                      << scan.workerThreads << " workers, " << scan.seconds * 1000.0 << " ms"
+                      << (scan.complete ? "" : " (incomplete: some threads did not stop)") << "\n";
+            out << "  definitely lost: " << scan.definitelyLostBytes << " bytes in "
+                      << scan.definitelyLostCount << " blocks\n";
+            out << "  indirectly lost: " << scan.indirectlyLostBytes << " bytes in "
+                      << scan.indirectlyLostCount << " blocks\n";
+            out << "  still reachable: " << scan.reachableBytes << " bytes in "
+                      << scan.reachableCount << " blocks\n";
+
+            if (scan.definitelyLost.empty() && scan.indirectlyLost.empty())
+            {
+                out << "[MemoryTracker] No leaks detected.\n";
+                return;
+            }
+            out << "[MemoryTracker] Memory leaks detected ("
+                      << scan.definitelyLost.size() + scan.indirectlyLost.size() << "):\n";
+            for (const auto &e : scan.definitelyLost)
+                printEntry("Leak", e);
+            for (const auto &e : scan.indirectlyLost)
+                printEntry("Indirect leak", e);
+            return;
+        }
+        out << "Leak scan: not supported on this platform, listing every live block\n";
+    }
+
+    if (r.leaks.empty())
+    {
+        out << "[MemoryTracker] No leaks detected.\n";
+        return;
     }
+
+    out << "[MemoryTracker] Memory leaks detected (" << r.leaks.size() << "):\n";
+    for (const auto &e : r.leaks)
+        printEntry("Leak", e);
 #endif
 }
 
 //==================================================
-// Integración con Socket Client
+// Reporte remoto
 //==================================================
-void MemoryTracker::enableRemoteReporting(const QString &host, quint16 port)
+void MemoryTracker::enableRemoteReporting(const char *host, uint16_t port)
 {
     if (g_mt_in_tracker)
         return;
     ReentryGuard guard;
 
-    if (!socketClient)
+    remoteEnabled.store(true, std::memory_order_relaxed);
+
+    if (!socketClient.connectToServer(host, port))
     {
-        socketClient = new Client();
+        MT_LOGLN("[MT] Failed to connect to remote server");
+        return;
     }
+    MT_LOGLN("[MT] Connected to remote server: " << host << ":" << port);
 
-    remoteEnabled = true;
-
-    if (socketClient->connectToServer(host, port))
+    if (!reporterThread.joinable())
     {
-        MT_LOGLN("[MT] Connected to remote server: " << host.toStdString() << ":" << port);
-        setupPeriodicUpdates();
+        reporterStop.store(false, std::memory_order_relaxed);
+        reporterThread = std::thread([this]()
+                                     { reporterLoop(); });
     }
-    else
+}
+
+void MemoryTracker::disableRemoteReporting()
+{
+    remoteEnabled.store(false, std::memory_order_relaxed);
+    stopReporter();
+    socketClient.disconnectFromServer();
+}
+
+bool MemoryTracker::isRemoteConnected() const
+{
+    return remoteEnabled && socketClient.isConnected();
+}
+
+void MemoryTracker::setReportPeriods(const ReportPeriods &periods)
+{
     {
-        MT_LOGLN("[MT] Failed to connect to remote server");
+        std::lock_guard<std::mutex> lock(reporterMtx);
+        reportPeriods = periods;
     }
+    socketClient.wake();
 }
 
-void MemoryTracker::disableRemoteReporting()
+// Antes de salir el reporter escribe lo que haya quedado en cola
+void MemoryTracker::stopReporter()
 {
-    remoteEnabled = false;
-    if (updateTimer)
+    if (reporterThread.joinable())
     {
-        updateTimer->stop();
+        reporterStop.store(true, std::memory_order_release);
+        socketClient.wake();
+        reporterThread.join();
     }
 }
 
-bool MemoryTracker::isRemoteConnected() const
+void MemoryTracker::sendPacket(const char *keyword, const char *data, size_t size)
 {
-    return remoteEnabled && socketClient && socketClient->isConnected();
+    // El paquete armado y la cola son memoria del tracker
+    ReentryGuard guard;
+    socketClient.send(keyword, data, size);
 }
 
-void MemoryTracker::setupPeriodicUpdates()
+// El ciclo corre sin ReentryGuard: los send*() y handleRemoteCommand() lo
+// necesitan libre, igual que cuando los llama la aplicación. Solo la
+// espera en el socket (que arma los pedidos recibidos) va con guard.
+void MemoryTracker::reporterLoop()
 {
-    if (!updateTimer)
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point nextMetrics = Clock::now();
+    Clock::time_point nextTimeline = nextMetrics;
+    Clock::time_point nextDetails = nextMetrics;
+    std::vector<std::pair<std::string, std::string>> commands;
+
+    while (!reporterStop.load(std::memory_order_acquire))
     {
-        updateTimer = new QTimer();
-        QObject::connect(updateTimer, &QTimer::timeout, [this]()
-                         {
-            if (remoteEnabled) {
+        ReportPeriods periods;
+        {
+            std::lock_guard<std::mutex> lock(reporterMtx);
+            periods = reportPeriods;
+        }
+
+        Clock::time_point now = Clock::now();
+        if (remoteEnabled.load(std::memory_order_relaxed))
+        {
+            if (now >= nextMetrics)
+            {
                 sendGeneralMetrics();
+                nextMetrics = now + periods.metrics;
+            }
+            if (now >= nextTimeline)
+            {
                 sendTimelinePoint();
-            } });
+                nextTimeline = now + periods.timeline;
+            }
+            if (now >= nextDetails)
+            {
+                sendSizeHistogram();
+                sendThreadAllocations();
+                sendTagAllocations();
+                nextDetails = now + periods.details;
+            }
+        }
+
+        // Un período acortado con setReportPeriods() rige desde ya
+        now = Clock::now();
+        nextMetrics = std::min(nextMetrics, now + periods.metrics);
+        nextTimeline = std::min(nextTimeline, now + periods.timeline);
+        nextDetails = std::min(nextDetails, now + periods.details);
+        const auto wait = std::chrono::ceil<std::chrono::milliseconds>(std::min({nextMetrics, nextTimeline, nextDetails}) - now);
+
+        {
+            ReentryGuard guard;
+            socketClient.pump(std::max(wait, std::chrono::milliseconds(0)), [&commands](const std::string &keyword, const std::string &data)
+                              { commands.emplace_back(keyword, data); });
+        }
+        for (const auto &command : commands)
+            handleRemoteCommand(command.first, command.second);
+        if (!commands.empty())
+        {
+            ReentryGuard guard;
+            commands.clear();
+        }
     }
-    updateTimer->start(1000); // Actualizar cada segundo
+
+    // Lo que quedó en cola, p. ej. el reporte final del destructor
+    ReentryGuard guard;
+    socketClient.flush(std::chrono::milliseconds(1000));
 }
 
 //==================================================
@@ -343,7 +2431,7 @@ void MemoryTracker::sendLiveUpdate(void *ptr, size_t size, bool isAlloc, const c
     if (!isRemoteConnected() || g_mt_in_tracker)
         return;
 
-    std::stringstream data;
+    TrackerStream data;
     if (isAlloc)
     {
         data << "ALLOC|"
@@ -351,15 +2439,15 @@ void MemoryTracker::sendLiveUpdate(void *ptr, size_t size, bool isAlloc, const c
              << size << "|"
              << (file ? file : "unknown") << "|"
              << line << "|"
-             << (type ? type : "unknown");
+             << mt_wire_field(type ? type : "unknown");
     }
     else
     {
         data << "FREE|" << reinterpret_cast<uintptr_t>(ptr);
     }
 
-    std::string dataStr = data.str();
-    socketClient->send("LIVE_UPDATE", QByteArray(dataStr.c_str(), dataStr.size()));
+    const auto dataStr = data.str();
+    sendPacket("LIVE_UPDATE", dataStr.data(), dataStr.size());
 }
 
 void MemoryTracker::sendGeneralMetrics()
@@ -368,16 +2456,36 @@ void MemoryTracker::sendGeneralMetrics()
         return;
 
     auto stats = getCurrentStats();
-    std::stringstream data;
+
+    // La ocupación de páginas recorre el heap entero: cada 10 s alcanza
+    const auto now = std::chrono::steady_clock::now();
+    const bool refresh = now - occupancyRefreshed >= std::chrono::seconds(10);
+    Footprint fp = getFootprint(refresh);
+    if (refresh)
+    {
+        occupancyRefreshed = now;
+        cachedLivePages = fp.livePages;
+        cachedOccupancy = fp.pageOccupancy;
+    }
+
+    TrackerStream data;
     data << "METRICS|"
          << stats.totalAllocations << "|"
          << stats.activeAllocations << "|"
          << stats.currentMemory << "|"
          << stats.peakMemory << "|"
-         << totalLeakedMemory;
-
-    std::string dataStr = data.str();
-    socketClient->send("GENERAL_METRICS", QByteArray(dataStr.c_str(), dataStr.size()));
+         << totalLeakedMemory << "|"
+         << stats.trackerOverhead << "|"
+         << stats.sampleInterval << "|"
+         << fp.slackBytes << "|"
+         << fp.rssBytes << "|"
+         << fp.heapCommitted << "|"
+         << fp.heapInUse << "|"
+         << cachedLivePages << "|"
+         << cachedOccupancy;
+
+    const auto dataStr = data.str();
+    sendPacket("GENERAL_METRICS", dataStr.data(), dataStr.size());
 }
 
 void MemoryTracker::sendMemoryMap()
@@ -385,26 +2493,28 @@ void MemoryTracker::sendMemoryMap()
     if (!isRemoteConnected() || g_mt_in_tracker)
         return;
 
-    std::lock_guard<std::mutex> lock(mtx);
+    flushEvents();
 
-    std::stringstream data;
-    data << "MEMORY_MAP_START|" << allocations.size();
+    // El texto se arma sobre la copia, sin ningún shard bloqueado
+    const AllocationTable::Snapshot live = allocations.snapshot(activeAllocationsFx.load(std::memory_order_relaxed) / kWeightOne);
+    TrackerStream data;
+    data << "MEMORY_MAP_START|" << live.size();
 
-    for (const auto &kv : allocations)
+    for (const AllocationInfo &info : live)
     {
-        const auto &info = kv.second;
+        const InternTable::Site site = interned.site(info.siteId);
         data << "|BLOCK|"
              << reinterpret_cast<uintptr_t>(info.address) << "|"
              << info.size << "|"
-             << info.typeName << "|"
-             << info.file << "|"
-             << info.line;
+             << mt_wire_field(interned.string(info.typeId)) << "|"
+             << interned.string(site.fileId) << "|"
+             << site.line;
     }
 
     data << "|MEMORY_MAP_END";
 
-    std::string dataStr = data.str();
-    socketClient->send("MEMORY_MAP", QByteArray(dataStr.c_str(), dataStr.size()));
+    const auto dataStr = data.str();
+    sendPacket("MEMORY_MAP", dataStr.data(), dataStr.size());
 }
 
 void MemoryTracker::sendFileAllocations()
@@ -413,7 +2523,7 @@ void MemoryTracker::sendFileAllocations()
         return;
 
     auto summaries = getFileSummaries();
-    std::stringstream data;
+    TrackerStream data;
     data << "FILE_SUMMARY_START|" << summaries.size();
 
     for (const auto &summary : summaries)
@@ -428,8 +2538,58 @@ void MemoryTracker::sendFileAllocations()
 
     data << "|FILE_SUMMARY_END";
 
-    std::string dataStr = data.str();
-    socketClient->send("FILE_ALLOCATIONS", QByteArray(dataStr.c_str(), dataStr.size()));
+    const auto dataStr = data.str();
+    sendPacket("FILE_ALLOCATIONS", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::sendStackAllocations()
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    auto summaries = getStackSummaries();
+    TrackerStream data;
+    data << "STACK_SUMMARY_START|" << summaries.size();
+
+    // Los frames van en un solo campo separado por ';': la dirección en
+    // decimal y, si ya se simbolizó, "=función (archivo:línea)"
+    for (const auto &summary : summaries)
+    {
+        data << "|STACK|"
+             << summary.stackId << "|"
+             << summary.allocationCount << "|"
+             << summary.totalMemory << "|";
+        for (size_t i = 0; i < summary.frames.size(); ++i)
+        {
+            if (i)
+                data << ";";
+            data << reinterpret_cast<uintptr_t>(summary.frames[i]);
+
+            Symbolizer::Location loc;
+            if (symbolizer.cached(summary.frames[i], loc) && loc.resolved)
+                data << "=" << mt_wire_field(Symbolizer::format(summary.frames[i], loc));
+        }
+    }
+
+    data << "|STACK_SUMMARY_END";
+
+    const auto dataStr = data.str();
+    sendPacket("STACK_ALLOCATIONS", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::sendModuleMap()
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    // Texto tal cual de Symbolizer::moduleMap(), una línea por módulo
+    TrackerString dataStr;
+    {
+        ReentryGuard guard;
+        symbolizer.loadProcessModules();
+        dataStr = symbolizer.moduleMap();
+    }
+    sendPacket("MODULE_MAP", dataStr.data(), dataStr.size());
 }
 
 void MemoryTracker::sendLeakReport()
@@ -438,12 +2598,21 @@ void MemoryTracker::sendLeakReport()
         return;
 
     auto report = collectReport();
-    auto fileSummaries = getFileSummaries();
+    auto fileSummaries = getTopFiles(1);
+
+    // Con muestreo el encabezado lleva estimaciones; la lista trae solo las muestras
+    double estimatedLeaks = 0.0;
+    double estimatedLeakedBytes = 0.0;
+    for (const auto &leak : report.leaks)
+    {
+        estimatedLeaks += leak.weight;
+        estimatedLeakedBytes += leak.weight * static_cast<double>(leak.size);
+    }
 
-    std::stringstream data;
+    TrackerStream data;
     data << "LEAK_REPORT|"
-         << report.leaks.size() << "|"
-         << totalLeakedMemory << "|";
+         << std::llround(estimatedLeaks) << "|"
+         << std::llround(estimatedLeakedBytes) << "|";
 
     // Leak más grande
     if (!report.leaks.empty())
@@ -478,12 +2647,267 @@ void MemoryTracker::sendLeakReport()
              << leak.file << "|"
              << leak.line << "|"
              << leak.typeName << "|"
-             << leak.timestamp_ms;
+             << leak.timestamp_ms << "|"
+             << mt_wire_field(leak.location);
     }
     data << "|LEAKS_END";
 
-    std::string dataStr = data.str();
-    socketClient->send("LEAK_REPORT", QByteArray(dataStr.c_str(), dataStr.size()));
+    const auto dataStr = data.str();
+    sendPacket("LEAK_REPORT", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::sendSizeHistogram()
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    auto dist = getSizeDistribution();
+    TrackerStream data;
+    data << "SIZE_HISTOGRAM|"
+         << dist.p50 << "|"
+         << dist.p99 << "|"
+         << dist.activeP50 << "|"
+         << dist.activeP99 << "|"
+         << dist.classes.size();
+
+    for (const auto &c : dist.classes)
+    {
+        data << "|CLASS|"
+             << c.minSize << "|"
+             << c.maxSize << "|"
+             << c.totalAllocations << "|"
+             << c.totalBytes << "|"
+             << c.activeAllocations << "|"
+             << c.activeBytes;
+    }
+
+    data << "|SIZE_HISTOGRAM_END";
+
+    const auto dataStr = data.str();
+    sendPacket("SIZE_HISTOGRAM", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::sendLifetimeSummary(std::chrono::microseconds shortLived)
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    auto summaries = getLifetimeSummaries(shortLived);
+    TrackerStream data;
+    data << "LIFETIME_SUMMARY_START|" << summaries.size() << "|" << shortLived.count();
+
+    for (const auto &summary : summaries)
+    {
+        data << "|SITE|"
+             << summary.file << "|"
+             << summary.line << "|"
+             << summary.freedCount << "|"
+             << summary.medianUs << "|"
+             << summary.p99Us << "|"
+             << summary.shortLivedFraction;
+    }
+
+    data << "|LIFETIME_SUMMARY_END";
+
+    const auto dataStr = data.str();
+    sendPacket("LIFETIME_SUMMARY", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::sendThreadAllocations()
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    constexpr size_t kMaxSites = 10;
+    const auto threads = getThreadSummaries();
+    auto sites = getSiteSummaries();
+    sites.erase(std::remove_if(sites.begin(), sites.end(),
+                               [](const SiteSummary &site)
+                               { return site.crossThreadFrees == 0; }),
+                sites.end());
+    std::sort(sites.begin(), sites.end(),
+              [](const SiteSummary &a, const SiteSummary &b)
+              {
+                  return a.crossThreadFrees > b.crossThreadFrees;
+              });
+    if (sites.size() > kMaxSites)
+        sites.resize(kMaxSites);
+
+    TrackerStream data;
+    data << "THREAD_ALLOCATIONS_START|" << threads.size() << "|" << sites.size();
+
+    for (const auto &thread : threads)
+    {
+        data << "|THREAD|"
+             << thread.threadId << "|"
+             << thread.osThreadId << "|"
+             << mt_wire_field(thread.name) << "|"
+             << thread.allocationCount << "|"
+             << thread.totalMemory << "|"
+             << thread.liveCount << "|"
+             << thread.liveMemory << "|"
+             << thread.freedCount << "|"
+             << thread.peakMemory << "|"
+             << thread.crossThreadFrees << "|"
+             << thread.remoteFrees;
+    }
+
+    // Sitios con más bloques liberados en otro hilo
+    for (const auto &site : sites)
+    {
+        data << "|SITE|"
+             << site.file << "|"
+             << site.line << "|"
+             << site.crossThreadFrees << "|"
+             << site.freedCount;
+    }
+
+    data << "|THREAD_ALLOCATIONS_END";
+
+    const auto dataStr = data.str();
+    sendPacket("THREAD_ALLOCATIONS", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::sendTagAllocations()
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    const auto tags = getTagSummaries();
+    TrackerStream data;
+    data << "TAG_ALLOCATIONS_START|" << tags.size();
+
+    for (const auto &tag : tags)
+    {
+        data << "|TAG|"
+             << tag.tagId << "|"
+             << mt_wire_field(tag.name) << "|"
+             << tag.allocationCount << "|"
+             << tag.totalMemory << "|"
+             << tag.liveCount << "|"
+             << tag.liveMemory << "|"
+             << tag.freedCount << "|"
+             << tag.peakMemory;
+    }
+
+    data << "|TAG_ALLOCATIONS_END";
+
+    const auto dataStr = data.str();
+    sendPacket("TAG_ALLOCATIONS", dataStr.data(), dataStr.size());
+}
+
+// Desde el hilo de presupuestos, que corre dentro del tracker
+void MemoryTracker::sendBudgetAlert(const BudgetAlert &alert)
+{
+    if (!isRemoteConnected())
+        return;
+
+    TrackerStream data;
+    data << "BUDGET|"
+         << alert.budgetId << "|"
+         << mt_wire_field(alert.file) << "|"
+         << alert.line << "|"
+         << alert.limitBytes << "|"
+         << alert.liveBytes << "|"
+         << alert.timestamp_ms << "|"
+         << alert.topSites.size();
+
+    for (const auto &site : alert.topSites)
+    {
+        data << "|SITE|"
+             << mt_wire_field(site.file) << "|"
+             << site.line << "|"
+             << site.liveMemory << "|"
+             << site.liveCount;
+    }
+
+    const auto dataStr = data.str();
+    sendPacket("BUDGET_ALERT", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::sendSnapshotDiff(uint32_t fromId, uint32_t toId)
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    HeapSnapshot from{};
+    HeapSnapshot to{};
+    const bool fromFound = findSnapshot(fromId, from);
+    const bool temporary = toId == 0;
+    if (temporary)
+        to = takeSnapshot();
+    const bool toFound = temporary || findSnapshot(toId, to);
+
+    TrackerStream data;
+    if (!fromFound || !toFound)
+    {
+        data << "SNAPSHOT_DIFF_START|" << fromId << "|" << toId << "|0|0|0|0|0|0|SNAPSHOT_DIFF_END";
+    }
+    else
+    {
+        const HeapDiff d = diff(from, to);
+        data << "SNAPSHOT_DIFF_START|"
+             << d.fromId << "|"
+             << d.toId << "|"
+             << (d.complete ? 1 : 0) << "|"
+             << d.appearedCount << "|"
+             << d.appearedBytes << "|"
+             << d.disappearedCount << "|"
+             << d.disappearedBytes << "|"
+             << d.entries.size();
+
+        for (const auto &e : d.entries)
+        {
+            data << "|CHANGE|"
+                 << mt_wire_field(e.file) << "|"
+                 << e.line << "|"
+                 << mt_wire_field(e.typeName) << "|"
+                 << e.minSize << "|"
+                 << e.maxSize << "|"
+                 << e.appearedCount << "|"
+                 << e.appearedBytes << "|"
+                 << e.disappearedCount << "|"
+                 << e.disappearedBytes;
+        }
+        data << "|SNAPSHOT_DIFF_END";
+    }
+
+    if (temporary)
+        releaseSnapshot(to.id);
+
+    const auto dataStr = data.str();
+    sendPacket("SNAPSHOT_DIFF", dataStr.data(), dataStr.size());
+}
+
+void MemoryTracker::handleRemoteCommand(const std::string &keyword, const std::string &args)
+{
+    if (!isRemoteConnected() || g_mt_in_tracker)
+        return;
+
+    const unsigned long first = std::strtoul(args.c_str(), nullptr, 10);
+    const size_t sep = args.find('|');
+    const unsigned long second = sep == std::string::npos ? 0 : std::strtoul(args.c_str() + sep + 1, nullptr, 10);
+
+    if (keyword == "SNAPSHOT_TAKE")
+    {
+        const HeapSnapshot snap = takeSnapshot();
+        TrackerStream data;
+        data << "SNAPSHOT|"
+             << snap.id << "|"
+             << snap.timestamp_ms << "|"
+             << snap.stats.activeAllocations << "|"
+             << snap.stats.currentMemory;
+        const auto dataStr = data.str();
+        sendPacket("SNAPSHOT_TAKEN", dataStr.data(), dataStr.size());
+    }
+    else if (keyword == "SNAPSHOT_DIFF")
+    {
+        sendSnapshotDiff(static_cast<uint32_t>(first), static_cast<uint32_t>(second));
+    }
+    else if (keyword == "SNAPSHOT_RELEASE")
+    {
+        releaseSnapshot(static_cast<uint32_t>(first));
+    }
 }
 
 void MemoryTracker::sendTimelinePoint()
@@ -492,16 +2916,20 @@ void MemoryTracker::sendTimelinePoint()
         return;
 
     auto stats = getCurrentStats();
+    const Footprint fp = getFootprint();
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
                    std::chrono::system_clock::now().time_since_epoch())
                    .count();
 
-    std::stringstream data;
+    // Lo pedido, lo que el allocator retiene además y lo que cobra el SO
+    TrackerStream data;
     data << "TIMELINE|"
          << now << "|"
          << stats.currentMemory << "|"
-         << stats.activeAllocations;
+         << stats.activeAllocations << "|"
+         << fp.rssBytes << "|"
+         << (fp.heapCommitted > fp.requestedBytes ? fp.heapCommitted - fp.requestedBytes : 0);
 
-    std::string dataStr = data.str();
-    socketClient->send("TIMELINE_POINT", QByteArray(dataStr.c_str(), dataStr.size()));
+    const auto dataStr = data.str();
+    sendPacket("TIMELINE_POINT", dataStr.data(), dataStr.size());
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "SiteStatsTable.h"
+
+//==================================================
+// Registro
+//==================================================
+bool SiteStatsTable::recordAlloc(uint32_t id, uint64_t countFx, uint64_t bytes, uint64_t slackFx) noexcept
+{
+    Entry *e = entries.get(id);
+    if (!e)
+        return false;
+    e->allocCountFx.fetch_add(countFx, std::memory_order_relaxed);
+    if (slackFx)
+        e->liveSlackFx.fetch_add(slackFx, std::memory_order_relaxed);
+    const uint64_t allocated = e->allocBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    const uint64_t freed = e->freeBytes.load(std::memory_order_relaxed);
+    const uint64_t live = allocated > freed ? allocated - freed : 0;
+
+    uint64_t peak = e->peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !e->peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+
+    uint64_t limit = e->limitBytes.load(std::memory_order_relaxed);
+    return limit && live >= limit &&
+           e->limitBytes.compare_exchange_strong(limit, 0, std::memory_order_relaxed);
+}
+
+void SiteStatsTable::recordFree(uint32_t id, uint64_t countFx, uint64_t bytes, uint64_t slackFx) noexcept
+{
+    Entry *e = entries.get(id);
+    if (!e)
+        return;
+    e->freeCountFx.fetch_add(countFx, std::memory_order_relaxed);
+    if (slackFx)
+        e->liveSlackFx.fetch_sub(slackFx, std::memory_order_relaxed);
+    e->freeBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void SiteStatsTable::recordCrossFree(uint32_t id, uint64_t countFx) noexcept
+{
+    if (Entry *e = entries.get(id))
+        e->crossFreeCountFx.fetch_add(countFx, std::memory_order_relaxed);
+}
+
+void SiteStatsTable::setLimit(uint32_t id, uint64_t limitBytes) noexcept
+{
+    Entry *e = limitBytes ? entries.get(id) : entries.find(id);
+    if (e)
+        e->limitBytes.store(limitBytes, std::memory_order_relaxed);
+}
+
+//==================================================
+// Lectura
+//==================================================
+bool SiteStatsTable::snapshot(uint32_t id, Counts &out) const noexcept
+{
+    const Entry *e = entries.find(id);
+    if (!e)
+        return false;
+
+    // Cada contador se lee por separado: un free reciente puede verse antes
+    // que su alloc, así que se recorta
+    out.freeCountFx = e->freeCountFx.load(std::memory_order_relaxed);
+    out.freeBytes = e->freeBytes.load(std::memory_order_relaxed);
+    out.allocCountFx = e->allocCountFx.load(std::memory_order_relaxed);
+    out.allocBytes = e->allocBytes.load(std::memory_order_relaxed);
+    out.peakLiveBytes = e->peakLiveBytes.load(std::memory_order_relaxed);
+    out.liveSlackFx = e->liveSlackFx.load(std::memory_order_relaxed);
+    out.crossFreeCountFx = e->crossFreeCountFx.load(std::memory_order_relaxed);
+    // setLimit() puede crear la entrada antes de la primera asignación
+    if (!out.allocCountFx)
+        return false;
+    if (out.freeCountFx > out.allocCountFx)
+        out.freeCountFx = out.allocCountFx;
+    if (out.freeBytes > out.allocBytes)
+        out.freeBytes = out.allocBytes;
+    return true;
+}
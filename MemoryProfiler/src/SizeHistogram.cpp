@@ -0,0 +1,22 @@
+#include "SizeHistogram.h"
+
+//==================================================
+// Lectura
+//==================================================
+void SizeHistogram::snapshot(Counts (&out)[kBucketCount]) const noexcept
+{
+    for (unsigned b = 0; b < kBucketCount; ++b)
+        out[b] = Counts{0, 0, 0, 0};
+
+    for (const Stripe &stripe : stripes)
+    {
+        for (unsigned b = 0; b < kBucketCount; ++b)
+        {
+            const Bucket &bucket = stripe.buckets[b];
+            out[b].allocCountFx += bucket.allocCountFx.load(std::memory_order_relaxed);
+            out[b].allocBytes += bucket.allocBytes.load(std::memory_order_relaxed);
+            out[b].freeCountFx += bucket.freeCountFx.load(std::memory_order_relaxed);
+            out[b].freeBytes += bucket.freeBytes.load(std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,179 @@
+#include "SlabAllocator.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+const size_t SlabArena::kClassSizes[SlabArena::kClassCount] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 512, 1024, 2048, 3072, 4096};
+
+std::atomic<size_t> SlabArena::mappedBytes{0};
+
+//==================================================
+// Páginas del SO
+//==================================================
+size_t SlabArena::pageRound(size_t bytes) noexcept
+{
+    static const size_t page = []() -> size_t
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+#else
+        const long p = sysconf(_SC_PAGESIZE);
+        return p > 0 ? static_cast<size_t>(p) : 4096;
+#endif
+    }();
+    return (bytes + page - 1) & ~(page - 1);
+}
+
+void *SlabArena::mapPages(size_t bytes) noexcept
+{
+    const size_t len = pageRound(bytes);
+#ifdef _WIN32
+    void *p = VirtualAlloc(nullptr, len, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!p)
+        return nullptr;
+#else
+    void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+#endif
+    mappedBytes.fetch_add(len, std::memory_order_relaxed);
+    return p;
+}
+
+void SlabArena::unmapPages(void *ptr, size_t bytes) noexcept
+{
+    if (!ptr)
+        return;
+    const size_t len = pageRound(bytes);
+#ifdef _WIN32
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, len);
+#endif
+    mappedBytes.fetch_sub(len, std::memory_order_relaxed);
+}
+
+//==================================================
+// Arena
+//==================================================
+SlabArena &SlabArena::shared() noexcept
+{
+    // Nunca se destruye: puede usarse desde destructores estáticos
+    alignas(SlabArena) static unsigned char storage[sizeof(SlabArena)];
+    static SlabArena *arena = new (&storage) SlabArena(true);
+    return *arena;
+}
+
+SlabArena::~SlabArena()
+{
+    while (chunks)
+    {
+        Chunk *next = chunks->next;
+        unmapPages(chunks, kChunkSize);
+        chunks = next;
+    }
+}
+
+size_t SlabArena::classIndex(size_t bytes) noexcept
+{
+    size_t i = 0;
+    while (kClassSizes[i] < bytes)
+        ++i;
+    return i;
+}
+
+void *SlabArena::allocateSmall(size_t cls) noexcept
+{
+    if (FreeBlock *block = freeLists[cls])
+    {
+        freeLists[cls] = block->next;
+        return block;
+    }
+
+    const size_t size = kClassSizes[cls];
+    if (static_cast<size_t>(bumpEnd - bumpCursor) < size)
+    {
+        // El resto del chunk anterior se reparte en las free lists que quepan
+        while (static_cast<size_t>(bumpEnd - bumpCursor) >= kClassSizes[0])
+        {
+            size_t c = kClassCount;
+            while (kClassSizes[--c] > static_cast<size_t>(bumpEnd - bumpCursor))
+            {
+            }
+            FreeBlock *leftover = reinterpret_cast<FreeBlock *>(bumpCursor);
+            leftover->next = freeLists[c];
+            freeLists[c] = leftover;
+            bumpCursor += kClassSizes[c];
+        }
+
+        void *mem = mapPages(kChunkSize);
+        if (!mem)
+            return nullptr;
+        Chunk *chunk = static_cast<Chunk *>(mem);
+        chunk->next = chunks;
+        chunks = chunk;
+        bumpCursor = static_cast<char *>(mem) + kAlignment;
+        bumpEnd = static_cast<char *>(mem) + kChunkSize;
+    }
+
+    void *p = bumpCursor;
+    bumpCursor += size;
+    return p;
+}
+
+void *SlabArena::allocate(size_t bytes) noexcept
+{
+    if (bytes == 0)
+        bytes = 1;
+
+    if (bytes > kMaxSmallSize)
+    {
+        return mapPages(bytes);
+    }
+
+    const size_t cls = classIndex(bytes);
+    if (synchronized)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return allocateSmall(cls);
+    }
+    return allocateSmall(cls);
+}
+
+void SlabArena::deallocate(void *ptr, size_t bytes) noexcept
+{
+    if (!ptr)
+        return;
+    if (bytes == 0)
+        bytes = 1;
+
+    if (bytes > kMaxSmallSize)
+    {
+        unmapPages(ptr, bytes);
+        return;
+    }
+
+    const size_t cls = classIndex(bytes);
+    FreeBlock *block = static_cast<FreeBlock *>(ptr);
+    if (synchronized)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        block->next = freeLists[cls];
+        freeLists[cls] = block;
+    }
+    else
+    {
+        block->next = freeLists[cls];
+        freeLists[cls] = block;
+    }
+}
@@ -0,0 +1,398 @@
+#include "SocketClient.h"
+#include <cstring>
+#include <thread>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+//==================================================
+// Diferencias entre plataformas
+//==================================================
+#if defined(_WIN32)
+using mt_socket_t = SOCKET;
+static constexpr int kMtSendFlags = 0;
+
+static inline bool mt_would_block() noexcept { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static inline void mt_close_socket(mt_socket_t s) noexcept { closesocket(s); }
+static inline int mt_poll(WSAPOLLFD *fds, ULONG count, int timeoutMs) noexcept { return WSAPoll(fds, count, timeoutMs); }
+using mt_pollfd = WSAPOLLFD;
+
+static bool mt_set_nonblocking(mt_socket_t s) noexcept
+{
+    u_long on = 1;
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+}
+
+// Winsock necesita WSAStartup una vez por proceso; no se llama a WSACleanup
+static bool mt_net_init() noexcept
+{
+    static const bool ok = []()
+    {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return ok;
+}
+#else
+using mt_socket_t = int;
+#if defined(MSG_NOSIGNAL)
+static constexpr int kMtSendFlags = MSG_NOSIGNAL; // una GUI cerrada no debe matar al proceso con SIGPIPE
+#else
+static constexpr int kMtSendFlags = 0;
+#endif
+
+static inline bool mt_would_block() noexcept { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+static inline void mt_close_socket(mt_socket_t s) noexcept { ::close(s); }
+static inline int mt_poll(pollfd *fds, nfds_t count, int timeoutMs) noexcept { return ::poll(fds, count, timeoutMs); }
+using mt_pollfd = pollfd;
+
+static bool mt_set_nonblocking(int fd) noexcept
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool mt_net_init() noexcept { return true; }
+#endif
+
+static inline mt_socket_t mt_socket(std::intptr_t handle) noexcept { return static_cast<mt_socket_t>(handle); }
+
+static void mt_put_be(std::string &out, uint64_t value, unsigned bytes)
+{
+    for (unsigned i = bytes; i-- > 0;)
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static uint64_t mt_get_be(const char *in, unsigned bytes) noexcept
+{
+    uint64_t value = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+        value = (value << 8) | static_cast<unsigned char>(in[i]);
+    return value;
+}
+
+static constexpr size_t kMtHeaderSize = sizeof(uint16_t) + sizeof(uint32_t);
+
+//==================================================
+// Conexión
+//==================================================
+SocketClient::~SocketClient()
+{
+    disconnectFromServer();
+#if !defined(_WIN32)
+    for (int &fd : wakeFds)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+// Conexión no bloqueante para poder cortar a los `timeout` ms
+static std::intptr_t mt_connect(const char *host, uint16_t port, std::chrono::milliseconds timeout)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *found = nullptr;
+    const std::string service = std::to_string(port);
+    if (getaddrinfo(host, service.c_str(), &hints, &found) != 0)
+        return -1;
+
+    std::intptr_t result = -1;
+    for (addrinfo *ai = found; ai && result == -1; ai = ai->ai_next)
+    {
+        mt_socket_t s = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+#if defined(_WIN32)
+        if (s == INVALID_SOCKET)
+            continue;
+#else
+        if (s < 0)
+            continue;
+        fcntl(s, F_SETFD, FD_CLOEXEC);
+#if defined(SO_NOSIGPIPE)
+        const int noSigpipe = 1;
+        setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+#endif
+        if (!mt_set_nonblocking(s))
+        {
+            mt_close_socket(s);
+            continue;
+        }
+
+        bool ok = ::connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0;
+        if (!ok)
+        {
+#if defined(_WIN32)
+            const bool pending = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+            const bool pending = errno == EINPROGRESS;
+#endif
+            mt_pollfd pfd{};
+            pfd.fd = s;
+            pfd.events = POLLOUT;
+            if (pending && mt_poll(&pfd, 1, static_cast<int>(timeout.count())) == 1)
+            {
+                int error = 0;
+                socklen_t len = sizeof(error);
+                ok = getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&error), &len) == 0 && error == 0;
+            }
+        }
+
+        if (ok)
+        {
+            // Paquetes chicos y frecuentes: sin Nagle
+            const int noDelay = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+            result = static_cast<std::intptr_t>(s);
+        }
+        else
+        {
+            mt_close_socket(s);
+        }
+    }
+
+    freeaddrinfo(found);
+    return result;
+}
+
+bool SocketClient::connectToServer(const char *host, uint16_t port, std::chrono::milliseconds timeout)
+{
+    if (isConnected())
+        return true;
+    if (!mt_net_init())
+        return false;
+
+#if !defined(_WIN32)
+    if (wakeFds[0] < 0)
+    {
+        if (pipe(wakeFds) != 0)
+            return false;
+        for (int fd : wakeFds)
+        {
+            mt_set_nonblocking(fd);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+#endif
+
+    const std::intptr_t s = mt_connect(host, port, timeout);
+    if (s == -1)
+        return false;
+
+    std::lock_guard<std::mutex> lock(sendMtx);
+    sock = s;
+    outbox.clear();
+    inbox.clear();
+    connected.store(true, std::memory_order_release);
+    return true;
+}
+
+void SocketClient::disconnectFromServer()
+{
+    std::lock_guard<std::mutex> lock(sendMtx);
+    closeLocked();
+}
+
+void SocketClient::closeLocked() noexcept
+{
+    connected.store(false, std::memory_order_release);
+    if (sock != -1)
+        mt_close_socket(mt_socket(sock));
+    sock = -1;
+    outbox.clear();
+}
+
+//==================================================
+// Envío
+//==================================================
+bool SocketClient::send(const char *keyword, const char *data, size_t size)
+{
+    const size_t keywordLen = std::strlen(keyword);
+    if (keywordLen > UINT16_MAX || size > UINT32_MAX)
+        return false;
+
+    std::lock_guard<std::mutex> lock(sendMtx);
+    if (sock == -1)
+        return false;
+
+    const size_t packetSize = kMtHeaderSize + keywordLen + size;
+    if (outbox.size() + packetSize > kMaxQueuedBytes)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const bool wasEmpty = outbox.empty();
+    outbox.reserve(outbox.size() + packetSize);
+    mt_put_be(outbox, keywordLen, sizeof(uint16_t));
+    mt_put_be(outbox, size, sizeof(uint32_t));
+    outbox.append(keyword, keywordLen);
+    outbox.append(data, size);
+
+    if (!flushLocked())
+        return false;
+    // Lo que no entró lo termina de escribir pump()
+    if (wasEmpty && !outbox.empty())
+        wake();
+    return true;
+}
+
+bool SocketClient::flushLocked()
+{
+    size_t written = 0;
+    while (written < outbox.size())
+    {
+        const auto n = ::send(mt_socket(sock), outbox.data() + written, static_cast<int>(outbox.size() - written), kMtSendFlags);
+        if (n > 0)
+        {
+            written += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && mt_would_block())
+            break;
+        closeLocked();
+        return false;
+    }
+    outbox.erase(0, written);
+    return true;
+}
+
+bool SocketClient::flush(std::chrono::milliseconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(sendMtx);
+            if (sock == -1 || !flushLocked())
+                return false;
+            if (outbox.empty())
+                return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void SocketClient::wake() noexcept
+{
+#if !defined(_WIN32)
+    if (wakeFds[1] >= 0)
+    {
+        const char byte = 1;
+        const ssize_t n = ::write(wakeFds[1], &byte, 1); // pipe lleno: ya hay un wake pendiente
+        (void)n;
+    }
+#endif
+}
+
+//==================================================
+// Hilo del reporter
+//==================================================
+void SocketClient::pump(std::chrono::milliseconds wait, const CommandHandler &onCommand)
+{
+    std::intptr_t s;
+    bool pendingWrite;
+    {
+        std::lock_guard<std::mutex> lock(sendMtx);
+        if (sock != -1 && !outbox.empty())
+            flushLocked();
+        s = sock;
+        pendingWrite = !outbox.empty();
+    }
+
+    mt_pollfd fds[2]{};
+    unsigned count = 0;
+    if (s != -1)
+    {
+        fds[count].fd = mt_socket(s);
+        fds[count].events = static_cast<short>(POLLIN | (pendingWrite ? POLLOUT : 0));
+        ++count;
+    }
+    int timeoutMs = static_cast<int>(wait.count() < 0 ? 0 : wait.count());
+#if defined(_WIN32)
+    // Sin pipe para wake(): la espera se corta seguido
+    if (timeoutMs > 50)
+        timeoutMs = 50;
+    if (count == 0)
+    {
+        Sleep(static_cast<DWORD>(timeoutMs));
+        return;
+    }
+#else
+    fds[count].fd = wakeFds[0];
+    fds[count].events = POLLIN;
+    ++count;
+#endif
+
+    if (mt_poll(fds, count, timeoutMs) <= 0)
+        return;
+
+#if !defined(_WIN32)
+    if (fds[count - 1].revents & POLLIN)
+    {
+        char drain[64];
+        while (::read(wakeFds[0], drain, sizeof(drain)) > 0)
+        {
+        }
+    }
+#endif
+
+    if (s == -1 || !(fds[0].revents & (POLLIN | POLLERR | POLLHUP)))
+        return;
+
+    char buffer[16 * 1024];
+    for (;;)
+    {
+        const auto n = ::recv(mt_socket(s), buffer, static_cast<int>(sizeof(buffer)), 0);
+        if (n > 0)
+        {
+            inbox.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && mt_would_block())
+            break;
+        // 0 = la GUI cerró la conexión
+        std::lock_guard<std::mutex> lock(sendMtx);
+        closeLocked();
+        break;
+    }
+
+    parseCommands(onCommand);
+}
+
+// Puede haber varios pedidos juntos o uno cortado al final
+void SocketClient::parseCommands(const CommandHandler &onCommand)
+{
+    size_t offset = 0;
+    while (inbox.size() - offset >= kMtHeaderSize)
+    {
+        const char *header = inbox.data() + offset;
+        const size_t keywordLen = static_cast<size_t>(mt_get_be(header, sizeof(uint16_t)));
+        const size_t dataLen = static_cast<size_t>(mt_get_be(header + sizeof(uint16_t), sizeof(uint32_t)));
+        if (inbox.size() - offset < kMtHeaderSize + keywordLen + dataLen)
+            break;
+
+        const std::string keyword(header + kMtHeaderSize, keywordLen);
+        const std::string data(header + kMtHeaderSize + keywordLen, dataLen);
+        offset += kMtHeaderSize + keywordLen + dataLen;
+        if (onCommand)
+            onCommand(keyword, data);
+    }
+    inbox.erase(0, offset);
+}
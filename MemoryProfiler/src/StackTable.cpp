@@ -0,0 +1,230 @@
+#include "StackTable.h"
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(_MSC_VER)
+#define MT_NOINLINE __declspec(noinline)
+#else
+#define MT_NOINLINE __attribute__((noinline))
+#endif
+
+//==================================================
+// Constructor / Destructor
+//==================================================
+StackTable::StackTable()
+{
+    // ID 0: la pila vacía, así frames(kNoStack) siempre es válido
+    static const Record empty{0, 0, 0};
+    records.push_back(&empty);
+}
+
+StackTable::~StackTable()
+{
+    for (uint32_t i = 1; i < records.size(); ++i)
+    {
+        const Record *rec = records[i];
+        SlabArena::shared().deallocate(const_cast<Record *>(rec), sizeof(Record) + rec->depth * sizeof(void *));
+    }
+    if (std::atomic<uint32_t> *table = slots.load(std::memory_order_relaxed))
+        SlabArena::unmapPages(table, kSlots * sizeof(std::atomic<uint32_t>));
+}
+
+//==================================================
+// Internado
+//==================================================
+uint64_t StackTable::hashFrames(void *const *pcs, uint32_t depth) noexcept
+{
+    uint64_t h = depth;
+    for (uint32_t i = 0; i < depth; ++i)
+    {
+        h ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pcs[i]));
+        h *= 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+// Sin locks. Si no la encuentra, `slot` queda en el primer hueco libre (solo
+// es útil bajo mtx, que es cuando se inserta).
+bool StackTable::find(uint64_t hash, void *const *pcs, uint32_t depth, uint32_t &id, uint32_t &slot) const noexcept
+{
+    const std::atomic<uint32_t> *table = slots.load(std::memory_order_acquire);
+    if (!table)
+        return false;
+
+    slot = static_cast<uint32_t>(hash >> (64 - kSlotBits));
+    for (;; slot = (slot + 1) & (kSlots - 1))
+    {
+        const uint32_t candidate = table[slot].load(std::memory_order_acquire);
+        if (candidate == 0)
+            return false;
+
+        const Record *rec = records[candidate];
+        if (rec->hash == hash && rec->depth == depth &&
+            std::memcmp(rec->pcs(), pcs, depth * sizeof(void *)) == 0)
+        {
+            id = candidate;
+            return true;
+        }
+    }
+}
+
+uint32_t StackTable::intern(void *const *pcs, uint32_t depth)
+{
+    if (depth == 0)
+        return kNoStack;
+    if (depth > kMaxDepth)
+        depth = kMaxDepth;
+
+    const uint64_t hash = hashFrames(pcs, depth);
+    uint32_t id = kNoStack;
+    uint32_t slot = 0;
+    if (find(hash, pcs, depth, id, slot))
+        return id;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    std::atomic<uint32_t> *table = slots.load(std::memory_order_relaxed);
+    if (!table)
+    {
+        table = static_cast<std::atomic<uint32_t> *>(SlabArena::mapPages(kSlots * sizeof(std::atomic<uint32_t>)));
+        if (!table)
+            return kNoStack;
+        slots.store(table, std::memory_order_release);
+    }
+
+    // Otro hilo pudo insertarla mientras esperábamos el lock
+    if (find(hash, pcs, depth, id, slot))
+        return id;
+
+    // Con la tabla llena las pilas nuevas quedan sin atribuir
+    if (records.size() >= kMaxRecords)
+        return kNoStack;
+
+    const size_t bytes = sizeof(Record) + depth * sizeof(void *);
+    Record *rec = static_cast<Record *>(SlabArena::shared().allocate(bytes));
+    if (!rec)
+        return kNoStack;
+    rec->hash = hash;
+    rec->depth = depth;
+    rec->reserved = 0;
+    std::memcpy(const_cast<const void **>(rec->pcs()), pcs, depth * sizeof(void *));
+
+    id = records.size();
+    if (!records.push_back(rec))
+    {
+        SlabArena::shared().deallocate(rec, bytes);
+        return kNoStack;
+    }
+    // Publicar el slot al final: quien lo vea ya encuentra el registro completo
+    table[slot].store(id, std::memory_order_release);
+    return id;
+}
+
+StackTable::Frames StackTable::frames(uint32_t id) const noexcept
+{
+    const Record *rec = records[id < records.size() ? id : kNoStack];
+    return {rec->pcs(), rec->depth};
+}
+
+//==================================================
+// Captura
+//==================================================
+#ifdef _WIN32
+
+MT_NOINLINE uint32_t StackTable::capture(void **out, uint32_t maxDepth, uint32_t skip) noexcept
+{
+    if (maxDepth > kMaxDepth)
+        maxDepth = kMaxDepth;
+    // +1: el frame de capture() mismo
+    return RtlCaptureStackBackTrace(skip + 1, maxDepth, out, nullptr);
+}
+
+#else
+
+// Límites de la pila del hilo: impiden seguir un frame pointer basura (código
+// compilado sin frame pointers) fuera de la pila.
+struct StackBounds
+{
+    uintptr_t low = 0;
+    uintptr_t high = 0;
+};
+
+static thread_local StackBounds g_mt_stack_bounds;
+
+static const StackBounds &mt_current_stack_bounds(uintptr_t fp) noexcept
+{
+    StackBounds &bounds = g_mt_stack_bounds;
+    if (bounds.high)
+        return bounds;
+
+#if defined(__APPLE__)
+    pthread_t self = pthread_self();
+    bounds.high = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(self));
+    bounds.low = bounds.high - pthread_get_stacksize_np(self);
+#elif defined(__linux__)
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0)
+    {
+        void *addr = nullptr;
+        size_t size = 0;
+        if (pthread_attr_getstack(&attr, &addr, &size) == 0)
+        {
+            bounds.low = reinterpret_cast<uintptr_t>(addr);
+            bounds.high = bounds.low + size;
+        }
+        pthread_attr_destroy(&attr);
+    }
+#endif
+    if (!bounds.high)
+    {
+        // Sin información del sistema: ventana conservadora sobre el frame actual
+        bounds.low = fp;
+        bounds.high = fp + 1024 * 1024;
+    }
+    return bounds;
+}
+
+// Cada frame guarda [fp] = fp del llamador y [fp + 1] = dirección de retorno
+// (x86-64 y AArch64 con frame records).
+MT_NOINLINE uint32_t StackTable::capture(void **out, uint32_t maxDepth, uint32_t skip) noexcept
+{
+    if (maxDepth > kMaxDepth)
+        maxDepth = kMaxDepth;
+
+    uintptr_t fp = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    const StackBounds &bounds = mt_current_stack_bounds(fp);
+
+    uint32_t depth = 0;
+    while (depth < maxDepth)
+    {
+        if (fp < bounds.low || fp + 2 * sizeof(void *) > bounds.high || (fp & (sizeof(void *) - 1)))
+            break;
+
+        void *const *frame = reinterpret_cast<void *const *>(fp);
+        const uintptr_t next = reinterpret_cast<uintptr_t>(frame[0]);
+        void *ret = frame[1];
+        if (!ret)
+            break;
+
+        if (skip)
+            --skip;
+        else
+            out[depth++] = ret;
+
+        // La pila crece hacia abajo: el llamador siempre está más arriba
+        if (next <= fp)
+            break;
+        fp = next;
+    }
+    return depth;
+}
+
+#endif
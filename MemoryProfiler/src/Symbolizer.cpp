@@ -0,0 +1,932 @@
+#include "Symbolizer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+//==================================================
+// Lectura de secciones ELF / DWARF
+//==================================================
+namespace
+{
+    // Lector secuencial con control de límites. Asume host little-endian,
+    // igual que los binarios que se leen (ELFDATA2LSB).
+    struct Reader
+    {
+        const uint8_t *p;
+        const uint8_t *end;
+        bool failed = false;
+
+        Reader(const uint8_t *begin, const uint8_t *finish) : p(begin), end(finish) {}
+
+        bool need(size_t n) noexcept
+        {
+            if (failed || static_cast<size_t>(end - p) < n)
+            {
+                failed = true;
+                return false;
+            }
+            return true;
+        }
+
+        uint64_t fixed(size_t n) noexcept
+        {
+            uint64_t v = 0;
+            if (n > sizeof(v) || !need(n))
+                return 0;
+            std::memcpy(&v, p, n);
+            p += n;
+            return v;
+        }
+
+        uint8_t u8() noexcept { return static_cast<uint8_t>(fixed(1)); }
+        uint16_t u16() noexcept { return static_cast<uint16_t>(fixed(2)); }
+        uint32_t u32() noexcept { return static_cast<uint32_t>(fixed(4)); }
+        uint64_t u64() noexcept { return fixed(8); }
+
+        uint64_t uleb() noexcept
+        {
+            uint64_t v = 0;
+            unsigned shift = 0;
+            uint8_t b;
+            do
+            {
+                if (!need(1))
+                    return 0;
+                b = *p++;
+                if (shift < 64)
+                    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+                shift += 7;
+            } while (b & 0x80);
+            return v;
+        }
+
+        int64_t sleb() noexcept
+        {
+            uint64_t v = 0;
+            unsigned shift = 0;
+            uint8_t b;
+            do
+            {
+                if (!need(1))
+                    return 0;
+                b = *p++;
+                if (shift < 64)
+                    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+                shift += 7;
+            } while (b & 0x80);
+            if (shift < 64 && (b & 0x40))
+                v |= ~uint64_t(0) << shift;
+            return static_cast<int64_t>(v);
+        }
+
+        const char *cstr() noexcept
+        {
+            const uint8_t *s = p;
+            while (p < end && *p)
+                ++p;
+            if (p >= end)
+            {
+                failed = true;
+                return "";
+            }
+            ++p;
+            return reinterpret_cast<const char *>(s);
+        }
+
+        void skip(uint64_t n) noexcept
+        {
+            if (need(static_cast<size_t>(n)))
+                p += n;
+        }
+    };
+
+    struct Section
+    {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+    };
+
+    const char *stringAt(const Section &sec, uint64_t offset) noexcept
+    {
+        if (!sec.data || offset >= sec.size)
+            return "";
+        // Debe terminar en '\0' dentro de la sección
+        if (!std::memchr(sec.data + offset, 0, sec.size - offset))
+            return "";
+        return reinterpret_cast<const char *>(sec.data + offset);
+    }
+
+    size_t pageSize() noexcept
+    {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+    // Formas DWARF que aparecen en los encabezados de .debug_line v5
+    enum : uint64_t
+    {
+        DW_FORM_block2 = 0x03,
+        DW_FORM_block4 = 0x04,
+        DW_FORM_data2 = 0x05,
+        DW_FORM_data4 = 0x06,
+        DW_FORM_data8 = 0x07,
+        DW_FORM_string = 0x08,
+        DW_FORM_block = 0x09,
+        DW_FORM_block1 = 0x0a,
+        DW_FORM_data1 = 0x0b,
+        DW_FORM_sdata = 0x0d,
+        DW_FORM_strp = 0x0e,
+        DW_FORM_udata = 0x0f,
+        DW_FORM_strx = 0x1a,
+        DW_FORM_data16 = 0x1e,
+        DW_FORM_line_strp = 0x1f,
+        DW_FORM_strx1 = 0x25,
+        DW_FORM_strx2 = 0x26,
+        DW_FORM_strx3 = 0x27,
+        DW_FORM_strx4 = 0x28,
+    };
+
+    enum : uint64_t
+    {
+        DW_LNCT_path = 1,
+        DW_LNCT_directory_index = 2,
+    };
+}
+
+//==================================================
+// Imagen ELF
+//==================================================
+struct Symbolizer::Image
+{
+    struct Symbol
+    {
+        uint64_t addr;
+        uint64_t size;
+        const char *name; // apunta al archivo mapeado
+    };
+
+    // Fila de la tabla de líneas; `end` marca el fin de una secuencia
+    struct Row
+    {
+        uint64_t addr;
+        uint32_t file;
+        int32_t line;
+        bool end;
+    };
+
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    bool parsed = false;
+
+    Vector<Symbol> symbols;
+    Vector<Row> rows;
+    Vector<String> files; // files[0] = desconocido
+
+    ~Image()
+    {
+        if (data)
+            munmap(const_cast<uint8_t *>(data), size);
+    }
+
+    bool open(const String &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        void *mem = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Elf64_Ehdr)))
+            mem = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED)
+            return false;
+
+        data = static_cast<const uint8_t *>(mem);
+        size = static_cast<size_t>(st.st_size);
+
+        const Elf64_Ehdr *eh = header();
+        if (std::memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 ||
+            eh->e_ident[EI_CLASS] != ELFCLASS64 || eh->e_ident[EI_DATA] != ELFDATA2LSB)
+        {
+            munmap(mem, size);
+            data = nullptr;
+            size = 0;
+            return false;
+        }
+        return true;
+    }
+
+    const Elf64_Ehdr *header() const noexcept { return reinterpret_cast<const Elf64_Ehdr *>(data); }
+
+    template <typename T>
+    const T *table(uint64_t offset, uint64_t count) const noexcept
+    {
+        if (offset > size || count > (size - offset) / sizeof(T))
+            return nullptr;
+        return reinterpret_cast<const T *>(data + offset);
+    }
+
+    // Bias de carga de un mapeo (inicio, offset en archivo) de /proc/self/maps
+    bool loadBias(uintptr_t start, uint64_t fileOffset, uintptr_t &bias) const noexcept
+    {
+        const Elf64_Ehdr *eh = header();
+        const Elf64_Phdr *ph = table<Elf64_Phdr>(eh->e_phoff, eh->e_phnum);
+        if (!ph)
+            return false;
+
+        const uint64_t mask = ~static_cast<uint64_t>(pageSize() - 1);
+        for (unsigned i = 0; i < eh->e_phnum; ++i)
+        {
+            if (ph[i].p_type == PT_LOAD && (ph[i].p_offset & mask) == fileOffset)
+            {
+                bias = start - static_cast<uintptr_t>(ph[i].p_vaddr & mask);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Section section(const Elf64_Shdr &sh) const noexcept
+    {
+        // Las secciones comprimidas (SHF_COMPRESSED) necesitarían zlib
+        if (sh.sh_type == SHT_NOBITS || (sh.sh_flags & SHF_COMPRESSED) ||
+            sh.sh_offset > size || sh.sh_size > size - sh.sh_offset)
+            return {};
+        return {data + sh.sh_offset, static_cast<size_t>(sh.sh_size)};
+    }
+
+    void parse()
+    {
+        parsed = true;
+        files.emplace_back();
+
+        const Elf64_Ehdr *eh = header();
+        const Elf64_Shdr *sh = table<Elf64_Shdr>(eh->e_shoff, eh->e_shnum);
+        if (!sh || eh->e_shstrndx >= eh->e_shnum)
+            return;
+        const Section names = section(sh[eh->e_shstrndx]);
+
+        const Elf64_Shdr *symtab = nullptr;
+        const Elf64_Shdr *dynsym = nullptr;
+        Section debugLine, debugLineStr, debugStr;
+        for (unsigned i = 0; i < eh->e_shnum; ++i)
+        {
+            const char *name = stringAt(names, sh[i].sh_name);
+            if (sh[i].sh_type == SHT_SYMTAB)
+                symtab = &sh[i];
+            else if (sh[i].sh_type == SHT_DYNSYM)
+                dynsym = &sh[i];
+            else if (std::strcmp(name, ".debug_line") == 0)
+                debugLine = section(sh[i]);
+            else if (std::strcmp(name, ".debug_line_str") == 0)
+                debugLineStr = section(sh[i]);
+            else if (std::strcmp(name, ".debug_str") == 0)
+                debugStr = section(sh[i]);
+        }
+
+        // .symtab es un superconjunto de .dynsym; este solo queda en binarios stripeados
+        if (const Elf64_Shdr *symbolTable = symtab ? symtab : dynsym)
+        {
+            if (symbolTable->sh_link < eh->e_shnum)
+                parseSymbols(section(*symbolTable), section(sh[symbolTable->sh_link]));
+        }
+        if (debugLine.data)
+            parseLines(debugLine, debugLineStr, debugStr);
+    }
+
+    void parseSymbols(const Section &syms, const Section &strings)
+    {
+        const size_t count = syms.size / sizeof(Elf64_Sym);
+        const Elf64_Sym *sym = reinterpret_cast<const Elf64_Sym *>(syms.data);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const unsigned type = ELF64_ST_TYPE(sym[i].st_info);
+            if ((type != STT_FUNC && type != STT_GNU_IFUNC) || sym[i].st_shndx == SHN_UNDEF || !sym[i].st_value)
+                continue;
+            const char *name = stringAt(strings, sym[i].st_name);
+            if (*name)
+                symbols.push_back({sym[i].st_value, sym[i].st_size, name});
+        }
+        std::sort(symbols.begin(), symbols.end(),
+                  [](const Symbol &a, const Symbol &b)
+                  {
+                      return a.addr < b.addr;
+                  });
+    }
+
+    //==================================================
+    // .debug_line (DWARF 2 a 5)
+    //==================================================
+    void parseLines(const Section &lines, const Section &lineStr, const Section &str)
+    {
+        Map<String, uint32_t, StringHash> fileIds;
+        Reader all(lines.data, lines.data + lines.size);
+        while (!all.failed && all.p < all.end)
+        {
+            uint64_t unitLength = all.u32();
+            bool dwarf64 = false;
+            if (unitLength == 0xffffffffu)
+            {
+                unitLength = all.u64();
+                dwarf64 = true;
+            }
+            if (all.failed || unitLength > static_cast<uint64_t>(all.end - all.p))
+                break;
+
+            Reader unit(all.p, all.p + unitLength);
+            all.p += unitLength;
+            parseLineUnit(unit, dwarf64, lineStr, str, fileIds);
+        }
+
+        // Con la misma dirección, el fin de una secuencia va antes que el
+        // comienzo de la siguiente
+        std::sort(rows.begin(), rows.end(),
+                  [](const Row &a, const Row &b)
+                  {
+                      return a.addr != b.addr ? a.addr < b.addr : a.end > b.end;
+                  });
+    }
+
+    uint32_t internFile(const String &dir, const char *name, Map<String, uint32_t, StringHash> &fileIds)
+    {
+        String path = (name[0] == '/' || dir.empty()) ? String(name) : dir + "/" + name;
+        auto it = fileIds.find(path);
+        if (it != fileIds.end())
+            return it->second;
+        const uint32_t id = static_cast<uint32_t>(files.size());
+        fileIds.emplace(path, id);
+        files.push_back(std::move(path));
+        return id;
+    }
+
+    // Lee un valor de los encabezados v5. Devuelve false ante una forma desconocida.
+    static bool readForm(Reader &r, uint64_t form, bool dwarf64, const Section &lineStr, const Section &str,
+                         const char *&text, uint64_t &number)
+    {
+        text = nullptr;
+        number = 0;
+        switch (form)
+        {
+        case DW_FORM_string:
+            text = r.cstr();
+            return true;
+        case DW_FORM_line_strp:
+            text = stringAt(lineStr, dwarf64 ? r.u64() : r.u32());
+            return true;
+        case DW_FORM_strp:
+            text = stringAt(str, dwarf64 ? r.u64() : r.u32());
+            return true;
+        case DW_FORM_strx:
+        case DW_FORM_udata:
+            number = r.uleb();
+            return true;
+        case DW_FORM_sdata:
+            number = static_cast<uint64_t>(r.sleb());
+            return true;
+        case DW_FORM_data1:
+        case DW_FORM_strx1:
+            number = r.u8();
+            return true;
+        case DW_FORM_data2:
+        case DW_FORM_strx2:
+            number = r.u16();
+            return true;
+        case DW_FORM_strx3:
+            number = r.fixed(3);
+            return true;
+        case DW_FORM_data4:
+        case DW_FORM_strx4:
+            number = r.u32();
+            return true;
+        case DW_FORM_data8:
+            number = r.u64();
+            return true;
+        case DW_FORM_data16:
+            r.skip(16);
+            return true;
+        case DW_FORM_block:
+            r.skip(r.uleb());
+            return true;
+        case DW_FORM_block1:
+            r.skip(r.u8());
+            return true;
+        case DW_FORM_block2:
+            r.skip(r.u16());
+            return true;
+        case DW_FORM_block4:
+            r.skip(r.u32());
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Tabla de directorios o archivos de un encabezado v5. Para directorios,
+    // `dirs` se llena; para archivos, `out` recibe los IDs globales.
+    bool readEntryTable(Reader &r, bool dwarf64, const Section &lineStr, const Section &str,
+                        Vector<String> &dirs, Vector<uint32_t> *out,
+                        Map<String, uint32_t, StringHash> &fileIds)
+    {
+        const uint8_t formatCount = r.u8();
+        uint64_t format[2 * 255];
+        for (unsigned i = 0; i < formatCount; ++i)
+        {
+            format[2 * i] = r.uleb();
+            format[2 * i + 1] = r.uleb();
+        }
+
+        const uint64_t count = r.uleb();
+        for (uint64_t e = 0; e < count && !r.failed; ++e)
+        {
+            const char *path = "";
+            uint64_t dirIndex = 0;
+            for (unsigned i = 0; i < formatCount; ++i)
+            {
+                const char *text;
+                uint64_t number;
+                if (!readForm(r, format[2 * i + 1], dwarf64, lineStr, str, text, number))
+                    return false;
+                if (format[2 * i] == DW_LNCT_path && text)
+                    path = text;
+                else if (format[2 * i] == DW_LNCT_directory_index)
+                    dirIndex = number;
+            }
+
+            if (out)
+                out->push_back(internFile(dirIndex < dirs.size() ? dirs[dirIndex] : String(), path, fileIds));
+            else
+                dirs.emplace_back(path);
+        }
+        return !r.failed;
+    }
+
+    void parseLineUnit(Reader &r, bool dwarf64, const Section &lineStr, const Section &str,
+                       Map<String, uint32_t, StringHash> &fileIds)
+    {
+        const uint16_t version = r.u16();
+        if (version < 2 || version > 5)
+            return;
+        if (version >= 5)
+        {
+            r.u8(); // address_size
+            r.u8(); // segment_selector_size
+        }
+
+        const uint64_t headerLength = dwarf64 ? r.u64() : r.u32();
+        if (r.failed || headerLength > static_cast<uint64_t>(r.end - r.p))
+            return;
+        Reader program(r.p + headerLength, r.end);
+
+        const uint8_t minInstLength = r.u8();
+        if (version >= 4)
+            r.u8(); // maximum_operations_per_instruction (solo VLIW)
+        r.u8();     // default_is_stmt
+        const int8_t lineBase = static_cast<int8_t>(r.u8());
+        const uint8_t lineRange = r.u8();
+        const uint8_t opcodeBase = r.u8();
+        if (r.failed || lineRange == 0 || opcodeBase == 0)
+            return;
+        const uint8_t *opcodeLengths = r.p;
+        r.skip(opcodeBase - 1u);
+
+        Vector<String> dirs;
+        Vector<uint32_t> unitFiles;
+        if (version < 5)
+        {
+            // Directorio 0 = el de compilación, que solo está en .debug_info
+            dirs.emplace_back();
+            for (;;)
+            {
+                const char *dir = r.cstr();
+                if (r.failed || !*dir)
+                    break;
+                dirs.emplace_back(dir);
+            }
+            unitFiles.push_back(0); // los índices de archivo empiezan en 1
+            for (;;)
+            {
+                const char *name = r.cstr();
+                if (r.failed || !*name)
+                    break;
+                const uint64_t dir = r.uleb();
+                r.uleb(); // mtime
+                r.uleb(); // length
+                unitFiles.push_back(internFile(dir < dirs.size() ? dirs[dir] : String(), name, fileIds));
+            }
+        }
+        else if (!readEntryTable(r, dwarf64, lineStr, str, dirs, nullptr, fileIds) ||
+                 !readEntryTable(r, dwarf64, lineStr, str, dirs, &unitFiles, fileIds))
+        {
+            return;
+        }
+        if (r.failed)
+            return;
+
+        // Máquina de estados del programa de líneas
+        uint64_t address = 0;
+        uint64_t file = 1;
+        int64_t line = 1;
+        Vector<Row> sequence;
+
+        auto emit = [&](bool end)
+        {
+            const uint32_t fileId = file < unitFiles.size() ? unitFiles[file] : 0;
+            sequence.push_back({address, fileId, static_cast<int32_t>(line), end});
+        };
+
+        while (!program.failed && program.p < program.end)
+        {
+            const uint8_t op = program.u8();
+            if (op >= opcodeBase)
+            {
+                const uint8_t adjusted = static_cast<uint8_t>(op - opcodeBase);
+                address += static_cast<uint64_t>(adjusted / lineRange) * minInstLength;
+                line += lineBase + adjusted % lineRange;
+                emit(false);
+                continue;
+            }
+
+            switch (op)
+            {
+            case 0: // extendido
+            {
+                const uint64_t len = program.uleb();
+                if (program.failed || len == 0 || len > static_cast<uint64_t>(program.end - program.p))
+                    return;
+                const uint8_t *next = program.p + len;
+                const uint8_t sub = program.u8();
+                if (sub == 1) // DW_LNE_end_sequence
+                {
+                    emit(true);
+                    // Las funciones descartadas por el linker quedan en 0 (o -1)
+                    if (sequence.front().addr != 0 && sequence.front().addr != ~uint64_t(0))
+                        rows.insert(rows.end(), sequence.begin(), sequence.end());
+                    sequence.clear();
+                    address = 0;
+                    file = 1;
+                    line = 1;
+                }
+                else if (sub == 2) // DW_LNE_set_address
+                {
+                    address = program.fixed(static_cast<size_t>(len - 1));
+                }
+                program.p = next;
+                break;
+            }
+            case 1: // DW_LNS_copy
+                emit(false);
+                break;
+            case 2: // DW_LNS_advance_pc
+                address += program.uleb() * minInstLength;
+                break;
+            case 3: // DW_LNS_advance_line
+                line += program.sleb();
+                break;
+            case 4: // DW_LNS_set_file
+                file = program.uleb();
+                break;
+            case 8: // DW_LNS_const_add_pc
+                address += static_cast<uint64_t>((255 - opcodeBase) / lineRange) * minInstLength;
+                break;
+            case 9: // DW_LNS_fixed_advance_pc
+                address += program.u16();
+                break;
+            case 6:  // negate_stmt
+            case 7:  // set_basic_block
+            case 10: // set_prologue_end
+            case 11: // set_epilogue_begin
+                break;
+            default: // set_column, set_isa y opcodes estándar desconocidos
+                for (uint8_t i = 0; i < opcodeLengths[op - 1]; ++i)
+                    program.uleb();
+                break;
+            }
+        }
+    }
+
+    const Symbol *findSymbol(uint64_t addr) const noexcept
+    {
+        auto it = std::upper_bound(symbols.begin(), symbols.end(), addr,
+                                   [](uint64_t a, const Symbol &s)
+                                   {
+                                       return a < s.addr;
+                                   });
+        if (it == symbols.begin())
+            return nullptr;
+        --it;
+        if (it->size && addr >= it->addr + it->size)
+            return nullptr;
+        return &*it;
+    }
+
+    const Row *findRow(uint64_t addr) const noexcept
+    {
+        auto it = std::upper_bound(rows.begin(), rows.end(), addr,
+                                   [](uint64_t a, const Row &row)
+                                   {
+                                       return a < row.addr;
+                                   });
+        if (it == rows.begin())
+            return nullptr;
+        --it;
+        return it->end ? nullptr : &*it;
+    }
+};
+
+#else
+
+struct Symbolizer::Image
+{
+};
+
+#endif
+
+//==================================================
+// Constructor / Destructor
+//==================================================
+Symbolizer::Symbolizer() = default;
+
+Symbolizer::~Symbolizer()
+{
+    for (const auto &pair : images)
+    {
+        if (Image *image = pair.second)
+        {
+            image->~Image();
+            SlabArena::shared().deallocate(image, sizeof(Image));
+        }
+    }
+}
+
+//==================================================
+// Mapa de módulos
+//==================================================
+bool Symbolizer::loadProcessModules()
+{
+    std::lock_guard<std::mutex> lock(modulesMtx);
+    offline = false;
+    return readProcMaps();
+}
+
+// Requiere modulesMtx.
+bool Symbolizer::readProcMaps()
+{
+#ifdef __linux__
+    FILE *maps = std::fopen("/proc/self/maps", "re");
+    if (!maps)
+        return false;
+
+    Vector<Module> found;
+    char line[4096];
+    while (std::fgets(line, sizeof(line), maps))
+    {
+        unsigned long start, end, offset;
+        char perms[5] = {};
+        int pathPos = 0;
+        if (std::sscanf(line, "%lx-%lx %4s %lx %*s %*s %n", &start, &end, perms, &offset, &pathPos) < 4 || !pathPos)
+            continue;
+        // Solo código respaldado por un archivo ([vdso], [heap]... no sirven)
+        if (perms[2] != 'x' || line[pathPos] != '/')
+            continue;
+
+        String path(line + pathPos);
+        while (!path.empty() && (path.back() == '\n' || path.back() == ' '))
+            path.pop_back();
+
+        Image *image = imageFor(path);
+        uintptr_t bias;
+        if (!image || !image->loadBias(start, offset, bias))
+            bias = start - offset;
+        found.push_back({start, end, bias, std::move(path)});
+    }
+    std::fclose(maps);
+
+    std::sort(found.begin(), found.end(),
+              [](const Module &a, const Module &b)
+              {
+                  return a.start < b.start;
+              });
+    modules.swap(found);
+    return !modules.empty();
+#else
+    return false;
+#endif
+}
+
+Symbolizer::String Symbolizer::moduleMap() const
+{
+    std::lock_guard<std::mutex> lock(modulesMtx);
+    String text;
+    char line[64];
+    for (const Module &m : modules)
+    {
+        std::snprintf(line, sizeof(line), "%llx %llx %llx ",
+                      static_cast<unsigned long long>(m.start),
+                      static_cast<unsigned long long>(m.end),
+                      static_cast<unsigned long long>(m.bias));
+        text += line;
+        text += m.path;
+        text += '\n';
+    }
+    return text;
+}
+
+bool Symbolizer::loadModuleMap(std::string_view text)
+{
+    Vector<Module> found;
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = text.size();
+        // Copia: sscanf necesita el '\0'
+        const String line(text.substr(pos, eol - pos));
+        pos = eol + 1;
+
+        unsigned long long start, end, bias;
+        int pathPos = 0;
+        if (std::sscanf(line.c_str(), "%llx %llx %llx %n", &start, &end, &bias, &pathPos) == 3 && pathPos &&
+            static_cast<size_t>(pathPos) < line.size())
+        {
+            found.push_back({static_cast<uintptr_t>(start), static_cast<uintptr_t>(end),
+                             static_cast<uintptr_t>(bias), line.substr(static_cast<size_t>(pathPos))});
+        }
+    }
+
+    std::sort(found.begin(), found.end(),
+              [](const Module &a, const Module &b)
+              {
+                  return a.start < b.start;
+              });
+
+    {
+        std::lock_guard<std::mutex> lock(modulesMtx);
+        modules.swap(found);
+        offline = true;
+    }
+    // Lo resuelto con el mapa anterior ya no vale
+    std::lock_guard<std::mutex> lock(cacheMtx);
+    cache.clear();
+    return true;
+}
+
+const Symbolizer::Module *Symbolizer::findModule(uintptr_t pc) const noexcept
+{
+    auto it = std::upper_bound(modules.begin(), modules.end(), pc,
+                               [](uintptr_t a, const Module &m)
+                               {
+                                   return a < m.start;
+                               });
+    if (it == modules.begin())
+        return nullptr;
+    --it;
+    return pc < it->end ? &*it : nullptr;
+}
+
+// Requiere modulesMtx. Un archivo que no se pudo abrir queda registrado como
+// nullptr para no reintentarlo en cada PC.
+Symbolizer::Image *Symbolizer::imageFor(const String &path)
+{
+#ifdef __linux__
+    auto it = images.find(path);
+    if (it == images.end())
+    {
+        Image *image = nullptr;
+        if (void *mem = SlabArena::shared().allocate(sizeof(Image)))
+        {
+            image = new (mem) Image();
+            if (!image->open(path))
+            {
+                image->~Image();
+                SlabArena::shared().deallocate(mem, sizeof(Image));
+                image = nullptr;
+            }
+        }
+        it = images.emplace(path, image).first;
+    }
+    return it->second;
+#else
+    (void)path;
+    return nullptr;
+#endif
+}
+
+//==================================================
+// Resolución
+//==================================================
+Symbolizer::Location Symbolizer::resolve(const void *pc)
+{
+    const uintptr_t key = reinterpret_cast<uintptr_t>(pc);
+    {
+        std::lock_guard<std::mutex> lock(cacheMtx);
+        auto it = cache.find(key);
+        if (it != cache.end())
+            return it->second;
+    }
+
+    Location loc = resolveUncached(key);
+
+    std::lock_guard<std::mutex> lock(cacheMtx);
+    cache.emplace(key, loc);
+    return loc;
+}
+
+Symbolizer::Location Symbolizer::resolveUncached(uintptr_t pc)
+{
+    Location loc;
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(modulesMtx);
+    const Module *module = findModule(pc);
+    if (!module && !offline)
+    {
+        // Puede ser una biblioteca cargada con dlopen después del último escaneo
+        readProcMaps();
+        module = findModule(pc);
+    }
+    if (!module)
+        return loc;
+
+    loc.module = module->path;
+    loc.offset = pc - module->bias;
+
+    Image *image = imageFor(module->path);
+    if (!image)
+        return loc;
+    if (!image->parsed)
+        image->parse();
+
+    // Es una dirección de retorno: restando 1 cae dentro de la instrucción call
+    const uint64_t addr = loc.offset ? loc.offset - 1 : 0;
+
+    if (const Image::Symbol *sym = image->findSymbol(addr))
+    {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(sym->name, nullptr, nullptr, &status);
+        loc.function = (status == 0 && demangled) ? demangled : sym->name;
+        std::free(demangled);
+    }
+    if (const Image::Row *row = image->findRow(addr))
+    {
+        loc.file = image->files[row->file];
+        loc.line = row->line;
+    }
+    loc.resolved = !loc.function.empty() || loc.line > 0;
+#else
+    (void)pc;
+#endif
+    return loc;
+}
+
+bool Symbolizer::cached(const void *pc, Location &out) const
+{
+    std::lock_guard<std::mutex> lock(cacheMtx);
+    auto it = cache.find(reinterpret_cast<uintptr_t>(pc));
+    if (it == cache.end())
+        return false;
+    out = it->second;
+    return true;
+}
+
+size_t Symbolizer::cacheSize() const
+{
+    std::lock_guard<std::mutex> lock(cacheMtx);
+    return cache.size();
+}
+
+Symbolizer::String Symbolizer::format(const void *pc, const Location &loc)
+{
+    char buf[64];
+    if (loc.resolved)
+    {
+        String text = loc.function.empty() ? String("??") : loc.function;
+        if (loc.line > 0)
+        {
+            std::snprintf(buf, sizeof(buf), ":%d)", loc.line);
+            text += " (" + (loc.file.empty() ? String("??") : loc.file) + buf;
+        }
+        return text;
+    }
+    if (!loc.module.empty())
+    {
+        const size_t slash = loc.module.rfind('/');
+        std::snprintf(buf, sizeof(buf), "+0x%llx", static_cast<unsigned long long>(loc.offset));
+        return loc.module.substr(slash == String::npos ? 0 : slash + 1) + buf;
+    }
+    std::snprintf(buf, sizeof(buf), "0x%llx", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(pc)));
+    return buf;
+}
@@ -0,0 +1,97 @@
+#include "TscClock.h"
+#include <chrono>
+
+#if defined(MT_TSC_X86) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+//==================================================
+// Detección del contador
+//==================================================
+// El TSC solo sirve como reloj si es invariante: ritmo constante aunque
+// cambie la frecuencia o el núcleo duerma (CPUID 0x80000007, EDX bit 8).
+static bool mt_has_invariant_counter() noexcept
+{
+#if defined(MT_TSC_X86) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+        return false;
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+#elif defined(MT_TSC_X86)
+    if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u)
+        return false;
+    unsigned eax, ebx, ecx, edx;
+    __cpuid(0x80000007u, eax, ebx, ecx, edx);
+    return (edx & (1u << 8)) != 0;
+#elif defined(MT_TSC_ARM64)
+    // El contador genérico de ARMv8 tiene frecuencia fija por arquitectura
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t TscClock::steadyNs() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+//==================================================
+// Calibración
+//==================================================
+TscClock::TscClock() noexcept
+{
+    cpuCounter = mt_has_invariant_counter();
+    baseNs = steadyNs();
+    baseTicks.store(readCounter(), std::memory_order_relaxed);
+    if (!cpuCounter)
+        return;
+
+    // ~1 ms de espera activa: lo justo para que el primer factor sirva a
+    // los histogramas de vida; recalibrate() lo afina después.
+    uint64_t ns = baseNs;
+    const uint64_t startTicks = baseTicks.load(std::memory_order_relaxed);
+    uint64_t ticks = startTicks;
+    while (ns - baseNs < 1000000)
+    {
+        ns = steadyNs();
+        ticks = readCounter();
+    }
+
+    const double ticksPerNs = static_cast<double>(ticks - startTicks) / static_cast<double>(ns - baseNs);
+    if (!(ticksPerNs > 0.0))
+    {
+        cpuCounter = false;
+        baseTicks.store(readCounter(), std::memory_order_relaxed);
+        return;
+    }
+
+    // Menor desplazamiento con unidades de al menos 2 ns
+    shift = 0;
+    while (static_cast<double>(uint64_t(1) << shift) < 2.0 * ticksPerNs && shift < 16)
+        ++shift;
+    nsPerUnit.store(static_cast<double>(uint64_t(1) << shift) / ticksPerNs, std::memory_order_relaxed);
+}
+
+void TscClock::recalibrate() noexcept
+{
+    if (!cpuCounter)
+        return;
+
+    const uint64_t ns = steadyNs();
+    const uint64_t units = now() - advancedUnits.load(std::memory_order_relaxed);
+    // Con menos de 10 ms la base no mejora a la de arranque
+    if (ns - baseNs < 10000000 || units == 0)
+        return;
+    nsPerUnit.store(static_cast<double>(ns - baseNs) / static_cast<double>(units), std::memory_order_relaxed);
+}
+
+void TscClock::advance(uint64_t units) noexcept
+{
+    advancedUnits.fetch_add(units, std::memory_order_relaxed);
+    baseTicks.fetch_sub(units << shift, std::memory_order_relaxed);
+}
@@ -36,6 +36,30 @@ void ListenLogic::processData(const QString &keyword, const QByteArray &data)
         handleFileAllocations(parts);
     }
 
+    // ASIGNACIONES POR TAG - Ámbitos MT_SCOPE del cliente
+    if (keyword == "TAG_ALLOCATIONS")
+    {
+        handleTagAllocations(parts);
+    }
+
+    // ASIGNACIONES POR HILO - Y sitios con frees en otro hilo
+    if (keyword == "THREAD_ALLOCATIONS")
+    {
+        handleThreadAllocations(parts);
+    }
+
+    // ASIGNACIONES POR PILA DE LLAMADAS
+    if (keyword == "STACK_ALLOCATIONS")
+    {
+        handleStackAllocations(parts);
+    }
+
+    // MAPA DE MÓDULOS - Para simbolizar offline
+    if (keyword == "MODULE_MAP")
+    {
+        handleModuleMap(dataStr);
+    }
+
     // REPORTE DE LEAKS - Para la pestaña de memory leaks
     if (keyword == "LEAK_REPORT")
     {
@@ -47,6 +71,34 @@ void ListenLogic::processData(const QString &keyword, const QByteArray &data)
     {
         handleTimelinePoint(parts);
     }
+
+    // VIDA POR SITIO - Sitios con muchos bloques de vida corta
+    if (keyword == "LIFETIME_SUMMARY")
+    {
+        handleLifetimeSummary(parts);
+    }
+
+    // HISTOGRAMA DE TAMAÑOS - Para la gráfica de distribución
+    if (keyword == "SIZE_HISTOGRAM")
+    {
+        handleSizeHistogram(parts);
+    }
+
+    // SNAPSHOTS DEL HEAP - Respuestas a SNAPSHOT_TAKE / SNAPSHOT_DIFF
+    if (keyword == "SNAPSHOT_TAKEN")
+    {
+        handleSnapshotTaken(parts);
+    }
+    if (keyword == "SNAPSHOT_DIFF")
+    {
+        handleSnapshotDiff(parts);
+    }
+
+    // PRESUPUESTOS - Umbral de memoria cruzado en el cliente
+    if (keyword == "BUDGET_ALERT")
+    {
+        handleBudgetAlert(parts);
+    }
 }
 
 void ListenLogic::handleLiveUpdate(const QStringList &parts)
@@ -80,20 +132,42 @@ void ListenLogic::handleLiveUpdate(const QStringList &parts)
 
 void ListenLogic::handleGeneralMetrics(const QStringList &parts)
 {
-    if (parts.size() < 5)
+    // Formato: METRICS|total|activas|actual|pico|fugada[|overheadTracker|intervaloMuestreo
+    //          |holgura|rss|heapComprometido|heapEnUso|páginasVivas|ocupación]
+    if (parts.size() < 6 || parts[0] != "METRICS")
         return;
 
-    quint64 totalAllocs = parts[0].toULongLong();
-    quint64 activeAllocs = parts[1].toULongLong();
-    quint64 currentMem = parts[2].toULongLong();
-    quint64 peakMem = parts[3].toULongLong();
-    quint64 leakedMem = parts[4].toULongLong();
+    quint64 totalAllocs = parts[1].toULongLong();
+    quint64 activeAllocs = parts[2].toULongLong();
+    quint64 currentMem = parts[3].toULongLong();
+    quint64 peakMem = parts[4].toULongLong();
+    quint64 leakedMem = parts[5].toULongLong();
+    quint64 trackerOverhead = parts.size() > 6 ? parts[6].toULongLong() : 0;
+    quint64 sampleInterval = parts.size() > 7 ? parts[7].toULongLong() : 0; // 0 = conteo exacto
+
+    footprint = MemoryFootprint();
+    footprint.requestedBytes = currentMem;
+    if (parts.size() > 13)
+    {
+        footprint.slackBytes = parts[8].toULongLong();
+        footprint.rssBytes = parts[9].toULongLong();
+        footprint.heapCommitted = parts[10].toULongLong();
+        footprint.heapInUse = parts[11].toULongLong();
+        footprint.livePages = parts[12].toULongLong();
+        footprint.pageOccupancy = parts[13].toDouble();
+    }
 
     qDebug() << "[METRICS] TotalAllocs:" << totalAllocs
              << "ActiveAllocs:" << activeAllocs
              << "CurrentMem:" << bytesToMB(currentMem) << "MB"
              << "PeakMem:" << bytesToMB(peakMem) << "MB"
-             << "LeakedMem:" << bytesToMB(leakedMem) << "MB";
+             << "LeakedMem:" << bytesToMB(leakedMem) << "MB"
+             << "TrackerOverhead:" << bytesToMB(trackerOverhead) << "MB"
+             << "SampleInterval:" << sampleInterval << (sampleInterval ? "bytes (estimado)" : "(exacto)")
+             << "Slack:" << bytesToMB(footprint.slackBytes) << "MB"
+             << "RSS:" << bytesToMB(footprint.rssBytes) << "MB"
+             << "HeapCommitted:" << bytesToMB(footprint.heapCommitted) << "MB"
+             << "PageOccupancy:" << footprint.pageOccupancy * 100.0 << "%";
 
     // Aquí emitir señal para actualizar la pestaña de vista general
     // emit generalMetricsUpdated(totalAllocs, activeAllocs, currentMem, peakMem, leakedMem);
@@ -162,6 +236,58 @@ void ListenLogic::handleFileAllocations(const QStringList &parts)
     }
 }
 
+void ListenLogic::handleStackAllocations(const QStringList &parts)
+{
+    if (parts.size() < 2 || parts[0] != "STACK_SUMMARY_START")
+        return;
+
+    int stackCount = parts[1].toInt();
+    qDebug() << "[STACK_SUMMARY]" << stackCount << "stacks";
+
+    int index = 2;
+    for (int i = 0; i < stackCount && index + 4 < parts.size(); i++)
+    {
+        if (parts[index] == "STACK")
+        {
+            quint32 stackId = parts[index + 1].toUInt();
+            quint64 allocCount = parts[index + 2].toULongLong();
+            quint64 totalMemory = parts[index + 3].toULongLong();
+
+            // Frames separados por ';': "dirección" o "dirección=función (archivo:línea)"
+            QStringList frames;
+            for (const QString &frame : parts[index + 4].split(';', Qt::SkipEmptyParts))
+            {
+                int eq = frame.indexOf('=');
+                if (eq < 0)
+                    frames << formatAddress(frame.toULongLong());
+                else
+                    frames << frame.mid(eq + 1);
+            }
+
+            qDebug() << "[STACK] id:" << stackId
+                     << "allocs:" << allocCount << "totalMem:" << bytesToMB(totalMemory) << "MB"
+                     << "frames:" << frames.join(" <- ");
+
+            // emit stackSummaryAdded(stackId, allocCount, totalMemory, frames);
+            index += 5;
+        }
+    }
+}
+
+void ListenLogic::handleModuleMap(const QString &text)
+{
+    // Una línea por módulo: "inicio fin bias ruta" en hexadecimal
+    QStringList lines = text.split('\n', Qt::SkipEmptyParts);
+    qDebug() << "[MODULE_MAP]" << lines.size() << "modules";
+
+    for (const QString &line : lines)
+    {
+        qDebug() << "[MODULE]" << line;
+    }
+
+    // emit moduleMapReceived(text);
+}
+
 void ListenLogic::handleLeakReport(const QStringList &parts)
 {
     if (parts.size() < 7)
@@ -189,7 +315,7 @@ void ListenLogic::handleLeakReport(const QStringList &parts)
         qDebug() << "[LEAKS_START] count:" << leakCount;
 
         int index = 9;
-        for (int i = 0; i < leakCount && index + 6 <= parts.size(); i++)
+        for (int i = 0; i < leakCount && index + 7 < parts.size(); i++)
         {
             if (parts[index] == "LEAK")
             {
@@ -199,13 +325,15 @@ void ListenLogic::handleLeakReport(const QStringList &parts)
                 int line = parts[index + 4].toInt();
                 QString type = parts[index + 5];
                 quint64 timestamp = parts[index + 6].toULongLong();
+                QString location = parts[index + 7]; // vacío sin captura de pilas
 
                 qDebug() << "[LEAK] addr:" << formatAddress(addr)
                          << "size:" << size << "file:" << file << "line:" << line
-                         << "type:" << type << "timestamp:" << timestamp;
+                         << "type:" << type << "timestamp:" << timestamp
+                         << "at:" << location;
 
-                // emit leakDetailAdded(addr, size, file, line, type, timestamp);
-                index += 7;
+                // emit leakDetailAdded(addr, size, file, line, type, timestamp, location);
+                index += 8;
             }
         }
     }
@@ -219,15 +347,260 @@ void ListenLogic::handleTimelinePoint(const QStringList &parts)
     quint64 timestamp = parts[1].toULongLong();
     quint64 currentMemory = parts[2].toULongLong();
     quint64 activeAllocations = parts[3].toULongLong();
+    // Clientes nuevos: RSS y lo que el allocator retiene además de lo pedido
+    quint64 rss = parts.size() > 5 ? parts[4].toULongLong() : 0;
+    quint64 allocatorOverhead = parts.size() > 5 ? parts[5].toULongLong() : 0;
 
     qDebug() << "[TIMELINE] Time:" << timestamp << "ms"
              << "Memory:" << bytesToMB(currentMemory) << "MB"
-             << "Active allocs:" << activeAllocations;
+             << "Active allocs:" << activeAllocations
+             << "RSS:" << bytesToMB(rss) << "MB"
+             << "Allocator overhead:" << bytesToMB(allocatorOverhead) << "MB";
 
     // Aquí emitir señal para actualizar la línea de tiempo
     // emit timelinePointAdded(timestamp, currentMemory, activeAllocations);
 }
 
+void ListenLogic::handleSizeHistogram(const QStringList &parts)
+{
+    if (parts.size() < 6 || parts[0] != "SIZE_HISTOGRAM")
+        return;
+
+    SizeHistogram histogram;
+    histogram.p50 = parts[1].toULongLong();
+    histogram.p99 = parts[2].toULongLong();
+    histogram.activeP50 = parts[3].toULongLong();
+    histogram.activeP99 = parts[4].toULongLong();
+    int classCount = parts[5].toInt();
+
+    qDebug() << "[SIZE_HISTOGRAM] p50:" << histogram.p50 << "p99:" << histogram.p99
+             << "live p50:" << histogram.activeP50 << "live p99:" << histogram.activeP99
+             << "classes:" << classCount;
+
+    int index = 6;
+    for (int i = 0; i < classCount && index + 6 < parts.size(); i++)
+    {
+        if (parts[index] == "CLASS")
+        {
+            SizeClass c;
+            c.minSize = parts[index + 1].toULongLong();
+            c.maxSize = parts[index + 2].toULongLong();
+            c.totalAllocations = parts[index + 3].toULongLong();
+            c.totalBytes = parts[index + 4].toULongLong();
+            c.activeAllocations = parts[index + 5].toULongLong();
+            c.activeBytes = parts[index + 6].toULongLong();
+            histogram.classes.append(c);
+            index += 7;
+        }
+    }
+
+    sizeHistogram = histogram;
+}
+
+void ListenLogic::handleLifetimeSummary(const QStringList &parts)
+{
+    if (parts.size() < 3 || parts[0] != "LIFETIME_SUMMARY_START")
+        return;
+
+    int siteCount = parts[1].toInt();
+    quint64 thresholdUs = parts[2].toULongLong();
+    qDebug() << "[LIFETIME_SUMMARY]" << siteCount << "sites, short-lived <" << thresholdUs << "us";
+
+    int index = 3;
+    for (int i = 0; i < siteCount && index + 6 < parts.size(); i++)
+    {
+        if (parts[index] == "SITE")
+        {
+            QString file = parts[index + 1];
+            int line = parts[index + 2].toInt();
+            quint64 freedCount = parts[index + 3].toULongLong();
+            double medianUs = parts[index + 4].toDouble();
+            double p99Us = parts[index + 5].toDouble();
+            double shortLived = parts[index + 6].toDouble();
+
+            qDebug() << "[SITE]" << file << ":" << line
+                     << "freed:" << freedCount << "median:" << medianUs << "us"
+                     << "p99:" << p99Us << "us" << "short-lived:" << shortLived * 100.0 << "%";
+
+            // emit lifetimeSummaryAdded(file, line, freedCount, medianUs, p99Us, shortLived);
+            index += 7;
+        }
+    }
+}
+
+void ListenLogic::handleSnapshotTaken(const QStringList &parts)
+{
+    if (parts.size() < 5 || parts[0] != "SNAPSHOT")
+        return;
+
+    quint32 id = parts[1].toUInt();
+    qDebug() << "[SNAPSHOT]" << id << "at" << parts[2].toLongLong()
+             << "active:" << parts[3].toULongLong() << "current:" << bytesToMB(parts[4].toULongLong()) << "MB";
+    snapshots.append(id);
+}
+
+void ListenLogic::handleSnapshotDiff(const QStringList &parts)
+{
+    if (parts.size() < 9 || parts[0] != "SNAPSHOT_DIFF_START")
+        return;
+
+    SnapshotDiff diff;
+    diff.fromId = parts[1].toUInt();
+    diff.toId = parts[2].toUInt();
+    diff.complete = parts[3].toInt() != 0;
+    diff.appearedCount = parts[4].toULongLong();
+    diff.appearedBytes = parts[5].toULongLong();
+    diff.disappearedCount = parts[6].toULongLong();
+    diff.disappearedBytes = parts[7].toULongLong();
+    int changeCount = parts.size() > 8 ? parts[8].toInt() : 0;
+
+    qDebug() << "[SNAPSHOT_DIFF]" << diff.fromId << "->" << diff.toId
+             << "appeared:" << diff.appearedCount << "(" << bytesToMB(diff.appearedBytes) << "MB)"
+             << "disappeared:" << diff.disappearedCount << "(" << bytesToMB(diff.disappearedBytes) << "MB)"
+             << (diff.complete ? "" : "[incompleto]");
+
+    int index = 9;
+    for (int i = 0; i < changeCount && index + 9 < parts.size(); i++)
+    {
+        if (parts[index] == "CHANGE")
+        {
+            SnapshotChange c;
+            c.file = parts[index + 1];
+            c.line = parts[index + 2].toInt();
+            c.type = parts[index + 3];
+            c.minSize = parts[index + 4].toULongLong();
+            c.maxSize = parts[index + 5].toULongLong();
+            c.appearedCount = parts[index + 6].toULongLong();
+            c.appearedBytes = parts[index + 7].toULongLong();
+            c.disappearedCount = parts[index + 8].toULongLong();
+            c.disappearedBytes = parts[index + 9].toULongLong();
+            diff.changes.append(c);
+            index += 10;
+        }
+    }
+
+    snapshotDiff = diff;
+}
+
+void ListenLogic::handleTagAllocations(const QStringList &parts)
+{
+    if (parts.size() < 2 || parts[0] != "TAG_ALLOCATIONS_START")
+        return;
+
+    int tagCount = parts[1].toInt();
+    qDebug() << "[TAG_ALLOCATIONS]" << tagCount << "tags";
+
+    QList<TagAllocation> tags;
+    int index = 2;
+    for (int i = 0; i < tagCount && index + 8 < parts.size(); i++)
+    {
+        if (parts[index] == "TAG")
+        {
+            TagAllocation tag;
+            tag.tagId = parts[index + 1].toUInt();
+            tag.name = parts[index + 2];
+            tag.allocationCount = parts[index + 3].toULongLong();
+            tag.totalBytes = parts[index + 4].toULongLong();
+            tag.liveCount = parts[index + 5].toULongLong();
+            tag.liveBytes = parts[index + 6].toULongLong();
+            tag.freedCount = parts[index + 7].toULongLong();
+            tag.peakBytes = parts[index + 8].toULongLong();
+            tags.append(tag);
+            index += 9;
+        }
+    }
+
+    tagAllocations = tags;
+}
+
+void ListenLogic::handleThreadAllocations(const QStringList &parts)
+{
+    if (parts.size() < 3 || parts[0] != "THREAD_ALLOCATIONS_START")
+        return;
+
+    int threadCount = parts[1].toInt();
+    int siteCount = parts[2].toInt();
+    qDebug() << "[THREAD_ALLOCATIONS]" << threadCount << "threads," << siteCount << "cross-thread sites";
+
+    ThreadAllocations result;
+    int index = 3;
+    for (int i = 0; i < threadCount && index + 11 < parts.size(); i++)
+    {
+        if (parts[index] == "THREAD")
+        {
+            ThreadAllocation t;
+            t.threadId = parts[index + 1].toUInt();
+            t.osThreadId = parts[index + 2].toULongLong();
+            t.name = parts[index + 3];
+            t.allocationCount = parts[index + 4].toULongLong();
+            t.totalBytes = parts[index + 5].toULongLong();
+            t.liveCount = parts[index + 6].toULongLong();
+            t.liveBytes = parts[index + 7].toULongLong();
+            t.freedCount = parts[index + 8].toULongLong();
+            t.peakBytes = parts[index + 9].toULongLong();
+            t.crossThreadFrees = parts[index + 10].toULongLong();
+            t.remoteFrees = parts[index + 11].toULongLong();
+            result.threads.append(t);
+            index += 12;
+        }
+    }
+
+    for (int i = 0; i < siteCount && index + 4 < parts.size(); i++)
+    {
+        if (parts[index] == "SITE")
+        {
+            CrossFreeSite site;
+            site.file = parts[index + 1];
+            site.line = parts[index + 2].toInt();
+            site.crossThreadFrees = parts[index + 3].toULongLong();
+            site.freedCount = parts[index + 4].toULongLong();
+            qDebug() << "[CROSS_FREE]" << site.file << ":" << site.line
+                     << site.crossThreadFrees << "of" << site.freedCount << "frees";
+            result.sites.append(site);
+            index += 5;
+        }
+    }
+
+    threadAllocations = result;
+}
+
+void ListenLogic::handleBudgetAlert(const QStringList &parts)
+{
+    // Formato: BUDGET|id|archivo|línea|límite|vivos|timestamp|n|SITE|archivo|línea|bytes|bloques...
+    if (parts.size() < 8 || parts[0] != "BUDGET")
+        return;
+
+    BudgetAlert alert;
+    alert.budgetId = parts[1].toUInt();
+    alert.file = parts[2];
+    alert.line = parts[3].toInt();
+    alert.limitBytes = parts[4].toULongLong();
+    alert.liveBytes = parts[5].toULongLong();
+    alert.timestamp = parts[6].toLongLong();
+    int siteCount = parts[7].toInt();
+
+    qDebug() << "[BUDGET]" << alert.budgetId
+             << (alert.file.isEmpty() ? QString("global") : QString("%1:%2").arg(alert.file).arg(alert.line))
+             << bytesToMB(alert.liveBytes) << "/" << bytesToMB(alert.limitBytes) << "MB";
+
+    int index = 8;
+    for (int i = 0; i < siteCount && index + 4 < parts.size(); i++)
+    {
+        if (parts[index] == "SITE")
+        {
+            BudgetSite site;
+            site.file = parts[index + 1];
+            site.line = parts[index + 2].toInt();
+            site.liveBytes = parts[index + 3].toULongLong();
+            site.liveCount = parts[index + 4].toULongLong();
+            alert.topSites.append(site);
+            index += 5;
+        }
+    }
+
+    budgetAlert = alert;
+}
+
 QString ListenLogic::bytesToMB(quint64 bytes)
 {
     return QString::number(bytes / (1024.0 * 1024.0), 'f', 2);
@@ -4,23 +4,171 @@
 #include <QDataStream>
 #include <QDebug>
 #include <QStringList>
+#include <QList>
 
 class ListenLogic
 {
 public:
+    // Último SIZE_HISTOGRAM recibido, para la gráfica de distribución
+    struct SizeClass
+    {
+        quint64 minSize;
+        quint64 maxSize;
+        quint64 totalAllocations;
+        quint64 totalBytes;
+        quint64 activeAllocations;
+        quint64 activeBytes;
+    };
+
+    struct SizeHistogram
+    {
+        quint64 p50 = 0;
+        quint64 p99 = 0;
+        quint64 activeP50 = 0;
+        quint64 activeP99 = 0;
+        QList<SizeClass> classes;
+    };
+
+    // Memoria pedida contra lo que cobran el allocator y el SO (GENERAL_METRICS)
+    struct MemoryFootprint
+    {
+        quint64 requestedBytes = 0;
+        quint64 slackBytes = 0;    // usable - pedido de los bloques vivos
+        quint64 rssBytes = 0;
+        quint64 heapCommitted = 0; // lo que malloc obtuvo del SO
+        quint64 heapInUse = 0;
+        quint64 livePages = 0;
+        double pageOccupancy = 0.0; // bytes vivos / bytes de las páginas que tocan
+    };
+
+    // Memoria por tag de MT_SCOPE (TAG_ALLOCATIONS)
+    struct TagAllocation
+    {
+        quint32 tagId;
+        QString name;
+        quint64 allocationCount;
+        quint64 totalBytes;
+        quint64 liveCount;
+        quint64 liveBytes;
+        quint64 freedCount;
+        quint64 peakBytes;
+    };
+
+    // Memoria por hilo que asignó (THREAD_ALLOCATIONS)
+    struct ThreadAllocation
+    {
+        quint32 threadId;
+        quint64 osThreadId;
+        QString name;
+        quint64 allocationCount;
+        quint64 totalBytes;
+        quint64 liveCount;
+        quint64 liveBytes;
+        quint64 freedCount;
+        quint64 peakBytes;
+        quint64 crossThreadFrees; // bloques suyos liberados en otro hilo
+        quint64 remoteFrees;      // bloques de otros hilos que liberó
+    };
+
+    // Sitio cuyos bloques se liberan en otro hilo
+    struct CrossFreeSite
+    {
+        QString file;
+        int line;
+        quint64 crossThreadFrees;
+        quint64 freedCount;
+    };
+
+    struct ThreadAllocations
+    {
+        QList<ThreadAllocation> threads;
+        QList<CrossFreeSite> sites;
+    };
+
+    // Presupuesto de memoria superado en el cliente (BUDGET_ALERT)
+    struct BudgetSite
+    {
+        QString file;
+        int line;
+        quint64 liveBytes;
+        quint64 liveCount;
+    };
+
+    struct BudgetAlert
+    {
+        quint32 budgetId = 0;
+        QString file; // vacío en el presupuesto global
+        int line = 0;
+        quint64 limitBytes = 0;
+        quint64 liveBytes = 0;
+        qint64 timestamp = 0;
+        QList<BudgetSite> topSites;
+    };
+
+    // Cambios entre dos snapshots del heap (SNAPSHOT_DIFF)
+    struct SnapshotChange
+    {
+        QString file;
+        int line;
+        QString type;
+        quint64 minSize;
+        quint64 maxSize;
+        quint64 appearedCount;
+        quint64 appearedBytes;
+        quint64 disappearedCount;
+        quint64 disappearedBytes;
+    };
+
+    struct SnapshotDiff
+    {
+        quint32 fromId = 0;
+        quint32 toId = 0;
+        bool complete = false;
+        quint64 appearedCount = 0;
+        quint64 appearedBytes = 0;
+        quint64 disappearedCount = 0;
+        quint64 disappearedBytes = 0;
+        QList<SnapshotChange> changes;
+    };
+
     ListenLogic() = default;
 
     void processData(const QString &keyword, const QByteArray &data);
+    const SizeHistogram &lastSizeHistogram() const { return sizeHistogram; }
+    const MemoryFootprint &lastFootprint() const { return footprint; }
+    // IDs de los snapshots tomados en el cliente, del más viejo al más nuevo
+    const QList<quint32> &snapshotIds() const { return snapshots; }
+    const SnapshotDiff &lastSnapshotDiff() const { return snapshotDiff; }
+    const BudgetAlert &lastBudgetAlert() const { return budgetAlert; }
+    const ThreadAllocations &lastThreadAllocations() const { return threadAllocations; }
+    const QList<TagAllocation> &lastTagAllocations() const { return tagAllocations; }
 
 private:
     void handleLiveUpdate(const QStringList &parts);
     void handleGeneralMetrics(const QStringList &parts);
     void handleMemoryMap(const QStringList &parts);
     void handleFileAllocations(const QStringList &parts);
+    void handleStackAllocations(const QStringList &parts);
+    void handleModuleMap(const QString &text);
     void handleLeakReport(const QStringList &parts);
     void handleTimelinePoint(const QStringList &parts);
+    void handleSizeHistogram(const QStringList &parts);
+    void handleLifetimeSummary(const QStringList &parts);
+    void handleSnapshotTaken(const QStringList &parts);
+    void handleSnapshotDiff(const QStringList &parts);
+    void handleBudgetAlert(const QStringList &parts);
+    void handleThreadAllocations(const QStringList &parts);
+    void handleTagAllocations(const QStringList &parts);
 
     // Métodos auxiliares para conversión
     QString bytesToMB(quint64 bytes);
     QString formatAddress(quint64 addr);
+
+    SizeHistogram sizeHistogram;
+    MemoryFootprint footprint;
+    QList<quint32> snapshots;
+    SnapshotDiff snapshotDiff;
+    BudgetAlert budgetAlert;
+    ThreadAllocations threadAllocations;
+    QList<TagAllocation> tagAllocations;
 };
\ No newline at end of file
@@ -7,6 +7,11 @@
 #include <QTableWidget>
 #include <QLabel>
 #include <QChartView>
+#include <QChart>
+#include <QBarSeries>
+#include <QBarSet>
+#include <QBarCategoryAxis>
+#include <QValueAxis>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QStackedWidget>
@@ -161,6 +166,7 @@ void MainWindow::onClientDisconnected()
     if (clientSocket)
     {
         clients.removeOne(clientSocket);
+        pendingData.remove(clientSocket);
         clientSocket->deleteLater();
         clientsConnectedLabel->setText("Clientes conectados: " + QString::number(clients.size()));
 
@@ -179,8 +185,27 @@ void MainWindow::onReadyRead()
     if (!clientSocket)
         return;
 
-    QByteArray data = clientSocket->readAll();
-    processData(data);
+    // Un read puede traer varios paquetes juntos o uno cortado al final
+    QByteArray &pending = pendingData[clientSocket];
+    pending.append(clientSocket->readAll());
+
+    const int headerSize = int(sizeof(quint16) + sizeof(quint32));
+    while (pending.size() >= headerSize)
+    {
+        QDataStream stream(pending);
+        stream.setByteOrder(QDataStream::BigEndian);
+        quint16 keywordLen;
+        quint32 dataLen;
+        stream >> keywordLen >> dataLen;
+
+        const qint64 total = qint64(headerSize) + keywordLen + dataLen;
+        if (pending.size() < total)
+            return;
+
+        const QByteArray packet = pending.left(int(total));
+        pending.remove(0, int(total));
+        processData(packet);
+    }
 }
 
 void MainWindow::processData(const QByteArray &data)
@@ -196,14 +221,10 @@ void MainWindow::processData(const QByteArray &data)
     quint16 keywordLen;
     quint32 dataLen;
 
-    // Leer las longitudes
-    if (stream.readRawData(reinterpret_cast<char*>(&keywordLen), sizeof(keywordLen)) != sizeof(keywordLen)) {
-        qDebug() << "✗ Error: No se pudo leer la longitud del keyword";
-        return;
-    }
-
-    if (stream.readRawData(reinterpret_cast<char*>(&dataLen), sizeof(dataLen)) != sizeof(dataLen)) {
-        qDebug() << "✗ Error: No se pudo leer la longitud de los datos";
+    // Leer las longitudes (big-endian, como las escribe el cliente)
+    stream >> keywordLen >> dataLen;
+    if (stream.status() != QDataStream::Ok) {
+        qDebug() << "✗ Error: No se pudo leer la cabecera del paquete";
         return;
     }
 
@@ -233,6 +254,20 @@ void MainWindow::processData(const QByteArray &data)
     // Procesar según el keyword usando ListenLogic
     if (listenLogic) {
         listenLogic->processData(keyword, receivedData);
+        if (keyword == "SIZE_HISTOGRAM")
+            updateSizeDistributionChart(listenLogic->lastSizeHistogram());
+        if (keyword == "GENERAL_METRICS")
+            updateFootprint(listenLogic->lastFootprint());
+        if (keyword == "SNAPSHOT_TAKEN")
+            snapshotDiffLabel->setText(QString("Snapshot #%1 tomado").arg(listenLogic->snapshotIds().last()));
+        if (keyword == "SNAPSHOT_DIFF")
+            updateSnapshotDiff(listenLogic->lastSnapshotDiff());
+        if (keyword == "BUDGET_ALERT")
+            updateBudgetAlert(listenLogic->lastBudgetAlert());
+        if (keyword == "THREAD_ALLOCATIONS")
+            updateThreadTable(listenLogic->lastThreadAllocations());
+        if (keyword == "TAG_ALLOCATIONS")
+            updateTagTable(listenLogic->lastTagAllocations());
     } else {
         qDebug() << "✗ Error: ListenLogic no está inicializado";
     }
@@ -264,6 +299,21 @@ void MainWindow::setupOverviewTab()
     metricsLayout->addWidget(maxMemoryLabel, 1, 1);
     metricsLayout->addWidget(totalAllocationsLabel, 2, 0, 1, 2);
 
+    // Lo pedido junto a lo que cobran el allocator y el SO
+    requestedMemoryLabel = new QLabel("Pedido: 0 MB");
+    allocatorOverheadLabel = new QLabel("Overhead del allocator: 0 MB");
+    rssLabel = new QLabel("RSS: 0 MB");
+    pageOccupancyLabel = new QLabel("Ocupación de páginas: -");
+    metricsLayout->addWidget(requestedMemoryLabel, 3, 0);
+    metricsLayout->addWidget(allocatorOverheadLabel, 3, 1);
+    metricsLayout->addWidget(rssLabel, 4, 0);
+    metricsLayout->addWidget(pageOccupancyLabel, 4, 1);
+
+    // Último presupuesto de memoria superado en el cliente
+    budgetAlertLabel = new QLabel("Presupuestos: sin avisos");
+    budgetAlertLabel->setWordWrap(true);
+    metricsLayout->addWidget(budgetAlertLabel, 5, 0, 1, 2);
+
     metricsGroup->setLayout(metricsLayout);
 
     // Línea de tiempo (área para gráfico)
@@ -288,10 +338,21 @@ void MainWindow::setupOverviewTab()
     summaryLayout->addWidget(topFilesTable);
     summaryGroup->setLayout(summaryLayout);
 
+    // Por subsistema lógico (MT_SCOPE en el cliente)
+    QGroupBox *tagGroup = new QGroupBox("Memoria por Tag (MT_SCOPE)");
+    QVBoxLayout *tagLayout = new QVBoxLayout();
+    tagTable = new QTableWidget();
+    tagTable->setColumnCount(5);
+    tagTable->setHorizontalHeaderLabels({"Tag", "Bloques vivos", "Memoria viva (MB)", "Pico (MB)", "Total (MB)"});
+    tagTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    tagLayout->addWidget(tagTable);
+    tagGroup->setLayout(tagLayout);
+
     // Organizar en el layout principal
     overviewLayout->addWidget(metricsGroup, 0, 0);
     overviewLayout->addWidget(timelineGroup, 1, 0);
     overviewLayout->addWidget(summaryGroup, 2, 0);
+    overviewLayout->addWidget(tagGroup, 3, 0);
 
     // Configurar proporciones
     overviewLayout->setRowStretch(1, 3); // La gráfica ocupa más espacio
@@ -345,11 +406,22 @@ void MainWindow::setupAllocationByFileTab()
     tableLayout->addWidget(allocationTable);
     tableGroup->setLayout(tableLayout);
 
+    // Por hilo que asignó: cuánto retiene cada uno y cuánto libera otro hilo
+    QGroupBox *threadGroup = new QGroupBox("Memoria por Hilo");
+    QVBoxLayout *threadLayout = new QVBoxLayout();
+    threadTable = new QTableWidget();
+    threadTable->setColumnCount(5);
+    threadTable->setHorizontalHeaderLabels({"Hilo", "Bloques vivos", "Memoria viva (MB)", "Total (MB)", "Liberados en otro hilo"});
+    threadTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    threadLayout->addWidget(threadTable);
+    threadGroup->setLayout(threadLayout);
+
     // Organizar en splitter para redimensionamiento
     QSplitter *splitter = new QSplitter(Qt::Vertical);
     splitter->addWidget(chartGroup);
     splitter->addWidget(tableGroup);
-    splitter->setSizes({400, 200});
+    splitter->addWidget(threadGroup);
+    splitter->setSizes({400, 200, 150});
 
     allocationByFileLayout->addWidget(splitter, 0, 0);
 }
@@ -394,10 +466,202 @@ void MainWindow::setupMemoryLeaksTab()
 
     chartsGroup->setLayout(chartsLayout);
 
+    // Snapshots: crecimiento entre dos momentos, por sitio y tipo
+    QGroupBox *snapshotGroup = new QGroupBox("Snapshots del heap");
+    QGridLayout *snapshotLayout = new QGridLayout();
+
+    QPushButton *takeSnapshotButton = new QPushButton("Tomar snapshot");
+    QPushButton *diffSnapshotButton = new QPushButton("Comparar con el último snapshot");
+    connect(takeSnapshotButton, &QPushButton::clicked, this, &MainWindow::onTakeSnapshotClicked);
+    connect(diffSnapshotButton, &QPushButton::clicked, this, &MainWindow::onDiffSnapshotClicked);
+
+    snapshotDiffLabel = new QLabel("Sin snapshots");
+    snapshotDiffTable = new QTableWidget();
+    snapshotDiffTable->setColumnCount(5);
+    snapshotDiffTable->setHorizontalHeaderLabels({"Sitio", "Tipo", "Tamaño", "Nuevas (MB)", "Liberadas (MB)"});
+    snapshotDiffTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    snapshotLayout->addWidget(takeSnapshotButton, 0, 0);
+    snapshotLayout->addWidget(diffSnapshotButton, 0, 1);
+    snapshotLayout->addWidget(snapshotDiffLabel, 1, 0, 1, 2);
+    snapshotLayout->addWidget(snapshotDiffTable, 2, 0, 1, 2);
+    snapshotGroup->setLayout(snapshotLayout);
+
     // Organizar en el layout principal
     memoryLeaksLayout->addWidget(summaryGroup, 0, 0);
     memoryLeaksLayout->addWidget(chartsGroup, 1, 0);
+    memoryLeaksLayout->addWidget(snapshotGroup, 2, 0);
 
     // Configurar proporciones
     memoryLeaksLayout->setRowStretch(1, 3); // Los gráficos ocupan más espacio
 }
+
+void MainWindow::sendCommand(const QString &keyword, const QByteArray &data)
+{
+    QByteArray packet;
+    QDataStream stream(&packet, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    const QByteArray keywordBytes = keyword.toUtf8();
+    stream << quint16(keywordBytes.size());
+    stream << quint32(data.size());
+    packet.append(keywordBytes);
+    packet.append(data);
+
+    for (QTcpSocket *client : clients)
+        client->write(packet);
+}
+
+void MainWindow::onTakeSnapshotClicked()
+{
+    sendCommand("SNAPSHOT_TAKE");
+}
+
+void MainWindow::onDiffSnapshotClicked()
+{
+    // Contra el heap actual: el cliente toma un snapshot temporal para `to`
+    if (!listenLogic || listenLogic->snapshotIds().isEmpty())
+    {
+        snapshotDiffLabel->setText("Primero hay que tomar un snapshot");
+        return;
+    }
+    sendCommand("SNAPSHOT_DIFF", QByteArray::number(listenLogic->snapshotIds().last()) + "|0");
+}
+
+void MainWindow::updateSnapshotDiff(const ListenLogic::SnapshotDiff &diff)
+{
+    snapshotDiffLabel->setText(QString("Desde snapshot #%1: +%2 bloques (%3 MB), -%4 bloques (%5 MB)%6")
+                                   .arg(diff.fromId)
+                                   .arg(diff.appearedCount)
+                                   .arg(diff.appearedBytes / (1024.0 * 1024.0), 0, 'f', 2)
+                                   .arg(diff.disappearedCount)
+                                   .arg(diff.disappearedBytes / (1024.0 * 1024.0), 0, 'f', 2)
+                                   .arg(diff.complete ? "" : " [incompleto]"));
+
+    snapshotDiffTable->setRowCount(diff.changes.size());
+    for (int row = 0; row < diff.changes.size(); ++row)
+    {
+        const ListenLogic::SnapshotChange &c = diff.changes[row];
+        snapshotDiffTable->setItem(row, 0, new QTableWidgetItem(QString("%1:%2").arg(c.file).arg(c.line)));
+        snapshotDiffTable->setItem(row, 1, new QTableWidgetItem(c.type));
+        snapshotDiffTable->setItem(row, 2, new QTableWidgetItem(c.minSize == c.maxSize ? QString::number(c.minSize)
+                                                                                       : QString("%1-%2").arg(c.minSize).arg(c.maxSize)));
+        snapshotDiffTable->setItem(row, 3, new QTableWidgetItem(QString::number(c.appearedBytes / (1024.0 * 1024.0), 'f', 2)));
+        snapshotDiffTable->setItem(row, 4, new QTableWidgetItem(QString::number(c.disappearedBytes / (1024.0 * 1024.0), 'f', 2)));
+    }
+}
+
+void MainWindow::updateFootprint(const ListenLogic::MemoryFootprint &footprint)
+{
+    auto mb = [](quint64 bytes)
+    { return QString::number(bytes / (1024.0 * 1024.0), 'f', 2); };
+
+    // Overhead: lo que malloc obtuvo del SO y no se pidió (holgura de cada
+    // bloque, cabeceras de malloc, listas libres y memoria no registrada)
+    const quint64 overhead = footprint.heapCommitted > footprint.requestedBytes ? footprint.heapCommitted - footprint.requestedBytes : 0;
+    requestedMemoryLabel->setText("Pedido: " + mb(footprint.requestedBytes) + " MB");
+    allocatorOverheadLabel->setText("Overhead del allocator: " + mb(overhead) + " MB (holgura: " + mb(footprint.slackBytes) + " MB)");
+    rssLabel->setText("RSS: " + mb(footprint.rssBytes) + " MB");
+    if (footprint.livePages)
+        pageOccupancyLabel->setText(QString("Ocupación de páginas: %1% de %2 páginas").arg(footprint.pageOccupancy * 100.0, 0, 'f', 1).arg(footprint.livePages));
+    else
+        pageOccupancyLabel->setText("Ocupación de páginas: -");
+}
+
+void MainWindow::updateTagTable(const QList<ListenLogic::TagAllocation> &tags)
+{
+    auto mb = [](quint64 bytes)
+    { return QString::number(bytes / (1024.0 * 1024.0), 'f', 2); };
+
+    tagTable->setRowCount(tags.size());
+    for (int row = 0; row < tags.size(); ++row)
+    {
+        const ListenLogic::TagAllocation &t = tags[row];
+        tagTable->setItem(row, 0, new QTableWidgetItem(t.name));
+        tagTable->setItem(row, 1, new QTableWidgetItem(QString::number(t.liveCount)));
+        tagTable->setItem(row, 2, new QTableWidgetItem(mb(t.liveBytes)));
+        tagTable->setItem(row, 3, new QTableWidgetItem(mb(t.peakBytes)));
+        tagTable->setItem(row, 4, new QTableWidgetItem(mb(t.totalBytes)));
+    }
+}
+
+void MainWindow::updateThreadTable(const ListenLogic::ThreadAllocations &allocations)
+{
+    auto mb = [](quint64 bytes)
+    { return QString::number(bytes / (1024.0 * 1024.0), 'f', 2); };
+
+    threadTable->setRowCount(allocations.threads.size());
+    for (int row = 0; row < allocations.threads.size(); ++row)
+    {
+        const ListenLogic::ThreadAllocation &t = allocations.threads[row];
+        const QString name = t.name.isEmpty() ? QString("#%1").arg(t.threadId) : QString("#%1 %2").arg(t.threadId).arg(t.name);
+        threadTable->setItem(row, 0, new QTableWidgetItem(name));
+        threadTable->setItem(row, 1, new QTableWidgetItem(QString::number(t.liveCount)));
+        threadTable->setItem(row, 2, new QTableWidgetItem(mb(t.liveBytes)));
+        threadTable->setItem(row, 3, new QTableWidgetItem(mb(t.totalBytes)));
+        threadTable->setItem(row, 4, new QTableWidgetItem(QString("%1 de %2").arg(t.crossThreadFrees).arg(t.freedCount)));
+    }
+}
+
+void MainWindow::updateBudgetAlert(const ListenLogic::BudgetAlert &alert)
+{
+    auto mb = [](quint64 bytes)
+    { return QString::number(bytes / (1024.0 * 1024.0), 'f', 2); };
+
+    QString text = QString("Presupuesto #%1 (%2) superado: %3 MB de %4 MB")
+                       .arg(alert.budgetId)
+                       .arg(alert.file.isEmpty() ? QString("global") : QString("%1:%2").arg(alert.file).arg(alert.line))
+                       .arg(mb(alert.liveBytes))
+                       .arg(mb(alert.limitBytes));
+    for (const ListenLogic::BudgetSite &site : alert.topSites)
+        text += QString("\n  %1:%2  %3 MB en %4 bloques").arg(site.file).arg(site.line).arg(mb(site.liveBytes)).arg(site.liveCount);
+    budgetAlertLabel->setText(text);
+    budgetAlertLabel->setStyleSheet("color: #c0392b;");
+}
+
+void MainWindow::updateSizeDistributionChart(const ListenLogic::SizeHistogram &histogram)
+{
+    // Una barra por clase de tamaño: asignaciones acumuladas y vivas
+    QBarSet *totalSet = new QBarSet("Total");
+    QBarSet *activeSet = new QBarSet("Vivas");
+    QStringList categories;
+    quint64 maxCount = 0;
+
+    for (const ListenLogic::SizeClass &c : histogram.classes)
+    {
+        *totalSet << c.totalAllocations;
+        *activeSet << c.activeAllocations;
+        categories << (c.minSize == c.maxSize ? QString::number(c.minSize)
+                                              : QString("%1-%2").arg(c.minSize).arg(c.maxSize));
+        maxCount = qMax(maxCount, c.totalAllocations);
+    }
+
+    QBarSeries *series = new QBarSeries();
+    series->append(totalSet);
+    series->append(activeSet);
+
+    QChart *chart = new QChart();
+    chart->addSeries(series);
+    chart->setTitle(QString("Distribución de tamaños (p50: %1 B, p99: %2 B | vivas p50: %3 B, p99: %4 B)")
+                        .arg(histogram.p50)
+                        .arg(histogram.p99)
+                        .arg(histogram.activeP50)
+                        .arg(histogram.activeP99));
+
+    QBarCategoryAxis *axisX = new QBarCategoryAxis();
+    axisX->append(categories);
+    axisX->setLabelsAngle(-60);
+    chart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+
+    QValueAxis *axisY = new QValueAxis();
+    axisY->setRange(0, static_cast<double>(maxCount));
+    axisY->setLabelFormat("%d");
+    chart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
+
+    // setChart() no libera la gráfica anterior
+    QChart *previous = leaksDistributionChartView->chart();
+    leaksDistributionChartView->setChart(chart);
+    delete previous;
+}
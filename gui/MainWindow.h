@@ -17,6 +17,7 @@
 #include <QByteArray>
 #include <QStackedWidget>
 #include <QList>
+#include <QHash>
 #include "ListenLogic.h" // Incluir el nuevo header
 
 class MainWindow : public QMainWindow
@@ -32,6 +33,8 @@ private slots:
     void onNewConnection();
     void onClientDisconnected();
     void onReadyRead();
+    void onTakeSnapshotClicked();
+    void onDiffSnapshotClicked();
 
 private:
     // ... otras variables existentes ...
@@ -46,9 +49,18 @@ private:
     void onGeneralMetricsUpdated(quint64 totalAllocs, quint64 activeAllocs,
                                  quint64 currentMem, quint64 peakMem, quint64 leakedMem);
     void onTimelinePointAdded(quint64 timestamp, quint64 currentMemory, quint64 activeAllocations);
+    void updateSizeDistributionChart(const ListenLogic::SizeHistogram &histogram);
+    void updateFootprint(const ListenLogic::MemoryFootprint &footprint);
+    void updateSnapshotDiff(const ListenLogic::SnapshotDiff &diff);
+    void updateBudgetAlert(const ListenLogic::BudgetAlert &alert);
+    void updateThreadTable(const ListenLogic::ThreadAllocations &allocations);
+    void updateTagTable(const QList<ListenLogic::TagAllocation> &tags);
+    // Pedido a los clientes: [keyword_len][data_len][keyword][data]
+    void sendCommand(const QString &keyword, const QByteArray &data = QByteArray());
 
     QTcpServer *tcpServer;
     QList<QTcpSocket *> clients;
+    QHash<QTcpSocket *, QByteArray> pendingData; // paquetes recibidos a medias, por cliente
     ListenLogic *listenLogic; // Nueva instancia de ListenLogic
 
     // Connection Tab
@@ -70,8 +82,14 @@ private:
     QLabel *memoryLeaksLabel;
     QLabel *maxMemoryLabel;
     QLabel *totalAllocationsLabel;
+    QLabel *requestedMemoryLabel;
+    QLabel *allocatorOverheadLabel;
+    QLabel *rssLabel;
+    QLabel *pageOccupancyLabel;
+    QLabel *budgetAlertLabel;
     QChartView *timelineChartView;
     QTableWidget *topFilesTable;
+    QTableWidget *tagTable;
 
     // Memory Map Tab
     QWidget *memoryMapTab;
@@ -83,6 +101,7 @@ private:
     QGridLayout *allocationByFileLayout;
     QChartView *allocationChartView;
     QTableWidget *allocationTable;
+    QTableWidget *threadTable;
 
     // Memory Leaks Tab
     QWidget *memoryLeaksTab;
@@ -94,6 +113,8 @@ private:
     QChartView *leaksByFileChartView;
     QChartView *leaksDistributionChartView;
     QChartView *leaksTimelineChartView;
+    QLabel *snapshotDiffLabel;
+    QTableWidget *snapshotDiffTable;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,65 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Presupuestos de memoria
+//==================================================
+
+// Presupuesto de un sitio: avisa una vez al cruzar el límite
+static void testSiteBudget()
+{
+    constexpr size_t kLimit = 64 * 1024;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool fired = false;
+    MemoryTracker::BudgetAlert alert{};
+
+    const int line = __LINE__; auto allocate = []() { return new char[1024]; };
+    const uint32_t id = tracker.setSiteBudget(__FILE__, line, kLimit,
+                                              [&](const MemoryTracker::BudgetAlert &a)
+                                              {
+                                                  std::lock_guard<std::mutex> lock(mtx);
+                                                  alert = a;
+                                                  fired = true;
+                                                  cv.notify_all();
+                                              });
+
+    std::vector<char *> blocks;
+    blocks.reserve(100);
+    for (int i = 0; i < 100; ++i)
+        blocks.push_back(allocate());
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock, std::chrono::seconds(5), [&]()
+                    { return fired; });
+        MT_CHECK(fired);
+        MT_CHECK(alert.budgetId == id);
+        MT_CHECK(alert.file == __FILE__);
+        MT_CHECK(alert.line == line);
+        MT_CHECK(alert.limitBytes == kLimit);
+        MT_CHECK(alert.liveBytes >= kLimit);
+    }
+    tracker.removeBudget(id);
+
+    for (char *p : blocks)
+        delete[] p;
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("site budget", testSiteBudget);
+
+    return mt_check_result();
+}
@@ -0,0 +1,136 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include "TrackerQueries.h"
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Modo buffered
+//==================================================
+
+// Modo buffered: nada se aplica hasta drenar, y un free en otro hilo
+// encuentra su Alloc aunque los eventos vengan de buffers distintos
+static void testBufferedMode()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    // Sin drenado periódico: solo flushEvents() o un ring lleno aplican
+    tracker.enableBufferedMode(std::chrono::hours(1));
+
+    constexpr int kBlocks = 5000; // más que un ring: fuerza el drenado en el productor
+    int line = 0;
+    std::vector<int *> blocks(kBlocks);
+    uint32_t producerId = 0;
+    std::thread producer([&]()
+                         {
+                             producerId = tracker.currentThreadId();
+                             MT_SCOPE("buffered");
+                             for (int *&p : blocks)
+                                 p = MT_TEST_NEW(line, int[4]); });
+    producer.join();
+
+    for (int i = 0; i < kBlocks; i += 2)
+        delete[] blocks[i];
+    tracker.flushEvents();
+
+    MemoryTracker::SiteSummary site = siteAt(__FILE__, line);
+    MT_CHECK(site.allocationCount == kBlocks);
+    MT_CHECK(site.freedCount == kBlocks / 2);
+    MT_CHECK(site.liveCount == kBlocks / 2);
+    MT_CHECK(site.liveMemory == kBlocks / 2 * 4 * sizeof(int));
+    MT_CHECK(site.crossThreadFrees == kBlocks / 2);
+
+    // Hilo y tag los resuelve el agregador
+    MT_CHECK(tagNamed("buffered").liveCount == kBlocks / 2);
+    MemoryTracker::ReportEntry entry{};
+    MT_CHECK(findLive(blocks[1], entry));
+    MT_CHECK(entry.threadId == producerId);
+    MT_CHECK(entry.tag == "buffered");
+
+    for (int i = 1; i < kBlocks; i += 2)
+        delete[] blocks[i];
+    tracker.disableBufferedMode();
+
+    site = siteAt(__FILE__, line);
+    MT_CHECK(site.freedCount == kBlocks);
+    MT_CHECK(site.liveCount == 0);
+    MT_CHECK(!tracker.isBufferedMode());
+}
+
+struct MemoryTrackerTestAccess
+{
+    static uint64_t now(MemoryTracker &tracker) { return tracker.clock.now(); }
+    static bool alloc(MemoryTracker &tracker, void *ptr, size_t size, int line, uint64_t stamp, bool outOfOrder)
+    {
+        return tracker.applyAllocation(ptr, size, __FILE__, line, "char[]", stamp, 0, StackTable::kNoStack, 0,
+                                       tracker.currentThreadId(), 0, outOfOrder);
+    }
+    static bool free(MemoryTracker &tracker, void *ptr, uint64_t stamp, bool outOfOrder)
+    {
+        return tracker.applyFree(ptr, stamp, tracker.currentThreadId(), 0, 0, outOfOrder);
+    }
+};
+
+// Un drenado puede aplicar el Alloc de una reutilización de p antes que el
+// Alloc y el Free viejos de p, publicados por otro hilo después de que se
+// recorrió su buffer. El registro nuevo tiene que sobrevivir a los dos.
+static void testLateEventsKeepNewerRecord()
+{
+    using Access = MemoryTrackerTestAccess;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    void *const p = reinterpret_cast<void *>(uintptr_t(0x7E57000));
+    const int oldLine = __LINE__;
+    const int newLine = oldLine + 1;
+    const uint64_t t = Access::now(tracker);
+    const size_t before = tracker.getCurrentStats().currentMemory;
+
+    MT_CHECK(Access::alloc(tracker, p, 64, newLine, t + 300, true));
+    MT_CHECK(!Access::alloc(tracker, p, 32, oldLine, t + 100, true));
+    MT_CHECK(!Access::free(tracker, p, t + 200, true));
+
+    MT_CHECK(siteAt(__FILE__, newLine).liveCount == 1);
+    MT_CHECK(siteAt(__FILE__, oldLine).allocationCount == 0);
+    MT_CHECK(tracker.getCurrentStats().currentMemory == before + 64);
+
+    MT_CHECK(Access::free(tracker, p, t + 400, true));
+    MT_CHECK(siteAt(__FILE__, newLine).liveCount == 0);
+    MT_CHECK(tracker.getCurrentStats().currentMemory == before);
+}
+
+// Un Alloc sobre un registro cuyo Free nunca se vio lo da de baja antes de
+// pisarlo: los contadores no cuentan el bloque dos veces
+static void testAllocOverStaleRecord()
+{
+    using Access = MemoryTrackerTestAccess;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    void *const p = reinterpret_cast<void *>(uintptr_t(0x7E58000));
+    const int staleLine = __LINE__;
+    const int freshLine = staleLine + 1;
+    const uint64_t t = Access::now(tracker);
+    const size_t before = tracker.getCurrentStats().currentMemory;
+
+    MT_CHECK(Access::alloc(tracker, p, 48, staleLine, t, false));
+    MT_CHECK(Access::alloc(tracker, p, 16, freshLine, t + 100, false));
+
+    MT_CHECK(siteAt(__FILE__, staleLine).liveCount == 0);
+    MT_CHECK(siteAt(__FILE__, staleLine).freedCount == 1);
+    MT_CHECK(siteAt(__FILE__, freshLine).liveCount == 1);
+    MT_CHECK(tracker.getCurrentStats().currentMemory == before + 16);
+
+    MT_CHECK(Access::free(tracker, p, t + 200, false));
+    MT_CHECK(tracker.getCurrentStats().currentMemory == before);
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("buffered mode", testBufferedMode);
+    mt_run_case("late events keep the newer record", testLateEventsKeepNewerRecord);
+    mt_run_case("alloc over a stale record", testAllocOverStaleRecord);
+
+    return mt_check_result();
+}
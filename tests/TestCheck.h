@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdio>
+
+//==================================================
+// Verificaciones de los tests de CTest
+//==================================================
+// Sin framework: cada test es un ejecutable que corre sus casos y termina
+// con código distinto de 0 si algún MT_CHECK falló. Un check fallido
+// informa y sigue, así una corrida muestra todos los problemas juntos.
+inline int &mt_check_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define MT_CHECK(cond)                                                                   \
+    do                                                                                   \
+    {                                                                                    \
+        if (!(cond))                                                                     \
+        {                                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++mt_check_failures();                                                       \
+        }                                                                                \
+    } while (0)
+
+// Para cifras estimadas (muestreo): |value - expected| <= expected * tolerance
+#define MT_CHECK_NEAR(value, expected, tolerance)                                              \
+    do                                                                                         \
+    {                                                                                          \
+        const double mt_v_ = static_cast<double>(value);                                       \
+        const double mt_e_ = static_cast<double>(expected);                                    \
+        if (mt_v_ < mt_e_ * (1.0 - (tolerance)) || mt_v_ > mt_e_ * (1.0 + (tolerance)))        \
+        {                                                                                      \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %.0f, expected %.0f +- %.0f%%\n", \
+                         __FILE__, __LINE__, #value, mt_v_, mt_e_, (tolerance) * 100.0);       \
+            ++mt_check_failures();                                                             \
+        }                                                                                      \
+    } while (0)
+
+// new con sitio conocido: con MemoryMacros.h incluido, el new que expande
+// lleva esta misma línea, así cada caso encuentra su sitio en los reportes
+#define MT_TEST_NEW(lineOut, ...) ((lineOut) = __LINE__, new __VA_ARGS__)
+
+#if defined(_MSC_VER)
+#define MT_TEST_NOINLINE __declspec(noinline)
+#else
+#define MT_TEST_NOINLINE __attribute__((noinline))
+#endif
+
+// Corre un caso y avisa cuál falló
+template <typename Fn>
+void mt_run_case(const char *name, Fn &&fn)
+{
+    const int before = mt_check_failures();
+    fn();
+    std::printf("[%s] %s\n", mt_check_failures() == before ? " OK " : "FAIL", name);
+    std::fflush(stdout);
+}
+
+inline int mt_check_result()
+{
+    if (mt_check_failures())
+        std::fprintf(stderr, "%d check(s) failed\n", mt_check_failures());
+    return mt_check_failures() ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include <cstdint>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Fugas por alcanzabilidad
+//==================================================
+
+struct LeakNode
+{
+    LeakNode *next;
+    char payload[24];
+};
+
+static LeakNode *g_reachable = nullptr;
+
+// Las direcciones de la cadena perdida se guardan enmascaradas: como
+// puntero, el propio test las haría alcanzables
+static constexpr uintptr_t kAddressMask = static_cast<uintptr_t>(0x5A5A5A5A5A5A5A5Aull);
+static uintptr_t g_lostHead = 0;
+static uintptr_t g_lostChild = 0;
+
+MT_TEST_NOINLINE static void makeLeaks()
+{
+    g_reachable = new LeakNode{};
+    g_reachable->next = new LeakNode{};
+
+    LeakNode *lost = new LeakNode{};
+    lost->next = new LeakNode{};
+    g_lostHead = reinterpret_cast<uintptr_t>(lost) ^ kAddressMask;
+    g_lostChild = reinterpret_cast<uintptr_t>(lost->next) ^ kAddressMask;
+}
+
+// Pisa lo que makeLeaks() dejó en la pila
+MT_TEST_NOINLINE static void scrubStack()
+{
+    volatile char junk[16 * 1024];
+    for (size_t i = 0; i < sizeof(junk); ++i)
+        junk[i] = 0;
+}
+
+static bool contains(const std::vector<MemoryTracker::ReportEntry> &entries, uintptr_t address)
+{
+    for (const MemoryTracker::ReportEntry &e : entries)
+    {
+        if (reinterpret_cast<uintptr_t>(e.address) == address)
+            return true;
+    }
+    return false;
+}
+
+// scanLeaks(): lo apuntado desde .bss es alcanzable; la cabeza de una
+// cadena sin raíz se pierde del todo y lo que cuelga de ella, indirectamente
+static void testLeakReachability()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    makeLeaks();
+    scrubStack();
+
+    const MemoryTracker::LeakScan scan = tracker.scanLeaks(2);
+    if (!scan.scanned)
+    {
+        std::printf("       (sin soporte de escaneo en esta plataforma)\n");
+    }
+    else
+    {
+        const uintptr_t lostHead = g_lostHead ^ kAddressMask;
+        const uintptr_t lostChild = g_lostChild ^ kAddressMask;
+        const uintptr_t root = reinterpret_cast<uintptr_t>(g_reachable);
+        const uintptr_t rootChild = reinterpret_cast<uintptr_t>(g_reachable->next);
+
+        MT_CHECK(contains(scan.definitelyLost, lostHead));
+        MT_CHECK(contains(scan.indirectlyLost, lostChild));
+        MT_CHECK(!contains(scan.definitelyLost, root) && !contains(scan.indirectlyLost, root));
+        MT_CHECK(!contains(scan.definitelyLost, rootChild) && !contains(scan.indirectlyLost, rootChild));
+        MT_CHECK(scan.reachableCount >= 2);
+        MT_CHECK(scan.definitelyLostBytes >= sizeof(LeakNode));
+    }
+
+    LeakNode *lost = reinterpret_cast<LeakNode *>(g_lostHead ^ kAddressMask);
+    delete lost->next;
+    delete lost;
+    delete g_reachable->next;
+    delete g_reachable;
+    g_reachable = nullptr;
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("leak reachability", testLeakReachability);
+
+    return mt_check_result();
+}
@@ -0,0 +1,222 @@
+#include "TestCheck.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//==================================================
+// LD_PRELOAD sobre binarios reales
+//==================================================
+// No enlaza MemoryProfiler: corre programas del sistema con y sin
+// libmemoryprofiler_preload.so (ruta en argv[1]) y compara lo que escriben.
+// El stdout tiene que salir idéntico; el reporte de salida, por stderr o en
+// el archivo de MT_REPORT_FILE. Solo reportan los programas que corren los
+// destructores: dash termina con _exit() y sale sin reporte.
+
+struct RunResult
+{
+    int status = -1;
+    std::string out;
+    std::string err;
+};
+
+static const char *const kReportHeader = "=== Memory Report ===";
+
+static RunResult run(const std::vector<const char *> &argv, const std::vector<std::string> &env)
+{
+    RunResult result;
+    int outPipe[2];
+    int errPipe[2];
+    if (::pipe(outPipe) != 0 || ::pipe(errPipe) != 0)
+        return result;
+
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        ::dup2(outPipe[1], STDOUT_FILENO);
+        ::dup2(errPipe[1], STDERR_FILENO);
+        ::close(outPipe[0]);
+        ::close(outPipe[1]);
+        ::close(errPipe[0]);
+        ::close(errPipe[1]);
+        for (const std::string &var : env)
+            ::putenv(const_cast<char *>(var.c_str()));
+        std::vector<char *> args;
+        for (const char *a : argv)
+            args.push_back(const_cast<char *>(a));
+        args.push_back(nullptr);
+        ::execvp(args[0], args.data());
+        ::_exit(127);
+    }
+    ::close(outPipe[1]);
+    ::close(errPipe[1]);
+
+    // Las dos a la vez: un pipe lleno bloquearía al hijo
+    pollfd fds[2] = {{outPipe[0], POLLIN, 0}, {errPipe[0], POLLIN, 0}};
+    std::string *sinks[2] = {&result.out, &result.err};
+    int open = 2;
+    while (open > 0 && ::poll(fds, 2, 10000) > 0)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            if (fds[i].fd < 0 || !fds[i].revents)
+                continue;
+            char buf[4096];
+            const ssize_t n = ::read(fds[i].fd, buf, sizeof(buf));
+            if (n > 0)
+            {
+                sinks[i]->append(buf, static_cast<size_t>(n));
+                continue;
+            }
+            ::close(fds[i].fd);
+            fds[i].fd = -1;
+            --open;
+        }
+    }
+    for (const pollfd &p : fds)
+    {
+        if (p.fd >= 0)
+            ::close(p.fd);
+    }
+    ::waitpid(pid, &result.status, 0);
+    return result;
+}
+
+static std::string readReportFile(const std::string &dir)
+{
+    std::string text;
+    DIR *d = ::opendir(dir.c_str());
+    if (!d)
+        return text;
+    while (const dirent *e = ::readdir(d))
+    {
+        if (std::strncmp(e->d_name, "mt-", 3) != 0)
+            continue;
+        const std::string path = dir + "/" + e->d_name;
+        if (FILE *f = std::fopen(path.c_str(), "r"))
+        {
+            char buf[4096];
+            size_t n;
+            while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+                text.append(buf, n);
+            std::fclose(f);
+        }
+        ::unlink(path.c_str());
+    }
+    ::closedir(d);
+    return text;
+}
+
+static size_t countReports(const std::string &text)
+{
+    size_t count = 0;
+    for (size_t at = text.find(kReportHeader); at != std::string::npos; at = text.find(kReportHeader, at + 1))
+        ++count;
+    return count;
+}
+
+static std::string g_library;
+
+static void checkProgram(const std::vector<const char *> &argv, bool reports = true)
+{
+    const RunResult plain = run(argv, {});
+    MT_CHECK(WIFEXITED(plain.status) && WEXITSTATUS(plain.status) == 0);
+    MT_CHECK(!plain.out.empty());
+
+    const std::string preload = "LD_PRELOAD=" + g_library;
+    const RunResult traced = run(argv, {preload});
+    MT_CHECK(traced.status == plain.status);
+    MT_CHECK(traced.out == plain.out);
+    MT_CHECK(countReports(traced.err) == (reports ? 1u : 0u));
+    if (traced.out != plain.out)
+        std::fprintf(stderr, "stdout con preload:\n%s\n", traced.out.c_str());
+    if (!reports)
+        return;
+
+    char dirTemplate[] = "/tmp/mt-preload-XXXXXX";
+    const char *dir = ::mkdtemp(dirTemplate);
+    MT_CHECK(dir != nullptr);
+    if (!dir)
+        return;
+    const std::string reportFile = std::string("MT_REPORT_FILE=") + dir + "/mt-%p.txt";
+    const RunResult toFile = run(argv, {preload, reportFile});
+    MT_CHECK(toFile.status == plain.status);
+    MT_CHECK(toFile.out == plain.out);
+    MT_CHECK(toFile.err == plain.err);
+    MT_CHECK(countReports(readReportFile(dir)) == 1);
+    ::rmdir(dir);
+}
+
+//==================================================
+// realloc fallido
+//==================================================
+// Este mismo binario, bajo el preload, pide un bloque de 1 MiB y lo deja
+// vivo; con "fail" antes intenta agrandarlo a un tamaño imposible. El bloque
+// sigue siendo del programa, así que ambos reportes tienen que contarlo.
+static constexpr size_t kProbeBytes = 1 << 20;
+
+static int reallocProbe(bool fail)
+{
+    void *block = std::malloc(kProbeBytes);
+    if (fail)
+    {
+        volatile size_t huge = SIZE_MAX / 2;
+        if (std::realloc(block, huge))
+            return 1;
+    }
+    std::printf("%p\n", block);
+    return 0;
+}
+
+static size_t reportedCurrentMemory(const std::string &err)
+{
+    static const char kCurrent[] = "Current memory: ";
+    const size_t at = err.find(kCurrent);
+    if (at == std::string::npos)
+        return 0;
+    return std::strtoull(err.c_str() + at + sizeof(kCurrent) - 1, nullptr, 10);
+}
+
+static void checkFailedRealloc()
+{
+    const std::string preload = "LD_PRELOAD=" + g_library;
+    const RunResult kept = run({"/proc/self/exe", "--realloc-probe", "keep"}, {preload});
+    const RunResult failed = run({"/proc/self/exe", "--realloc-probe", "fail"}, {preload});
+    MT_CHECK(WIFEXITED(kept.status) && WEXITSTATUS(kept.status) == 0);
+    MT_CHECK(WIFEXITED(failed.status) && WEXITSTATUS(failed.status) == 0);
+
+    const size_t keptBytes = reportedCurrentMemory(kept.err);
+    MT_CHECK(keptBytes >= kProbeBytes);
+    MT_CHECK(reportedCurrentMemory(failed.err) + 4096 > keptBytes);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 3 && std::strcmp(argv[1], "--realloc-probe") == 0)
+        return reallocProbe(std::strcmp(argv[2], "fail") == 0);
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "uso: %s libmemoryprofiler_preload.so\n", argv[0]);
+        return 2;
+    }
+    g_library = argv[1];
+
+    // Sustitución de comandos: el $(...) interno lee el stdout de un hijo
+    mt_run_case("sh -c 'echo $(echo hi)'", []
+                { checkProgram({"sh", "-c", "echo $(echo hi)"}, false); });
+    // El hijo del fork sale por exit() y corre el destructor: no reporta
+    mt_run_case("bash -c 'echo $(echo hi); :'", []
+                { checkProgram({"bash", "-c", "echo $(echo hi); :"}); });
+    // ls cierra stdout y stderr en su atexit, antes del destructor del preload
+    mt_run_case("ls /", []
+                { checkProgram({"ls", "/"}); });
+    mt_run_case("failed realloc keeps the old block", checkFailedRealloc);
+
+    return mt_check_result();
+}
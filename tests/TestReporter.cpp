@@ -0,0 +1,200 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+void force_link_memory_operators();
+
+//==================================================
+// Reporte remoto contra un servidor de prueba
+//==================================================
+// Hace de GUI en el mismo proceso: escucha en 127.0.0.1 con un puerto libre,
+// espera las métricas periódicas y pide un snapshot. Habla el protocolo de
+// SocketClient: [keyword_len:u16][data_len:u32][keyword][data], big-endian.
+class TestServer
+{
+public:
+    TestServer()
+    {
+        listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t len = sizeof(addr);
+        if (listenFd < 0 ||
+            ::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listenFd, 1) != 0 ||
+            ::getsockname(listenFd, reinterpret_cast<sockaddr *>(&addr), &len) != 0)
+            return;
+        boundPort = ntohs(addr.sin_port);
+    }
+
+    ~TestServer()
+    {
+        if (clientFd >= 0)
+            ::close(clientFd);
+        if (listenFd >= 0)
+            ::close(listenFd);
+    }
+
+    uint16_t port() const { return boundPort; }
+
+    bool accept(std::chrono::milliseconds timeout)
+    {
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (::poll(&pfd, 1, static_cast<int>(timeout.count())) != 1)
+            return false;
+        clientFd = ::accept(listenFd, nullptr, nullptr);
+        return clientFd >= 0;
+    }
+
+    bool send(const std::string &keyword, const std::string &data)
+    {
+        std::string packet;
+        appendBigEndian(packet, keyword.size(), 2);
+        appendBigEndian(packet, data.size(), 4);
+        packet += keyword;
+        packet += data;
+        size_t sent = 0;
+        while (sent < packet.size())
+        {
+            const ssize_t n = ::send(clientFd, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Lee paquetes hasta ver `keyword` o agotar el tiempo
+    bool waitFor(const std::string &keyword, std::chrono::milliseconds timeout, std::string *data = nullptr)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            std::string k;
+            std::string d;
+            while (takePacket(k, d))
+            {
+                if (k == keyword)
+                {
+                    if (data)
+                        *data = d;
+                    return true;
+                }
+            }
+
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0)
+                return false;
+            pollfd pfd{clientFd, POLLIN, 0};
+            if (::poll(&pfd, 1, static_cast<int>(left.count())) != 1)
+                return false;
+            char buf[64 * 1024];
+            const ssize_t n = ::recv(clientFd, buf, sizeof(buf), 0);
+            if (n <= 0)
+                return false;
+            inbox.append(buf, static_cast<size_t>(n));
+        }
+    }
+
+private:
+    static void appendBigEndian(std::string &out, size_t value, int bytes)
+    {
+        for (int i = bytes - 1; i >= 0; --i)
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    static size_t readBigEndian(const std::string &in, size_t offset, int bytes)
+    {
+        size_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+            value = (value << 8) | static_cast<unsigned char>(in[offset + i]);
+        return value;
+    }
+
+    bool takePacket(std::string &keyword, std::string &data)
+    {
+        if (inbox.size() < 6)
+            return false;
+        const size_t keywordLen = readBigEndian(inbox, 0, 2);
+        const size_t dataLen = readBigEndian(inbox, 2, 4);
+        if (inbox.size() < 6 + keywordLen + dataLen)
+            return false;
+        keyword.assign(inbox, 6, keywordLen);
+        data.assign(inbox, 6 + keywordLen, dataLen);
+        inbox.erase(0, 6 + keywordLen + dataLen);
+        return true;
+    }
+
+    int listenFd = -1;
+    int clientFd = -1;
+    uint16_t boundPort = 0;
+    std::string inbox;
+};
+
+static void testRemoteReporting()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    TestServer server;
+    MT_CHECK(server.port() != 0);
+    if (!server.port())
+        return;
+
+    MemoryTracker::ReportPeriods periods;
+    periods.metrics = std::chrono::milliseconds(50);
+    periods.timeline = std::chrono::milliseconds(50);
+    periods.details = std::chrono::milliseconds(50);
+    tracker.setReportPeriods(periods);
+    tracker.enableRemoteReporting("127.0.0.1", server.port());
+
+    MT_CHECK(server.accept(std::chrono::seconds(5)));
+    MT_CHECK(tracker.isRemoteConnected());
+
+    std::string metrics;
+    MT_CHECK(server.waitFor("GENERAL_METRICS", std::chrono::seconds(5), &metrics));
+    MT_CHECK(!metrics.empty());
+
+    // Los tres períodos los cumple el hilo reporter, sin ayuda de la aplicación
+    std::string timeline;
+    MT_CHECK(server.waitFor("TIMELINE_POINT", std::chrono::seconds(5), &timeline));
+    MT_CHECK(timeline.rfind("TIMELINE|", 0) == 0);
+    std::string histogram;
+    MT_CHECK(server.waitFor("SIZE_HISTOGRAM", std::chrono::seconds(5), &histogram));
+    MT_CHECK(histogram.rfind("SIZE_HISTOGRAM|", 0) == 0);
+    MT_CHECK(histogram.find("|SIZE_HISTOGRAM_END") != std::string::npos);
+
+    // Pedido de la GUI: lo atiende el hilo reporter
+    MT_CHECK(server.send("SNAPSHOT_TAKE", ""));
+    std::string taken;
+    MT_CHECK(server.waitFor("SNAPSHOT_TAKEN", std::chrono::seconds(5), &taken));
+    MT_CHECK(taken.rfind("SNAPSHOT|", 0) == 0);
+
+    // Contra el estado actual (destino 0) y después se suelta
+    const std::string id = taken.substr(9, taken.find('|', 9) - 9);
+    MT_CHECK(server.send("SNAPSHOT_DIFF", id + "|0"));
+    std::string diff;
+    MT_CHECK(server.waitFor("SNAPSHOT_DIFF", std::chrono::seconds(5), &diff));
+    MT_CHECK(diff.rfind("SNAPSHOT_DIFF_START|" + id + "|", 0) == 0);
+    MT_CHECK(server.send("SNAPSHOT_RELEASE", id));
+
+    tracker.disableRemoteReporting();
+    MT_CHECK(!tracker.isRemoteConnected());
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("remote reporting", testRemoteReporting);
+
+    return mt_check_result();
+}
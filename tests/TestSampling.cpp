@@ -0,0 +1,53 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include "TrackerQueries.h"
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Muestreo estadístico
+//==================================================
+
+// Muestreo: las cifras repesadas estiman las reales y los frees de bloques
+// muestreados las devuelven a 0 exacto
+static void testSamplingEstimates()
+{
+    constexpr int kBlocks = 40000;
+    constexpr size_t kSize = 256;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+
+    std::vector<char *> blocks;
+    blocks.reserve(kBlocks);
+    tracker.enableSampling(4096);
+    MT_CHECK(tracker.getCurrentStats().sampleInterval == 4096);
+
+    int line = 0;
+    for (int i = 0; i < kBlocks; ++i)
+        blocks.push_back(MT_TEST_NEW(line, char[kSize]));
+
+    // ~2400 muestras: el error relativo esperado ronda el 2%
+    MemoryTracker::SiteSummary site = siteAt(__FILE__, line);
+    MT_CHECK_NEAR(site.allocationCount, kBlocks, 0.15);
+    MT_CHECK_NEAR(site.totalMemory, kBlocks * kSize, 0.15);
+    MT_CHECK_NEAR(site.liveMemory, kBlocks * kSize, 0.15);
+
+    for (char *p : blocks)
+        delete[] p;
+    site = siteAt(__FILE__, line);
+    MT_CHECK(site.liveCount == 0);
+    MT_CHECK(site.liveMemory == 0);
+    MT_CHECK_NEAR(site.freedCount, kBlocks, 0.15);
+
+    tracker.disableSampling();
+    MT_CHECK(tracker.getCurrentStats().sampleInterval == 0);
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("sampling estimates", testSamplingEstimates);
+
+    return mt_check_result();
+}
@@ -0,0 +1,62 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include "TrackerQueries.h"
+#include <string>
+#include <string_view>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Tags de MT_SCOPE
+//==================================================
+
+// MT_SCOPE: anidado, con nombre armado en tiempo de ejecución y restaurado al salir
+static void testScopeTags()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    std::vector<int *> blocks;
+    blocks.reserve(15);
+
+    int line = 0;
+    {
+        MT_SCOPE("scope-outer");
+        for (int i = 0; i < 10; ++i)
+            blocks.push_back(MT_TEST_NEW(line, int(i)));
+        {
+            const std::string tenant = "scope-tenant";
+            // Con paréntesis en la macro esto declaraba una función
+            MT_SCOPE(std::string(tenant));
+            for (int i = 0; i < 5; ++i)
+                blocks.push_back(MT_TEST_NEW(line, int(i)));
+            MT_CHECK(MemoryScope::current() == tracker.internTag(std::string_view("scope-tenant")));
+            // El tag no cambia el sitio: sigue siendo la línea del new
+            MT_CHECK(siteAt(__FILE__, line).liveCount == 5);
+        }
+        MT_CHECK(MemoryScope::current() == tracker.internTag("scope-outer"));
+    }
+    MT_CHECK(MemoryScope::current() == 0);
+
+    MT_CHECK(tagNamed("scope-outer").liveCount == 10);
+    MT_CHECK(tagNamed("scope-tenant").liveCount == 5);
+    MemoryTracker::ReportEntry entry{};
+    MT_CHECK(findLive(blocks.front(), entry));
+    MT_CHECK(entry.tag == "scope-outer");
+    MT_CHECK(findLive(blocks.back(), entry));
+    MT_CHECK(entry.tag == "scope-tenant");
+
+    for (int *p : blocks)
+        delete p;
+    MT_CHECK(tagNamed("scope-outer").liveCount == 0);
+    MT_CHECK(tagNamed("scope-outer").freedCount == 10);
+    MT_CHECK(tagNamed("scope-tenant").liveCount == 0);
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("MT_SCOPE tags", testScopeTags);
+
+    return mt_check_result();
+}
@@ -0,0 +1,68 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include "TrackerQueries.h"
+#include <thread>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Tabla de asignaciones por shards
+//==================================================
+
+// Contadores por shard: nada se pierde con varios hilos a la vez
+static void testConcurrentCounters()
+{
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 5000;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    const MemoryTracker::Stats before = tracker.getCurrentStats();
+
+    int line = 0;
+    std::vector<std::vector<char *>> kept(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i)
+    {
+        kept[i].reserve(kPerThread);
+        threads.emplace_back([&kept, &line, i]()
+                             {
+                                 for (int n = 0; n < kPerThread; ++n)
+                                 {
+                                     char *p = MT_TEST_NEW(line, char[32]);
+                                     if (n % 2)
+                                         delete[] p;
+                                     else
+                                         kept[i].push_back(p);
+                                 } });
+    }
+    for (std::thread &t : threads)
+        t.join();
+
+    const size_t total = size_t(kThreads) * kPerThread;
+    MemoryTracker::SiteSummary site = siteAt(__FILE__, line);
+    MT_CHECK(site.allocationCount == total);
+    MT_CHECK(site.freedCount == total / 2);
+    MT_CHECK(site.liveCount == total / 2);
+    MT_CHECK(site.liveMemory == total / 2 * 32);
+    MT_CHECK(site.totalMemory == total * 32);
+    MT_CHECK(tracker.getCurrentStats().totalAllocations - before.totalAllocations >= total);
+
+    for (std::vector<char *> &blocks : kept)
+    {
+        for (char *p : blocks)
+            delete[] p;
+    }
+    site = siteAt(__FILE__, line);
+    MT_CHECK(site.freedCount == total);
+    MT_CHECK(site.liveCount == 0);
+    MT_CHECK(site.liveMemory == 0);
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("concurrent counters", testConcurrentCounters);
+
+    return mt_check_result();
+}
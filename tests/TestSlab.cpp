@@ -0,0 +1,49 @@
+#include "MemoryTracker.h"
+#include "Symbolizer.h"
+#include "TestCheck.h"
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Contabilidad del tracker en el SlabArena
+//==================================================
+// Lo que arma el propio tracker no pasa por los operadores instrumentados:
+// aquí se usa el simbolizador sin ReentryGuard y el contador no se mueve.
+
+static MT_TEST_NOINLINE const void *symbolizedCaller()
+{
+    return __builtin_return_address(0);
+}
+
+static void testSymbolizerStaysOffTheTracker()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    const size_t before = tracker.getCurrentStats().totalAllocations;
+
+    const void *pc = symbolizedCaller();
+    Symbolizer::String text;
+    {
+        Symbolizer symbolizer;
+        symbolizer.loadProcessModules();
+        const Symbolizer::Location loc = symbolizer.resolve(pc);
+        text = Symbolizer::format(pc, loc);
+        const Symbolizer::String map = symbolizer.moduleMap();
+#if defined(__linux__)
+        MT_CHECK(loc.resolved);
+        MT_CHECK(loc.function.find("testSymbolizerStaysOffTheTracker") != Symbolizer::String::npos);
+        MT_CHECK(!map.empty());
+#endif
+    }
+
+    MT_CHECK(!text.empty());
+    MT_CHECK(tracker.getCurrentStats().totalAllocations == before);
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("symbolizer allocates from the slab arena", testSymbolizerStaysOffTheTracker);
+
+    return mt_check_result();
+}
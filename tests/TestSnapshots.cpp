@@ -0,0 +1,87 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Snapshots del heap y diffs
+//==================================================
+
+struct DiffTotals
+{
+    size_t appearedCount = 0;
+    size_t appearedBytes = 0;
+    size_t disappearedCount = 0;
+    size_t disappearedBytes = 0;
+};
+
+// Un sitio puede tener varias entradas (por tipo y clase de tamaño)
+static DiffTotals diffAt(const MemoryTracker::HeapDiff &diff, int line)
+{
+    DiffTotals totals;
+    for (const MemoryTracker::HeapDiffEntry &e : diff.entries)
+    {
+        if (e.line != line || e.file != __FILE__)
+            continue;
+        totals.appearedCount += e.appearedCount;
+        totals.appearedBytes += e.appearedBytes;
+        totals.disappearedCount += e.disappearedCount;
+        totals.disappearedBytes += e.disappearedBytes;
+    }
+    return totals;
+}
+
+// diff() entre generaciones: lo que nace y muere entre dos snapshots no aparece
+static void testSnapshotDiff()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    std::vector<char *> blocks;
+    blocks.reserve(100);
+
+    int line = 0;
+    const MemoryTracker::HeapSnapshot s1 = tracker.takeSnapshot();
+    for (int i = 0; i < 100; ++i)
+        blocks.push_back(MT_TEST_NEW(line, char[1000]));
+    const MemoryTracker::HeapSnapshot s2 = tracker.takeSnapshot();
+    for (int i = 0; i < 40; ++i)
+        delete[] blocks[i];
+    const MemoryTracker::HeapSnapshot s3 = tracker.takeSnapshot();
+    MT_CHECK(s1.id < s2.id && s2.id < s3.id);
+
+    const MemoryTracker::HeapDiff d12 = tracker.diff(s1, s2);
+    MT_CHECK(d12.complete);
+    DiffTotals t = diffAt(d12, line);
+    MT_CHECK(t.appearedCount == 100);
+    MT_CHECK(t.appearedBytes == 100 * 1000);
+    MT_CHECK(t.disappearedCount == 0);
+
+    const MemoryTracker::HeapDiff d23 = tracker.diff(s2, s3);
+    MT_CHECK(d23.complete);
+    t = diffAt(d23, line);
+    MT_CHECK(t.appearedCount == 0);
+    MT_CHECK(t.disappearedCount == 40);
+    MT_CHECK(t.disappearedBytes == 40 * 1000);
+
+    const MemoryTracker::HeapDiff d13 = tracker.diff(s1, s3);
+    MT_CHECK(d13.complete);
+    t = diffAt(d13, line);
+    MT_CHECK(t.appearedCount == 60);
+    MT_CHECK(t.appearedBytes == 60 * 1000);
+    MT_CHECK(t.disappearedCount == 0);
+
+    tracker.releaseSnapshot(s1.id);
+    tracker.releaseSnapshot(s2.id);
+    tracker.releaseSnapshot(s3.id);
+    for (int i = 40; i < 100; ++i)
+        delete[] blocks[i];
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("snapshot diff", testSnapshotDiff);
+
+    return mt_check_result();
+}
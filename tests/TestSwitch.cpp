@@ -0,0 +1,96 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include <cstring>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Apagado del tracker
+//==================================================
+// "off": corre con MT_ENABLED=0 (lo pone CTest) o en un build MT_DISABLED;
+// las asignaciones no deben construir el tracker. Sin argumento prueba
+// setEnabled() con el tracker en marcha. No se llama a getInstance() antes
+// de comprobar isAlive(): eso lo construiría.
+
+static void testSwitchedOff()
+{
+    std::vector<int *> blocks;
+    for (int i = 0; i < 100; ++i)
+        blocks.push_back(new int(i));
+    {
+        MT_SCOPE("switch-off");
+        delete new double(1.0);
+    }
+
+    MT_CHECK(!MemoryTracker::isAlive());
+#if !defined(MT_DISABLED)
+    MT_CHECK(!MemoryTracker::isEnabled());
+#endif
+    MT_CHECK(MemoryScope::current() == 0);
+
+    for (int *p : blocks)
+        delete p;
+    MT_CHECK(!MemoryTracker::isAlive());
+}
+
+#if !defined(MT_DISABLED)
+static size_t siteCount(int line)
+{
+    for (const MemoryTracker::SiteSummary &s : MemoryTracker::getInstance().getSiteSummaries())
+    {
+        if (s.line == line && s.file == __FILE__)
+            return s.allocationCount;
+    }
+    return 0;
+}
+
+static void testRuntimeSwitch()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+
+    MemoryTracker::setEnabled(false);
+    int offLine = 0;
+    int *off = MT_TEST_NEW(offLine, int(1));
+    MemoryTracker::setEnabled(true);
+    int onLine = 0;
+    int *on = MT_TEST_NEW(onLine, int(2));
+
+    MT_CHECK(MemoryTracker::isEnabled());
+    MT_CHECK(siteCount(offLine) == 0);
+    MT_CHECK(siteCount(onLine) == 1);
+
+    // Un free con el tracker apagado igual se busca en la tabla
+    const size_t active = tracker.getCurrentStats().activeAllocations;
+    MemoryTracker::setEnabled(false);
+    delete on;
+    MemoryTracker::setEnabled(true);
+    MT_CHECK(tracker.getCurrentStats().activeAllocations < active);
+
+    // El bloque asignado con el tracker apagado nunca se registró: liberarlo
+    // con el tracker encendido no toca los contadores
+    const MemoryTracker::Stats before = tracker.getCurrentStats();
+    delete off;
+    const MemoryTracker::Stats after = tracker.getCurrentStats();
+    MT_CHECK(after.activeAllocations == before.activeAllocations);
+    MT_CHECK(after.currentMemory == before.currentMemory);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    force_link_memory_operators();
+
+    const bool expectOff = argc > 1 && std::strcmp(argv[1], "off") == 0;
+#if defined(MT_DISABLED)
+    (void)expectOff;
+    mt_run_case("MT_DISABLED build", testSwitchedOff);
+#else
+    if (expectOff)
+        mt_run_case("MT_ENABLED=0", testSwitchedOff);
+    else
+        mt_run_case("setEnabled()", testRuntimeSwitch);
+#endif
+
+    return mt_check_result();
+}
@@ -0,0 +1,64 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include "TrackerQueries.h"
+#include <cstdint>
+#include <thread>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Atribución por hilo
+//==================================================
+
+// Frees en un hilo distinto del que asignó
+static void testCrossThreadFrees()
+{
+    constexpr int kBlocks = 100;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+
+    int line = 0;
+    uint32_t producerId = 0;
+    std::vector<long *> blocks(kBlocks);
+    std::thread producer([&]()
+                         {
+                             producerId = tracker.currentThreadId();
+                             for (long *&p : blocks)
+                                 p = MT_TEST_NEW(line, long(7)); });
+    producer.join();
+
+    const size_t before = tracker.getCurrentStats().crossThreadFrees;
+    for (long *p : blocks)
+        delete p;
+
+    MT_CHECK(siteAt(__FILE__, line).crossThreadFrees == kBlocks);
+    MT_CHECK(tracker.getCurrentStats().crossThreadFrees - before >= kBlocks);
+
+    const uint32_t consumerId = tracker.currentThreadId();
+    bool producerSeen = false;
+    bool consumerSeen = false;
+    for (const MemoryTracker::ThreadSummary &s : tracker.getThreadSummaries())
+    {
+        if (s.threadId == producerId)
+        {
+            producerSeen = true;
+            MT_CHECK(s.crossThreadFrees >= kBlocks);
+        }
+        else if (s.threadId == consumerId)
+        {
+            consumerSeen = true;
+            MT_CHECK(s.remoteFrees >= kBlocks);
+        }
+    }
+    MT_CHECK(producerSeen);
+    MT_CHECK(consumerSeen);
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("cross-thread frees", testCrossThreadFrees);
+
+    return mt_check_result();
+}
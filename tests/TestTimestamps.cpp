@@ -0,0 +1,71 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include "TrackerQueries.h"
+#include <chrono>
+#include <cstdint>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Sellos de TscClock
+//==================================================
+// Los registros guardan 48 bits de sello. Para no esperar días se adelanta
+// el reloj del tracker: un bloque creado antes queda igual de viejo que si
+// hubiera vivido ese tiempo.
+
+struct MemoryTrackerTestAccess
+{
+    static void advanceClock(MemoryTracker &tracker, uint64_t units) { tracker.clock.advance(units); }
+};
+
+// Más de medio rango de 48 bits: ~5 días con unidades de 2 ns
+static constexpr uint64_t kDaysOfUnits = (TscClock::kStampMask >> 2) * 3;
+
+// Un free inline encuentra su bloque por viejo que sea
+static void testOldBlockFreedInline()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    const size_t before = tracker.getCurrentStats().currentMemory;
+    int line = 0;
+    char *block = MT_TEST_NEW(line, char[4096]);
+
+    MemoryTrackerTestAccess::advanceClock(tracker, kDaysOfUnits);
+    delete[] block;
+
+    const MemoryTracker::SiteSummary site = siteAt(__FILE__, line);
+    MT_CHECK(site.freedCount == 1);
+    MT_CHECK(site.liveCount == 0);
+    MT_CHECK(site.liveMemory == 0);
+    MT_CHECK(tracker.getCurrentStats().currentMemory < before + 4096);
+}
+
+// Igual desde el agregador, donde sí se descartan registros posteriores al free
+static void testOldBlockFreedBuffered()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    tracker.enableBufferedMode(std::chrono::hours(1));
+
+    int line = 0;
+    long *block = MT_TEST_NEW(line, long(42));
+    tracker.flushEvents();
+    MT_CHECK(siteAt(__FILE__, line).liveCount == 1);
+
+    MemoryTrackerTestAccess::advanceClock(tracker, kDaysOfUnits);
+    delete block;
+    tracker.flushEvents();
+
+    const MemoryTracker::SiteSummary site = siteAt(__FILE__, line);
+    MT_CHECK(site.freedCount == 1);
+    MT_CHECK(site.liveCount == 0);
+    tracker.disableBufferedMode();
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("old block, inline free", testOldBlockFreedInline);
+    mt_run_case("old block, buffered free", testOldBlockFreedBuffered);
+
+    return mt_check_result();
+}
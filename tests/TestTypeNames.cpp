@@ -0,0 +1,52 @@
+#include "MemoryTracker.h"
+#include "TestCheck.h"
+#include "TrackerQueries.h"
+#include <string>
+#include <vector>
+// Al final: su #define new rompería los headers de la STL
+#include "MemoryMacros.h"
+
+//==================================================
+// Nombres de tipo de MT_NEW y TrackingAllocator
+//==================================================
+
+struct TypedWidget
+{
+    int id;
+    double weight;
+    TypedWidget(int id, double weight) : id(id), weight(weight) {}
+};
+
+// MT_NEW y TrackingAllocator: nombre real del tipo además del sitio
+static void testTypedAllocations()
+{
+    TypedWidget *widget = MT_NEW(TypedWidget, 3, 1.5);
+    int *numbers = MT_NEW_ARRAY(int, 16);
+    std::vector<short, TrackingAllocator<short>> shorts(MT_ALLOCATOR(short));
+    shorts.reserve(64);
+
+    MemoryTracker::ReportEntry entry{};
+    MT_CHECK(findLive(widget, entry));
+    MT_CHECK(entry.typeName.find("TypedWidget") != std::string::npos);
+    MT_CHECK(entry.file == __FILE__);
+    MT_CHECK(entry.size == sizeof(TypedWidget));
+
+    MT_CHECK(findLive(numbers, entry));
+    MT_CHECK(entry.typeName == "int[]");
+    MT_CHECK(entry.size == 16 * sizeof(int));
+
+    MT_CHECK(findLive(shorts.data(), entry));
+    MT_CHECK(entry.typeName.find("short") != std::string::npos); // GCC escribe "short int"
+
+    delete widget;
+    delete[] numbers;
+}
+
+int main()
+{
+    force_link_memory_operators();
+
+    mt_run_case("MT_NEW type names", testTypedAllocations);
+
+    return mt_check_result();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "MemoryTracker.h"
+
+//==================================================
+// Consultas de los tests sobre el singleton
+//==================================================
+// Todos los casos comparten el tracker y el resto del proceso también
+// asigna, así que cada test mira solo sus propios sitios, tags y bloques.
+// `file` es el __FILE__ del test que asignó.
+
+inline MemoryTracker::SiteSummary siteAt(const char *file, int line)
+{
+    for (const MemoryTracker::SiteSummary &s : MemoryTracker::getInstance().getSiteSummaries())
+    {
+        if (s.line == line && s.file == file)
+            return s;
+    }
+    return MemoryTracker::SiteSummary{};
+}
+
+inline MemoryTracker::TagSummary tagNamed(const char *name)
+{
+    for (const MemoryTracker::TagSummary &s : MemoryTracker::getInstance().getTagSummaries())
+    {
+        if (s.name == name)
+            return s;
+    }
+    return MemoryTracker::TagSummary{};
+}
+
+inline bool findLive(const void *ptr, MemoryTracker::ReportEntry &out)
+{
+    const MemoryTracker::LiveAllocations live = MemoryTracker::getInstance().liveAllocations();
+    for (size_t i = 0; i < live.size(); ++i)
+    {
+        if (live.record(i).address == ptr)
+        {
+            out = live.entry(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,295 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MemoryTracker.h"
+
+void force_link_memory_operators();
+
+//==================================================
+// Microbenchmarks de operator new/delete
+//==================================================
+// Una fila CSV por combinación de configuración, patrón, tamaño e hilos:
+//   config,pattern,size,threads,ops,seconds,ns_per_op,ops_per_sec,remote
+// ns_per_op es la latencia media por llamada en cada hilo; ops_per_sec, el
+// throughput total. "untracked" llama a malloc/free directamente (lo mismo
+// que hacen los operadores antes de registrar), como referencia.
+//
+// Uso: bench_operators [--threads N] [--iters N] [--host H] [--port P] [--out archivo]
+
+namespace
+{
+    // Evita que el compilador elimine pares new/delete
+    void *volatile g_bench_sink = nullptr;
+
+    enum class Config
+    {
+        Untracked,
+        Tracked,
+        TrackedBuffered,
+        TrackedSampled,
+        TrackedRemote
+    };
+
+    enum class Pattern
+    {
+        Pair,  // new + delete inmediato
+        Batch, // 1024 new, luego 1024 delete en orden inverso
+        Mixed  // slots al azar: libera si está ocupado, si no asigna
+    };
+
+    const char *configName(Config c)
+    {
+        switch (c)
+        {
+        case Config::Untracked:
+            return "untracked";
+        case Config::Tracked:
+            return "tracked";
+        case Config::TrackedBuffered:
+            return "tracked_buffered";
+        case Config::TrackedSampled:
+            return "tracked_sampled";
+        case Config::TrackedRemote:
+            return "tracked_remote";
+        }
+        return "?";
+    }
+
+    const char *patternName(Pattern p)
+    {
+        switch (p)
+        {
+        case Pattern::Pair:
+            return "pair";
+        case Pattern::Batch:
+            return "batch";
+        case Pattern::Mixed:
+            return "mixed";
+        }
+        return "?";
+    }
+
+    inline void *allocate(Config c, size_t size)
+    {
+        void *p = (c == Config::Untracked) ? std::malloc(size) : ::operator new(size);
+        g_bench_sink = p;
+        return p;
+    }
+
+    inline void release(Config c, void *p)
+    {
+        if (c == Config::Untracked)
+            std::free(p);
+        else
+            ::operator delete(p);
+    }
+
+    // Devuelve la cantidad de llamadas (new + delete) hechas
+    size_t runPattern(Config c, Pattern pattern, size_t size, size_t iters, uint64_t seed)
+    {
+        size_t ops = 0;
+        switch (pattern)
+        {
+        case Pattern::Pair:
+            for (size_t i = 0; i < iters / 2; ++i)
+            {
+                release(c, allocate(c, size));
+                ops += 2;
+            }
+            break;
+
+        case Pattern::Batch:
+        {
+            constexpr size_t kBatch = 1024;
+            void *batch[kBatch];
+            while (ops + 2 * kBatch <= iters)
+            {
+                for (size_t i = 0; i < kBatch; ++i)
+                    batch[i] = allocate(c, size);
+                for (size_t i = kBatch; i-- > 0;)
+                    release(c, batch[i]);
+                ops += 2 * kBatch;
+            }
+            break;
+        }
+
+        case Pattern::Mixed:
+        {
+            constexpr size_t kSlots = 256;
+            void *slots[kSlots] = {};
+            uint64_t x = seed | 1;
+            for (size_t i = 0; i < iters; ++i)
+            {
+                x ^= x >> 12;
+                x ^= x << 25;
+                x ^= x >> 27;
+                const uint64_t r = x * 0x2545F4914F6CDD1Dull;
+                void *&slot = slots[(r >> 32) % kSlots];
+                if (slot)
+                {
+                    release(c, slot);
+                    slot = nullptr;
+                }
+                else
+                {
+                    // Tamaños entre size/2 y size para no caer siempre en la misma clase
+                    slot = allocate(c, size / 2 + static_cast<size_t>(r % (size / 2 + 1)));
+                }
+                ++ops;
+            }
+            for (void *p : slots)
+            {
+                if (p)
+                    release(c, p);
+            }
+            break;
+        }
+        }
+        return ops;
+    }
+
+    struct Result
+    {
+        size_t ops;
+        double seconds;
+    };
+
+    Result runThreads(Config c, Pattern pattern, size_t size, unsigned threads, size_t iters)
+    {
+        std::atomic<unsigned> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<size_t> totalOps{0};
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]()
+                                 {
+                                     ready.fetch_add(1);
+                                     while (!go.load(std::memory_order_acquire))
+                                         std::this_thread::yield();
+                                     totalOps.fetch_add(runPattern(c, pattern, size, iters, 0x9E3779B97F4A7C15ull * (t + 1)));
+                                 });
+        }
+
+        while (ready.load() < threads)
+            std::this_thread::yield();
+
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto &w : workers)
+            w.join();
+        const auto end = std::chrono::steady_clock::now();
+
+        return {totalOps.load(), std::chrono::duration<double>(end - start).count()};
+    }
+
+    void configure(MemoryTracker &tracker, Config c, const char *host, uint16_t port)
+    {
+        tracker.disableBufferedMode();
+        tracker.disableSampling();
+        tracker.disableRemoteReporting();
+
+        switch (c)
+        {
+        case Config::TrackedBuffered:
+            tracker.enableBufferedMode();
+            break;
+        case Config::TrackedSampled:
+            tracker.enableSampling();
+            break;
+        case Config::TrackedRemote:
+            tracker.enableRemoteReporting(host, port);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    force_link_memory_operators();
+
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0)
+        maxThreads = 4;
+    size_t iters = 200000;
+    const char *host = "localhost";
+    uint16_t port = 8080;
+    const char *outPath = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0)
+            maxThreads = static_cast<unsigned>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--iters") == 0)
+            iters = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--host") == 0)
+            host = argv[i + 1];
+        else if (std::strcmp(argv[i], "--port") == 0)
+            port = static_cast<uint16_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--out") == 0)
+            outPath = argv[i + 1];
+    }
+    if (maxThreads == 0)
+        maxThreads = 1;
+
+    // Construir el tracker antes de escribir nada: imprime su propio log
+    auto &tracker = MemoryTracker::getInstance();
+
+    FILE *out = outPath ? std::fopen(outPath, "w") : stdout;
+    if (!out)
+    {
+        std::fprintf(stderr, "cannot open %s\n", outPath);
+        return 1;
+    }
+
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    const Config configs[] = {Config::Untracked, Config::Tracked, Config::TrackedBuffered,
+                              Config::TrackedSampled, Config::TrackedRemote};
+    const Pattern patterns[] = {Pattern::Pair, Pattern::Batch, Pattern::Mixed};
+    const size_t sizes[] = {32, 512, 64 * 1024};
+
+    std::fprintf(out, "config,pattern,size,threads,ops,seconds,ns_per_op,ops_per_sec,remote\n");
+    for (Config c : configs)
+    {
+        configure(tracker, c, host, port);
+        const int remote = tracker.isRemoteConnected() ? 1 : 0;
+
+        for (Pattern pattern : patterns)
+        {
+            for (size_t size : sizes)
+            {
+                for (unsigned threads : threadCounts)
+                {
+                    // Calentamiento: buffers por hilo, tablas internas, páginas del heap
+                    runThreads(c, pattern, size, threads, iters / 10);
+                    const Result r = runThreads(c, pattern, size, threads, iters);
+
+                    const double nsPerOp = r.seconds * 1e9 * threads / static_cast<double>(r.ops);
+                    const double opsPerSec = static_cast<double>(r.ops) / r.seconds;
+                    std::fprintf(out, "%s,%s,%zu,%u,%zu,%.6f,%.2f,%.0f,%d\n",
+                                 configName(c), patternName(pattern), size, threads,
+                                 r.ops, r.seconds, nsPerOp, opsPerSec, remote);
+                    std::fflush(out);
+                }
+            }
+        }
+    }
+
+    configure(tracker, Config::Tracked, host, port);
+    if (out != stdout)
+        std::fclose(out);
+    return 0;
+}
@@ -1,5 +1,6 @@
 ﻿#include <cstdio>
 #include "MemoryTracker.h"
+#include "TestCheck.h"
 
 void force_link_memory_operators();
 
@@ -34,6 +35,12 @@ int main() {
 
     std::printf("[CHECK] leaks count=%zu\n", report.leaks.size());
 
+    MT_CHECK(report.stats.totalAllocations >= 1);
+    MT_CHECK(report.stats.activeAllocations >= 1);
+    MT_CHECK(report.stats.currentMemory >= 40);
+    MT_CHECK(report.stats.peakMemory >= report.stats.currentMemory);
+    bool fakeFound = false;
+
     for (auto& leak : report.leaks) {
         std::printf("LEAK addr=%p size=%zu file=%s:%d type=%s ts(ms)=%lld\n",
             leak.address,
@@ -42,13 +49,25 @@ int main() {
             leak.line,
             leak.typeName.c_str(),   
             (long long)leak.timestamp_ms); 
+
+        if (leak.address == (void*)0x1) {
+            fakeFound = true;
+            MT_CHECK(leak.size == 40);
+            MT_CHECK(leak.line == 99);
+            MT_CHECK(leak.file == "fake.cpp");
+            MT_CHECK(leak.typeName == "int[]");
+        }
     }
+    MT_CHECK(fakeFound);
 
     flush("[PING7] before unregisterAllocation");
     tracker.unregisterAllocation((void*)0x1);
     flush("[PING8] after unregisterAllocation");
 
+    for (auto& leak : tracker.collectReport().leaks)
+        MT_CHECK(leak.address != (void*)0x1);
+
     flush("[PING9] end");
 
-    return 0;
+    return mt_check_result();
 }